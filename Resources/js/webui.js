@@ -80,6 +80,9 @@ $.webUIComponent = {
     queue_end_slider_default_timeout: 500,
     retry_time: 500,
     selected_slider: null,
+    binary_packet_type: 4, // WsClient::BinaryPacketType::WEBUI_VALUES
+    binary_version: null,
+    binary_ids: [],
     //
     // create gradient depending in min/max/rmin/rmax value
     //
@@ -1053,6 +1056,11 @@ $.webUIComponent = {
         var self = this;
         $.get(url + '?SID=' + SID, function(data) {
             self.console.debug('get ', this.http_uri, data);
+            // the index of the binary value updates is the position in data.values
+            self.binary_ids = $.map(data.values, function(value) {
+                return value.i;
+            });
+            self.binary_version = (data.bv === undefined) ? null : data.bv;
             self.update_ui(data.data);
             self.update_events(data.values, true);
             self.finalize_ui();
@@ -1068,6 +1076,76 @@ $.webUIComponent = {
         });
     },
     //
+    // decode binary value updates. the format is described in include/WebUIComponent.h (WebUINS::BinaryTable)
+    //
+    decode_binary_values: function(data) {
+        var view = new DataView(data);
+        if (data.byteLength < 4 || view.getUint16(0, true) !== this.binary_packet_type) {
+            return null;
+        }
+        if (view.getUint8(2) !== this.binary_version) {
+            // the ids have changed, reload the ui once
+            if (this.binary_version !== null) {
+                this.binary_version = null;
+                this.request_ui();
+            }
+            return null;
+        }
+        var count = view.getUint8(3);
+        var offset = 4;
+        var events = [];
+        for(var n = 0; n < count; n++) {
+            var event = { i: this.binary_ids[view.getUint8(offset++)] };
+            var flags = view.getUint8(offset++);
+            var precision = flags >> 5;
+            switch(flags & 0x07) {
+                case 1: // BOOL
+                    event.v = view.getUint8(offset++) !== 0;
+                    break;
+                case 2: // INT32
+                    event.v = view.getInt32(offset, true);
+                    offset += 4;
+                    break;
+                case 3: // UINT32
+                    event.v = view.getUint32(offset, true);
+                    offset += 4;
+                    break;
+                case 4: // FLOAT
+                    event.v = Number(view.getFloat32(offset, true).toFixed(precision));
+                    offset += 4;
+                    break;
+                case 5: // DOUBLE
+                    event.v = Number(view.getFloat64(offset, true).toFixed(precision));
+                    offset += 8;
+                    break;
+                case 6: // STRING
+                    var length = view.getUint8(offset++);
+                    event.v = new TextDecoder().decode(new Uint8Array(data, offset, length));
+                    offset += length;
+                    break;
+                default: // NONE
+                    event.v = null;
+                    break;
+            }
+            if (flags & 0x08) {
+                event.s = (flags & 0x10) !== 0;
+            }
+            events.push(event);
+        }
+        return events;
+    },
+    //
+    // pass events to the event handlers and update the ui
+    //
+    dispatch_events: function(events) {
+        for(var i = 0; i < this.event_handlers.length; i++) {
+            for(var j = 0; j < events.length; j++) {
+                this.event_handlers[i](events[j]);
+            }
+        }
+        this.update_events(events);
+    },
+    //
     // web socket handler
     //
     socket_handler: function(event) {
@@ -1076,18 +1154,22 @@ $.webUIComponent = {
         }
         else if (event.type == 'auth') {
             //event.socket.send('+GET_VALUES');
+            if (window.DataView !== undefined && window.TextDecoder !== undefined) {
+                event.socket.send('+BINARY 1');
+            }
             this.request_ui();
         }
+        else if (event.type == 'binary') {
+            var events = this.decode_binary_values(event.data);
+            if (events) {
+                this.dispatch_events(events);
+            }
+        }
         else if (event.type == 'data') {
             try {
                 var json = JSON.parse(event.data);
                 if (json.type === this.short.to.update_events) {
-                    for(var i = 0; i < this.event_handlers.length; i++) {
-                        for(var j = 0; j < json.events.length; j++) {
-                            this.event_handlers[i](json.events[j]);
-                        }
-                    }
-                    this.update_events(json.events);
+                    this.dispatch_events(json.events);
                 }
             } catch(e) {
                 this.console.error('failed to parse json string', e, 'event.data', event)
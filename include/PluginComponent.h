@@ -77,6 +77,8 @@ namespace PluginComponents {
         SAFE_MODE,
         SWITCH,
         DIMMER,
+        ZEROCONF,
+        WEATHER_STATION,
         MAX
     };
 
@@ -351,6 +353,10 @@ public:
             return F("SWITCH");
         case RTCMemoryId::DIMMER:
             return F("DIMMER");
+        case RTCMemoryId::ZEROCONF:
+            return F("ZEROCONF");
+        case RTCMemoryId::WEATHER_STATION:
+            return F("WEATHER_STATION");
         case RTCMemoryId::NONE:
         case RTCMemoryId::MAX:
             break;
@@ -14,6 +14,12 @@
 #include <memory>
 #include <vector>
 
+// compact binary encoding for value updates of the WebUI. clients that send "+binary" receive
+// WsClient::BinaryPacketType::WEBUI_VALUES packets instead of the JSON update events
+#ifndef WEBUI_BINARY_VALUES
+#    define WEBUI_BINARY_VALUES 1
+#endif
+
 #if DEBUG_WEBUI
 #    include <debug_helper_enable.h>
 #else
@@ -652,6 +658,122 @@ namespace WebUINS {
     };
 
 
+    #if WEBUI_BINARY_VALUES
+
+        // Table of the value IDs in the order of the "values" array sent with the UI. The position in the table is the
+        // index used in the binary packets. The version changes if the table changes and packets with a different
+        // version are ignored by the client
+        //
+        // packet:  uint16_t type, uint8_t version, uint8_t count, value[count]
+        // value:   uint8_t index, uint8_t flags, payload
+        // flags:   bit 0-2 type, bit 3 has state, bit 4 state, bit 5-7 precision of float and double
+        // payload: BOOL uint8_t, INT32/UINT32 4 byte, FLOAT 4 byte, DOUBLE 8 byte, STRING uint8_t length + data, NONE/null no data
+        class BinaryTable {
+        public:
+            enum class ValueType : uint8_t {
+                NONE,
+                BOOL,
+                INT32,
+                UINT32,
+                FLOAT,
+                DOUBLE,
+                STRING,
+            };
+
+            static constexpr uint8_t kInvalidIndex = 0xff;
+            static constexpr uint8_t kMaxIndex = kInvalidIndex - 1;
+            static constexpr uint8_t kHasState = _BV(3);
+            static constexpr uint8_t kState = _BV(4);
+            static constexpr uint8_t kPrecisionShift = 5;
+            static constexpr uint8_t kTypeMask = 0x07;
+            static constexpr uint8_t kHeaderSize = 4;
+
+            struct Entry {
+                uint32_t hash;
+                uint8_t length;
+
+                Entry(uint32_t _hash, uint8_t _length) : hash(_hash), length(_length) {}
+            };
+
+            using EntryVector = std::vector<Entry>;
+
+        public:
+            static uint32_t hash(const __FlashStringHelper *id, uint8_t &length);
+            static uint32_t hash(const String &id, uint8_t &length);
+
+            static uint8_t find(uint32_t hash);
+            // replace table and update the version if it has changed
+            static void update(EntryVector &&table);
+
+            static uint8_t getVersion() {
+                return _version;
+            }
+
+            static const EntryVector &getTable() {
+                return _table;
+            }
+
+            // get precision from printf format
+            static uint8_t getPrecision(const __FlashStringHelper *format);
+
+            // exchange the table without changing the version
+            static void swap(EntryVector &table) {
+                _table.swap(table);
+            }
+
+            enum class Mode : uint8_t {
+                // encode the values while a client that can decode binary packets is connected
+                AUTO,
+                ON,
+                OFF,
+            };
+
+            static void setMode(Mode mode) {
+                _mode = mode;
+            }
+
+            // count of the clients that have sent "+binary 1"
+            static void attachClient() {
+                _clients++;
+            }
+
+            static void detachClient() {
+                if (_clients) {
+                    _clients--;
+                }
+            }
+
+            // returns true if the values are encoded
+            static bool isEnabled() {
+                return _mode == Mode::ON || (_mode == Mode::AUTO && _clients);
+            }
+
+            // returns true if the hash of the IDs is required
+            static bool isHashing() {
+                return _capture || isEnabled();
+            }
+
+            // the IDs are hashed while the "values" array for the table is created
+            class Capture {
+            public:
+                Capture() {
+                    _capture++;
+                }
+                ~Capture() {
+                    _capture--;
+                }
+            };
+
+        private:
+            static EntryVector _table;
+            static uint8_t _version;
+            static Mode _mode;
+            static uint8_t _clients;
+            static uint8_t _capture;
+        };
+
+    #endif
+
     class Values: public UnnamedObject {
     public:
         // do not add state
@@ -676,6 +798,14 @@ namespace WebUINS {
             } else if (state != kStateNone) {
                 append(NamedBool(J(s), state));
             }
+            #if WEBUI_BINARY_VALUES
+                if (BinaryTable::isHashing()) {
+                    _hash = BinaryTable::hash(id, _length);
+                }
+                if (BinaryTable::isEnabled()) {
+                    _encode(value, state == kStateAuto ? _validValue : state);
+                }
+            #endif
         }
 
         template<typename _Ta>
@@ -688,9 +818,130 @@ namespace WebUINS {
             else if (state != kStateNone) {
                 append(NamedBool(J(s), state));
             }
+            #if WEBUI_BINARY_VALUES
+                if (BinaryTable::isHashing()) {
+                    _hash = BinaryTable::hash(id, _length);
+                }
+                if (BinaryTable::isEnabled()) {
+                    _encode(value, state == kStateAuto ? _validValue : state);
+                }
+            #endif
         }
 
+        #if WEBUI_BINARY_VALUES
+
+            // returns false if the encoding is disabled
+            bool hasBinary() const {
+                return _binarySize != 0;
+            }
+
+            // append the encoded value without index
+            void encodeTo(std::vector<uint8_t> &output) const {
+                output.insert(output.end(), _binary, _binary + _binarySize);
+                output.insert(output.end(), _string.c_str(), _string.c_str() + _string.length());
+            }
+
+            uint32_t getHash() const {
+                return _hash;
+            }
+
+            uint8_t getIdLength() const {
+                return _length;
+            }
+
+        #endif
+
     private:
+        #if WEBUI_BINARY_VALUES
+
+            template<typename _Ta>
+            void _encode(_Ta value, int8_t state) {
+                _binarySize = 1;
+                _encodeValue(value);
+                if (state != kStateNone) {
+                    _binary[0] |= BinaryTable::kHasState | (state ? BinaryTable::kState : 0);
+                }
+            }
+
+            void _encodeType(BinaryTable::ValueType type, uint8_t precision = 0) {
+                _binary[0] = static_cast<uint8_t>(type) | (std::min<uint8_t>(precision, 7) << BinaryTable::kPrecisionShift);
+            }
+
+            void _encodeBytes(const void *data, size_t length) {
+                memcpy(_binary + _binarySize, data, length);
+                _binarySize += length;
+            }
+
+            void _encodeString(String &&str) {
+                _encodeType(BinaryTable::ValueType::STRING);
+                if (str.length() > 255) {
+                    str.remove(255);
+                }
+                _binary[_binarySize++] = static_cast<uint8_t>(str.length());
+                _string = std::move(str);
+            }
+
+            void _encodeValue(const __FlashStringHelper *value) {
+                _encodeString(String(value));
+            }
+
+            void _encodeValue(const String &value) {
+                _encodeString(String(value));
+            }
+
+            void _encodeValue(const char *value) {
+                _encodeString(String(value));
+            }
+
+            void _encodeValue(int32_t value) {
+                _encodeType(BinaryTable::ValueType::INT32);
+                _encodeBytes(&value, sizeof(value));
+            }
+
+            void _encodeValue(uint32_t value) {
+                _encodeType(BinaryTable::ValueType::UINT32);
+                _encodeBytes(&value, sizeof(value));
+            }
+
+            void _encodeValue(uint8_t value) {
+                _encodeValue(static_cast<uint32_t>(value));
+            }
+
+            void _encodeValue(bool value) {
+                _encodeType(BinaryTable::ValueType::BOOL);
+                _binary[_binarySize++] = value;
+            }
+
+            void _encodeValue(const FloatBase &value) {
+                if (!value.isFinite()) {
+                    _encodeType(BinaryTable::ValueType::NONE);
+                    return;
+                }
+                float tmp = value.getValue();
+                _encodeType(BinaryTable::ValueType::FLOAT, BinaryTable::getPrecision(value.getFormat()));
+                _encodeBytes(&tmp, sizeof(tmp));
+            }
+
+            void _encodeValue(const DoubleBase &value) {
+                if (!value.isFinite()) {
+                    _encodeType(BinaryTable::ValueType::NONE);
+                    return;
+                }
+                double tmp = value.getValue();
+                _encodeType(BinaryTable::ValueType::DOUBLE, BinaryTable::getPrecision(value.getFormat()));
+                _encodeBytes(&tmp, sizeof(tmp));
+            }
+
+            // flags and the payload of numbers or the length of a string
+            uint8_t _binary[1 + sizeof(double)];
+            uint8_t _binarySize{0};
+            // payload of strings
+            String _string;
+            uint32_t _hash{0};
+            uint8_t _length{0};
+
+        #endif
+
         NamedString getValueObject(const __FlashStringHelper *value) {
             _validValue = pgm_read_byte(reinterpret_cast<PGM_P>(value)) != 0;
             return NamedString(J(v), value);
@@ -759,14 +1010,48 @@ namespace WebUINS {
         {
         }
 
-        Events(WebUINS::Events::Values) : NamedArray(F("values"))
-        {}
+        #if WEBUI_BINARY_VALUES
 
-        template<typename ... _Args>
-        Events(_Args&& ...args) :
-            NamedArray(F("events"), std::forward<_Args>(args)...)
-        {
-        }
+            // the "values" array sent with the UI creates the table for the binary encoding
+            Events(WebUINS::Events::Values) : NamedArray(F("values")), _capture(true)
+            {}
+
+            template<typename ... _Args>
+            Events(_Args&& ...args) : Events()
+            {
+                append(std::forward<_Args>(args)...);
+            }
+
+            template<typename ... _Args>
+            void append(_Args&& ...args) {
+                // encode before the arguments are forwarded
+                int dummy[] = { (_encode(args), 0)... };
+                (void)dummy;
+                NamedArray::append(std::forward<_Args>(args)...);
+            }
+
+            // count and encoded values. returns an empty vector if any of the values cannot be encoded
+            const std::vector<uint8_t> &getBinary() const {
+                return _binaryValid ? _binary : _empty;
+            }
+
+            // the entries of the table in the order the values have been added
+            BinaryTable::EntryVector &getTable() {
+                return _table;
+            }
+
+        #else
+
+            Events(WebUINS::Events::Values) : NamedArray(F("values"))
+            {}
+
+            template<typename ... _Args>
+            Events(_Args&& ...args) :
+                NamedArray(F("events"), std::forward<_Args>(args)...)
+            {
+            }
+
+        #endif
 
         bool hasAny() const {
             // "events":[]
@@ -774,13 +1059,47 @@ namespace WebUINS {
             return length() > 11;
         }
 
+    #if WEBUI_BINARY_VALUES
+
+        private:
+            void _encode(const WebUINS::Values &value);
+
+            template<typename _Ta>
+            void _encode(const _Ta &) {
+                // not supported by the binary encoding
+                _binaryValid = false;
+            }
+
+            // allocated with the first encoded value
+            std::vector<uint8_t> _binary;
+            BinaryTable::EntryVector _table;
+            bool _binaryValid{true};
+            bool _capture{false};
+            static const std::vector<uint8_t> _empty;
+
+    #endif
     };
 
     class UpdateEvents : public UnnamedObject {
     public:
         UpdateEvents(const Events &events) : UnnamedObject(NamedString(J(type), J(update_events)), events)
+        #if WEBUI_BINARY_VALUES
+            , _binary(events.getBinary())
+        #endif
         {
         }
+
+        #if WEBUI_BINARY_VALUES
+
+            // count and encoded values for WsClient::BinaryPacketType::WEBUI_VALUES or empty
+            const std::vector<uint8_t> &getBinary() const {
+                return _binary;
+            }
+
+        private:
+            std::vector<uint8_t> _binary;
+
+        #endif
     };
 
 }
@@ -18,9 +18,35 @@
 
 class WebUISocket : public WsClient {
 public:
-    using WsClient::WsClient;
     using WsClient::hasClients;
 
+    #if WEBUI_BINARY_VALUES
+        // bytes and frames sent since boot
+        struct Stats {
+            uint32_t jsonFrames;
+            uint32_t jsonBytes;
+            uint32_t binaryFrames;
+            uint32_t binaryBytes;
+        };
+    #endif
+
+public:
+    WebUISocket(AsyncWebSocketClient *client) :
+        WsClient(client)
+        #if WEBUI_BINARY_VALUES
+            , _binary(false)
+        #endif
+    {
+    }
+
+    #if WEBUI_BINARY_VALUES
+        virtual ~WebUISocket() {
+            if (_binary) {
+                WebUINS::BinaryTable::detachClient();
+            }
+        }
+    #endif
+
 public:
     inline static WsClient *createInstance(AsyncWebSocketClient *socket) {
         return new WebUISocket(socket);
@@ -59,6 +85,8 @@ public:
     inline static void broadcast(WebUISocket *sender, const MQTT::Json::UnnamedObject &json) {
         WsClient::broadcast(getServerSocket(), sender, json);
     }
+    // send binary packets to clients that support it and JSON to all others
+    static void broadcast(WebUISocket *sender, const WebUINS::UpdateEvents &events);
     // text message with no encoding
     inline static void broadcast(WebUISocket *sender, const __FlashStringHelper *str) {
         WsClient::broadcast(getServerSocket(), sender, str, strlen(reinterpret_cast<PGM_P>(str)));
@@ -84,6 +112,19 @@ public:
         return _server;
     }
 
+    #if WEBUI_BINARY_VALUES
+        static void dumpStats(Print &output);
+        // compare encoding time and size of JSON and binary value updates with the current values
+        static void benchmark(Print &output, uint16_t iterations);
+    #endif
+
+private:
+    #if WEBUI_BINARY_VALUES
+        static void _decodeValues(WebUINS::Events &events, const std::vector<uint8_t> &data, const std::vector<String> &ids);
+
+        bool _binary;
+        static Stats _stats;
+    #endif
 
 private:
     static WebUISocket *_sender;
@@ -0,0 +1,125 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <EventScheduler.h>
+#include <memory>
+#include <vector>
+
+#ifndef DEBUG_ADC_SCHEDULER
+#    define DEBUG_ADC_SCHEDULER (0 || defined(DEBUG_ALL))
+#endif
+
+// Central scheduler for reading the ADC
+//
+// Consumers register with a sample interval, the size of the averaging window and a priority. A single timer reads
+// the ADC once for all consumers that are due and stores the value in each consumer's ring buffer. While the ADC is
+// locked (for example to measure the motor current of the blinds controller) the other consumers are not sampled
+// and the deadlines are counted as missed
+
+class ADCScheduler {
+public:
+    enum class PriorityType : uint8_t {
+        LOW,
+        NORMAL,
+        HIGH,
+    };
+
+    class Consumer {
+    public:
+        Consumer(const __FlashStringHelper *name, uint16_t intervalMillis, uint8_t window, PriorityType priority);
+
+        // average of the values in the ring buffer
+        uint16_t getAverage() const;
+        // last sampled value
+        uint16_t getValue() const;
+        // number of values in the ring buffer
+        uint8_t size() const;
+
+        void dump(Print &output) const;
+
+    private:
+        friend ADCScheduler;
+
+        void _push(uint16_t value);
+
+        const __FlashStringHelper *_name;
+        std::vector<uint16_t> _buffer;
+        uint32_t _sum;
+        uint32_t _due;
+        uint16_t _interval;
+        uint8_t _pos;
+        uint8_t _count;
+        PriorityType _priority;
+
+        // statistics
+        uint32_t _samples;
+        uint32_t _missed;
+        uint32_t _jitterSum;
+        uint16_t _jitterMax;
+    };
+
+    using ConsumerPtr = std::unique_ptr<Consumer>;
+    using ConsumerVector = std::vector<ConsumerPtr>;
+
+public:
+    ADCScheduler();
+
+    static ADCScheduler &getInstance();
+
+    // the returned object is owned by the scheduler and valid until it is removed
+    Consumer *add(const __FlashStringHelper *name, uint16_t intervalMillis, uint8_t window, PriorityType priority = PriorityType::NORMAL);
+    void remove(Consumer *consumer);
+
+    // reserve the ADC for exclusive use. the consumers are paused until the lock is released
+    void lock();
+    void unlock();
+    bool isLocked() const;
+
+    void dump(Print &output) const;
+
+private:
+    void _updateTimer();
+    void _timerCallback();
+
+    ConsumerVector _consumers;
+    Event::Timer _timer;
+    uint16_t _interval;
+    uint8_t _locked;
+    uint32_t _reads;
+};
+
+inline uint16_t ADCScheduler::Consumer::getAverage() const
+{
+    return _count ? (_sum / _count) : 0;
+}
+
+inline uint16_t ADCScheduler::Consumer::getValue() const
+{
+    return _count ? _buffer[(_pos + _buffer.size() - 1) % _buffer.size()] : 0;
+}
+
+inline uint8_t ADCScheduler::Consumer::size() const
+{
+    return _count;
+}
+
+inline void ADCScheduler::lock()
+{
+    _locked++;
+}
+
+inline void ADCScheduler::unlock()
+{
+    if (_locked) {
+        _locked--;
+    }
+}
+
+inline bool ADCScheduler::isLocked() const
+{
+    return _locked != 0;
+}
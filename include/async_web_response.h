@@ -19,6 +19,7 @@
 #include <TemplateDataProvider.h>
 #include <SSIProxyStream.h>
 #include "web_server.h"
+#include "web_server_admission.h"
 #include "bitmap_header.h"
 #include "../include/templates.h"
 #include "./plugins/mdns/mdns_plugin.h"
@@ -42,6 +43,9 @@ protected:
 
     HttpHeaders _httpHeaders;
     String _head;
+    // memory reserved by the admission control
+    WebServer::Admission::Ticket _ticket;
+    WebServer::Admission::PoolLease _poolLease;
 };
 
 #if MDNS_PLUGIN
@@ -12,9 +12,26 @@
 #    define DEBUG_LOGIN_FAILURES (0 || defined(DEBUG_ALL))
 #endif
 
+// Login failure tracker
+//
+// The failures are stored in a fixed size hash table indexed by the IP address. Each address has a token bucket with
+// the configured number of attempts that is refilled over the configured timeframe. If the bucket is empty, the
+// address is blocked. If all slots of the probe window are used, the least recently used record is replaced
+//
+// The table is written to the file system in batches after the rewrite interval and when the web server is stopped
+
+// number of records in the table, must be a power of 2
+#ifndef SECURITY_LOGIN_FAILURE_TABLE_SIZE
+#    if ESP8266
+#        define SECURITY_LOGIN_FAILURE_TABLE_SIZE 32
+#    else
+#        define SECURITY_LOGIN_FAILURE_TABLE_SIZE 128
+#    endif
+#endif
+
 #include <Arduino_compat.h>
+#include <EventScheduler.h>
 #include <time.h>
-#include <vector>
 
 #include <push_pack.h>
 
@@ -25,80 +42,138 @@ typedef struct __attribute__packed__ FailureCounterFileRecordStruct  {
     uint32_t lastFailure;
 } FailureCounterFileRecord_t;
 
+#include <pop_pack.h>
+
 class FailureCounterContainer;
 
 class FailureCounter  {
 public:
-    enum {
-        MAX_COUNTER = 0xfffe,
-        INVALID_DATA = 0xffff
-    };
-
-    FailureCounter(FailureCounterContainer &container);
-    FailureCounter(FailureCounterContainer &container, const FailureCounterFileRecord_t &record);
-    FailureCounter(FailureCounterContainer &container, const IPAddress &addr);
-
-    FailureCounter(FailureCounter &&move) :
-        _addr(move._addr),
-        _counter(move._counter),
-        _firstFailure(move._firstFailure),
-        _lastFailure(move._lastFailure),
-        _container(move._container)
-    {
-    }
-
-    FailureCounter &operator=(FailureCounter &&move) {
-        ::new(static_cast<void *>(this)) FailureCounter(std::move(move));
-        return *this;
-    }
+    // tokens are stored as fixed point value
+    static constexpr uint16_t kTokenScale = 256;
+    static constexpr uint16_t kMaxCounter = 0xffff;
+
+    FailureCounter();
 
     bool operator !() const;
     operator bool() const;
 
     uint32_t getTimeframe() const;
-    bool isBlocked(const IPAddress &addr) const;
-    bool isMatch(const IPAddress &addr) const;
     String getFirstFailure() const;
     uint32_t getCounter() const;
-    const IPAddress &getIPAddress() const;
+    IPAddress getIPAddress() const;
+    bool isMatch(uint32_t addr) const;
 
-    void addFailure();
-    void write(File &file) const;
+    FailureCounterFileRecord_t getRecord() const;
 
 private:
-    IPAddress _addr;
-    uint16_t _counter;
+    friend FailureCounterContainer;
+
+    uint32_t _addr;
     uint32_t _firstFailure;
     uint32_t _lastFailure;
-    FailureCounterContainer &_container;
+    // millis() of the last failure for the token bucket and LRU
+    uint32_t _lastMillis;
+    uint16_t _counter;
+    uint16_t _tokens;
 };
 
 class FailureCounterContainer {
 public:
-    FailureCounterContainer();
-    void clear() {
-        _failures.clear();
-    }
+    static constexpr uint16_t kTableSize = SECURITY_LOGIN_FAILURE_TABLE_SIZE;
+    // max. number of slots searched for an address
+    static constexpr uint8_t kMaxProbe = 8;
+
+    static_assert(kTableSize >= kMaxProbe && (kTableSize & (kTableSize - 1)) == 0, "SECURITY_LOGIN_FAILURE_TABLE_SIZE must be a power of 2 and 8 or greater");
+
+    FailureCounterContainer(bool persistent = true);
+    ~FailureCounterContainer();
+
+    void clear();
 
     const FailureCounter &addFailure(const IPAddress &addr);
     bool isAddressBlocked(const IPAddress &addr);
     void readFromFS();
-    void rewriteStorageFile();
+    // write all records to the file system
+    void flush();
 
-private:
-    friend FailureCounter;
+    void dump(Print &output) const;
 
-    void _removeOldRecords();
+    // replay failed logins from random addresses without writing to the file system
+    static void benchmark(Print &output, uint16_t failures, uint16_t addresses);
 
 private:
-    std::vector<FailureCounter> _failures;
-    time_t _lastRewrite;
+    uint16_t _getIndex(uint32_t addr) const;
+    FailureCounter *_find(uint32_t addr);
+    FailureCounter &_insert(uint32_t addr);
+    void _refill(FailureCounter &failure, uint32_t now) const;
+    bool _isExpired(const FailureCounter &failure, time_t now) const;
+    void _scheduleFlush();
+
+private:
+    FailureCounter _table[kTableSize];
+    Event::Timer _flushTimer;
     uint32_t _rewriteInterval;
     uint32_t _storageTimeframe;
     uint16_t _checkTimeframe;
     uint8_t _attempts;
+    bool _persistent;
+    bool _dirty;
+    // statistics
+    uint16_t _used;
+    uint32_t _evicted;
+    uint32_t _blocked;
+    uint32_t _writes;
 };
 
-#include <pop_pack.h>
+inline FailureCounter::FailureCounter() :
+    _addr(0),
+    _firstFailure(0),
+    _lastFailure(0),
+    _lastMillis(0),
+    _counter(0),
+    _tokens(0)
+{
+}
+
+inline bool FailureCounter::operator !() const
+{
+    return _addr == 0;
+}
+
+inline FailureCounter::operator bool() const
+{
+    return _addr != 0;
+}
+
+inline uint32_t FailureCounter::getTimeframe() const
+{
+    return _lastFailure - _firstFailure;
+}
+
+inline uint32_t FailureCounter::getCounter() const
+{
+    return _counter;
+}
+
+inline IPAddress FailureCounter::getIPAddress() const
+{
+    return IPAddress(_addr);
+}
+
+inline bool FailureCounter::isMatch(uint32_t addr) const
+{
+    return _addr == addr;
+}
+
+inline FailureCounterFileRecord_t FailureCounter::getRecord() const
+{
+    return { _addr, _counter, _firstFailure, _lastFailure };
+}
+
+inline uint16_t FailureCounterContainer::_getIndex(uint32_t addr) const
+{
+    // Fibonacci hashing, the last octet changes most
+    return (addr * 2654435761U) >> (32 - __builtin_ctz(kTableSize));
+}
 
 #endif
@@ -107,6 +107,7 @@ public:
     bool reconfigureWiFi(const __FlashStringHelper *msg = nullptr, uint8_t configNum = kKeepWiFiNetwork);
     bool connectWiFi(uint8_t configNum = kKeepWiFiNetwork, bool ignoreSoftAP = false);
     void read(bool wakeup = false);
+    // store settings if any value has been modified
     void write();
     #if defined(HAVE_NVS_FLASH)
         void formatNVS();
@@ -124,7 +125,9 @@ public:
     // ${zeroconf:<service>.<proto>:<address|value[:port value]>|<fallback[:port]>}
 
     // resolve zeroconf, optional port to use as default or 0
-    bool resolveZeroConf(const String &name, const String &hostname, uint16_t port, MDNSResolver::ResolvedCallback callback) const;
+    // if cached is true, the callback is executed with the last known address and the query runs in the background.
+    // the callback is executed a second time if the address or port has changed
+    bool resolveZeroConf(const String &name, const String &hostname, uint16_t port, MDNSResolver::ResolvedCallback callback, bool cached = false) const;
 
     // check if the hostname contains zeroconf
     bool hasZeroConf(const String &hostname) const;
@@ -246,6 +249,32 @@ public:
     void setWiFiErrors(uint8_t num);
     uint8_t getWiFiErrors() const;
 
+    // statistics of read() and write() since boot
+    struct WriteStats {
+        uint32_t writes;
+        uint32_t skipped;               // write() without any modifications
+        uint32_t failed;
+        uint32_t identical;             // values that have been set without being modified
+        uint32_t lastWriteTime;         // microseconds
+        uint32_t maxWriteTime;
+        uint64_t totalWriteTime;
+        uint32_t readTime;
+        uint16_t lastHandles;           // number of handles modified by the last write()
+        uint16_t lastBytes;             // size of the modified values
+        uint32_t lastFlashErased;       // bytes of flash memory erased and written by the last write()
+        uint32_t lastFlashWritten;
+        uint64_t totalFlashErased;
+        uint64_t totalFlashWritten;
+    };
+
+    // modified handles are collected by the store*Config() functions
+    void addDirtyHandle(Handle_t handle, uint16_t length);
+    // handles returned by getWriteableConfig() are compared with their CRC during write()
+    void addWriteableHandle(Handle_t handle, const void *data, uint16_t length);
+    void addIdenticalValue();
+    const WriteStats &getWriteStats() const;
+    void printWriteStats(Print &output) const;
+
 private:
     friend class KFCConfigurationPlugin;
     friend void WiFi_get_status(Print &out);
@@ -260,6 +289,18 @@ private:
     bool _dirty;
     bool _safeMode;
     // KFCJsonConfig _jsonConfig;
+    struct WriteableHandle {
+        Handle_t handle;
+        uint16_t length;
+        uint16_t crc;
+    };
+
+    void _collectWriteableHandles();
+
+    std::vector<Handle_t> _dirtyHandles;
+    std::vector<WriteableHandle> _writeableHandles;
+    uint16_t _dirtyBytes;
+    WriteStats _writeStats;
 
     static bool _initTwoWire;
 
@@ -287,6 +328,16 @@ inline void KFCFWConfiguration::setSafeMode(bool mode)
     _safeMode = mode;
 }
 
+inline void KFCFWConfiguration::addIdenticalValue()
+{
+    _writeStats.identical++;
+}
+
+inline const KFCFWConfiguration::WriteStats &KFCFWConfiguration::getWriteStats() const
+{
+    return _writeStats;
+}
+
 inline void KFCFWConfiguration::_apStandbyModeHandler(WiFiCallbacks::EventType event)
 {
     __LDBG_printf("event=%u", event);
@@ -0,0 +1,107 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+
+// Cooperative CPU arbitration between loop consumers
+//
+// Each consumer has a time budget per loop pass and a priority (weight). Consumers running inside the main loop
+// report their measured costs and ask how much time they have to give up for other active consumers (web server,
+// MQTT, ...) instead of using a fixed delay. The share is calculated from the weights and the measured costs
+
+#ifndef DEBUG_LOOP_BUDGET
+#    define DEBUG_LOOP_BUDGET (0 || defined(DEBUG_ALL))
+#endif
+
+// default budget and priority per consumer. the budget is in microseconds per loop pass and pending item
+#ifndef LOOP_BUDGET_ANIMATION
+#    define LOOP_BUDGET_ANIMATION 20000, 4
+#endif
+
+#ifndef LOOP_BUDGET_LED_SHOW
+#    define LOOP_BUDGET_LED_SHOW 10000, 4
+#endif
+
+#ifndef LOOP_BUDGET_WEB_SERVER
+#    define LOOP_BUDGET_WEB_SERVER 15000, 3
+#endif
+
+#ifndef LOOP_BUDGET_MQTT
+#    define LOOP_BUDGET_MQTT 5000, 1
+#endif
+
+// max. time to yield per loop pass in microseconds
+#ifndef LOOP_BUDGET_MAX_YIELD_TIME
+#    define LOOP_BUDGET_MAX_YIELD_TIME 50000
+#endif
+
+namespace LoopBudget {
+
+    enum class ConsumerType : uint8_t {
+        ANIMATION,
+        LED_SHOW,
+        WEB_SERVER,
+        MQTT,
+        MAX
+    };
+
+    struct Consumer {
+        PGM_P name;
+        // microseconds per loop pass and pending item
+        uint16_t budget;
+        // weight for splitting the CPU time
+        uint8_t priority;
+        // number of pending items, 0 = idle
+        uint16_t demand;
+        // exponential moving average of the costs per call in microseconds * 16
+        uint32_t avgCost;
+        // accumulated time in microseconds since the last reset
+        uint64_t totalTime;
+        uint32_t calls;
+
+        uint32_t getAvgCost() const {
+            return avgCost >> 4;
+        }
+
+        bool isActive() const {
+            return demand != 0;
+        }
+    };
+
+    // the consumer is the owner of the main loop if it calls yieldToOthers()
+    uint32_t getYieldTime(ConsumerType owner, uint32_t usedTime);
+    // give up time for other active consumers. returns the time yielded in microseconds
+    uint32_t yieldToOthers(ConsumerType owner, uint32_t usedTime);
+
+    void setBudget(ConsumerType type, uint16_t budget, uint8_t priority);
+    void setDemand(ConsumerType type, uint16_t demand);
+    void addTime(ConsumerType type, uint32_t time);
+
+    Consumer &getConsumer(ConsumerType type);
+
+    void reset();
+    // CPU share of each consumer and the time yielded since the last reset
+    void printReport(Print &output);
+
+    // measure the time until the object goes out of scope
+    class Measure {
+    public:
+        Measure(ConsumerType type) : _start(micros()), _type(type) {}
+        ~Measure() {
+            addTime(_type, micros() - _start);
+        }
+
+    private:
+        uint32_t _start;
+        ConsumerType _type;
+    };
+
+    inline void setDemand(ConsumerType type, uint16_t demand)
+    {
+        getConsumer(type).demand = demand;
+    }
+
+}
@@ -0,0 +1,241 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+
+// Runtime metrics
+//
+// Counters, gauges and histograms are static objects that add themselves to the registry when they are constructed.
+// Names and descriptions are stored in PROGMEM and the buckets of a histogram are part of the object, registering a
+// metric does not allocate any memory. Each metric has a single writer and updates are a store or an add without
+// locking. On ESP32 counters, gauges and the buckets of histograms use 32 bit atomic adds, since the metrics are
+// exported from the async_tcp task. The 64 bit sum of a histogram is best-effort and can be read while it is updated
+//
+// Gauges can have a callback that reads the value when the metrics are exported instead of updating it periodically
+//
+// The registry is exported in the Prometheus text format through /metrics and +METRICS
+
+#ifndef KFC_METRICS
+#    define KFC_METRICS 1
+#endif
+
+#ifndef DEBUG_METRICS
+#    define DEBUG_METRICS (0 || defined(DEBUG_ALL))
+#endif
+
+#if KFC_METRICS
+
+// define a metric with the name and description stored in PROGMEM
+#define METRICS_COUNTER_DEF(var, name, help) \
+    static const char var##_name[] PROGMEM = name; \
+    static const char var##_help[] PROGMEM = help; \
+    Metrics::Counter var(var##_name, var##_help)
+
+#define METRICS_GAUGE_DEF(var, name, help) \
+    static const char var##_name[] PROGMEM = name; \
+    static const char var##_help[] PROGMEM = help; \
+    Metrics::Gauge var(var##_name, var##_help)
+
+// the callback is invoked when the metrics are exported
+#define METRICS_GAUGE_CALLBACK_DEF(var, name, help, callback) \
+    static const char var##_name[] PROGMEM = name; \
+    static const char var##_help[] PROGMEM = help; \
+    Metrics::Gauge var(var##_name, var##_help, callback)
+
+// upper bounds of the buckets in ascending order, the last bucket counts all values above
+#define METRICS_HISTOGRAM_DEF(var, name, help, ...) \
+    static const char var##_name[] PROGMEM = name; \
+    static const char var##_help[] PROGMEM = help; \
+    static const uint32_t var##_bounds[] PROGMEM = { __VA_ARGS__ }; \
+    Metrics::Histogram<sizeof(var##_bounds) / sizeof(var##_bounds[0])> var(var##_name, var##_help, var##_bounds)
+
+namespace Metrics {
+
+    enum class Type : uint8_t {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM,
+    };
+
+    class Metric {
+    public:
+        Metric(PGM_P name, PGM_P help, Type type);
+        Metric(const Metric &) = delete;
+        Metric &operator=(const Metric &) = delete;
+
+        PGM_P getName() const;
+        PGM_P getHelp() const;
+        Type getType() const;
+        Metric *getNext() const;
+
+        // print the samples without HELP and TYPE
+        virtual void printSamples(Print &output) const = 0;
+
+        static Metric *getFirst();
+
+    private:
+        PGM_P _name;
+        PGM_P _help;
+        Metric *_next;
+        Type _type;
+
+        static Metric *_head;
+        static Metric **_tail;
+    };
+
+    class Counter : public Metric {
+    public:
+        Counter(PGM_P name, PGM_P help) : Metric(name, help, Type::COUNTER), _value(0) {}
+
+        void add(uint32_t value = 1);
+        uint32_t get() const;
+
+        virtual void printSamples(Print &output) const override;
+
+    private:
+        volatile uint32_t _value;
+    };
+
+    class Gauge : public Metric {
+    public:
+        using Callback = int32_t (*)();
+
+        Gauge(PGM_P name, PGM_P help, Callback callback = nullptr) : Metric(name, help, Type::GAUGE), _value(0), _callback(callback) {}
+
+        void set(int32_t value);
+        void add(int32_t value);
+        int32_t get() const;
+
+        virtual void printSamples(Print &output) const override;
+
+    private:
+        volatile int32_t _value;
+        Callback _callback;
+    };
+
+    class HistogramBase : public Metric {
+    public:
+        HistogramBase(PGM_P name, PGM_P help, const uint32_t *bounds, uint32_t *counts, uint8_t size);
+
+        void observe(uint32_t value);
+        uint32_t getCount() const;
+
+        virtual void printSamples(Print &output) const override;
+
+    private:
+        // upper bounds in PROGMEM
+        const uint32_t *_bounds;
+        // size + 1 buckets, the counts are not cumulative
+        uint32_t *_counts;
+        // best-effort, not updated atomically
+        uint64_t _sum;
+        uint32_t _count;
+        uint8_t _size;
+    };
+
+    template<size_t _Size>
+    class Histogram : public HistogramBase {
+    public:
+        static_assert(_Size > 0 && _Size < 0xff, "invalid number of buckets");
+
+        Histogram(PGM_P name, PGM_P help, const uint32_t (&bounds)[_Size]) : HistogramBase(name, help, bounds, _buckets, _Size), _buckets() {}
+
+    private:
+        uint32_t _buckets[_Size + 1];
+    };
+
+    // streams the metrics into the buffers of a chunked response
+    class Writer {
+    public:
+        Writer();
+
+        // returns the number of bytes copied to buffer, 0 if all metrics have been written
+        size_t read(uint8_t *buffer, size_t maxLen);
+
+    private:
+        Metric *_metric;
+        String _pending;
+    };
+
+    // print a metric including HELP and TYPE
+    void printMetric(Print &output, const Metric &metric);
+    // print all metrics
+    void print(Print &output);
+
+    // time between two calls of loop() in microseconds
+    void loopInterval();
+
+    #if ESP32
+        // set by the CPU monitor
+        extern Gauge cpuLoad;
+    #endif
+
+    inline PGM_P Metric::getName() const
+    {
+        return _name;
+    }
+
+    inline PGM_P Metric::getHelp() const
+    {
+        return _help;
+    }
+
+    inline Type Metric::getType() const
+    {
+        return _type;
+    }
+
+    inline Metric *Metric::getNext() const
+    {
+        return _next;
+    }
+
+    inline Metric *Metric::getFirst()
+    {
+        return _head;
+    }
+
+    inline void Counter::add(uint32_t value)
+    {
+        #if ESP32
+            __atomic_fetch_add(&_value, value, __ATOMIC_RELAXED);
+        #else
+            _value = _value + value;
+        #endif
+    }
+
+    inline uint32_t Counter::get() const
+    {
+        return _value;
+    }
+
+    inline void Gauge::set(int32_t value)
+    {
+        _value = value;
+    }
+
+    inline void Gauge::add(int32_t value)
+    {
+        #if ESP32
+            __atomic_fetch_add(&_value, value, __ATOMIC_RELAXED);
+        #else
+            _value = _value + value;
+        #endif
+    }
+
+    inline int32_t Gauge::get() const
+    {
+        return _callback ? _callback() : _value;
+    }
+
+    inline uint32_t HistogramBase::getCount() const
+    {
+        return _count;
+    }
+
+}
+
+#endif
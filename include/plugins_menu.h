@@ -6,16 +6,188 @@
 
 #include <Arduino_compat.h>
 #include <stl_ext/memory>
+#include <vector>
 #include "plugins.h"
-#include <BootstrapMenu.h>
+
+// Navigation menu of the web interface
+//
+// The system entries are stored in a PROGMEM table and rendered directly from flash. Plugins using MenuType::AUTO
+// add a single entry that points to their config forms in PROGMEM. Only entries added at runtime by MenuType::CUSTOM
+// plugins are kept in RAM
+
+class WebMenu {
+public:
+    using menu_item_id_t = uint16_t;
+
+    // top level menus
+    enum class MenuType : menu_item_id_t {
+        HOME,
+        STATUS,
+        CONFIG,
+        DEVICE,
+        ADMIN,
+        UTIL,
+        MAX
+    };
+
+    static constexpr menu_item_id_t kInvalidId = ~0;
+
+    enum class ItemType : uint8_t {
+        ITEM,
+        SUB_MENU,
+        DIVIDER,
+        PLUGIN_FORMS,   // one item for each config form of a MenuType::AUTO plugin, the URI is the list of forms
+    };
+
+    // menu entries stored in PROGMEM
+    typedef struct __attribute__packed__ {
+        PGM_P label;
+        PGM_P uri;
+        MenuType menu;
+    } StaticItem_t;
+
+    // top level menus stored in PROGMEM. menus with an URI are displayed as link
+    typedef struct __attribute__packed__ {
+        PGM_P label;
+        PGM_P uri;
+    } StaticMenu_t;
+
+    // string stored in PROGMEM or allocated on the heap
+    class MenuString {
+    public:
+        MenuString(const __FlashStringHelper *str);
+        MenuString(const String &str);
+        MenuString(MenuString &&move) noexcept;
+        ~MenuString();
+
+        MenuString &operator=(MenuString &&move) noexcept;
+
+        const char *c_str() const;
+        bool isProgmem() const;
+        bool equals(const char *str, bool ignoreCase) const;
+
+    private:
+        const char *_str;
+        bool _allocated;
+    };
+
+    // entries added at runtime
+    class Item {
+    public:
+        Item(menu_item_id_t id, menu_item_id_t parentId, menu_item_id_t anchorId, ItemType type, MenuString &&label, MenuString &&uri);
+
+        menu_item_id_t getId() const;
+
+    private:
+        friend WebMenu;
+
+        MenuString _label;
+        MenuString _uri;
+        menu_item_id_t _id;
+        menu_item_id_t _parentId;
+        // the item is displayed after the static or dynamic item with this id or at the top if the anchor is the parent
+        menu_item_id_t _anchorId;
+        ItemType _type;
+    };
+
+    using ItemsVector = std::vector<Item>;
+
+    // static, auto or dynamic item passed to the renderer
+    struct ItemView {
+        ItemType type;
+        menu_item_id_t id;
+        const char *label;
+        bool labelIsProgmem;
+        const char *uri;
+        bool uriIsProgmem;
+        PGM_P uriSuffix;
+    };
+
+    // helper to add entries to a (sub)menu
+    class MenuItem {
+    public:
+        MenuItem(WebMenu &menu, menu_item_id_t id);
+
+        menu_item_id_t addMenuItem(MenuString &&label, MenuString &&uri);
+        MenuItem addSubMenu(MenuString &&label);
+        void addDivider();
+
+        menu_item_id_t getId() const;
+
+    private:
+        WebMenu &_menu;
+        menu_item_id_t _id;
+    };
+
+public:
+    WebMenu();
+
+    // add menu item to parentId. if insertAfterId is set, the item is inserted after this id or at the top if it is equal to parentId
+    menu_item_id_t addMenuItem(MenuString &&label, MenuString &&uri, menu_item_id_t parentId, menu_item_id_t insertAfterId = kInvalidId);
+    menu_item_id_t addSubMenu(MenuString &&label, menu_item_id_t parentId);
+    menu_item_id_t addDivider(menu_item_id_t parentId);
+    // add the config forms of a plugin using MenuType::AUTO
+    menu_item_id_t addPluginForms(const PluginComponent &plugin, menu_item_id_t parentId);
+
+    MenuItem getMenuItem(menu_item_id_t id);
+
+    // returns kInvalidId if not found. if parentId is kInvalidId all menus are searched
+    menu_item_id_t findMenuByLabel(const String &label, menu_item_id_t parentId = kInvalidId) const;
+    menu_item_id_t findMenuByLabel(const __FlashStringHelper *label, menu_item_id_t parentId = kInvalidId) const;
+    menu_item_id_t findMenuByURI(const String &uri, menu_item_id_t parentId = kInvalidId) const;
+    menu_item_id_t findMenuByURI(const __FlashStringHelper *uri, menu_item_id_t parentId = kInvalidId) const;
+
+    bool isValid(menu_item_id_t id) const;
+
+    // only dynamic items can be removed
+    bool remove(menu_item_id_t id);
+
+    // navigation bar
+    void html(Print &output);
+    // single top level menu
+    void html(Print &output, menu_item_id_t menuId);
+    // list group of a top level menu
+    void htmlSubMenu(Print &output, menu_item_id_t menuId);
+    // render a single part of a top level menu to stream the menu without buffering it
+    // returns false if the part does not exist
+    bool html(Print &output, menu_item_id_t menuId, uint16_t part, bool listGroup);
+
+    static constexpr menu_item_id_t getId(MenuType menu) {
+        return static_cast<menu_item_id_t>(menu);
+    }
+
+    static bool isStaticId(menu_item_id_t id);
+    static bool isMenuId(menu_item_id_t id);
+
+private:
+    using ItemCallback = std::function<void(const ItemView &item)>;
+
+    menu_item_id_t _add(ItemType type, MenuString &&label, MenuString &&uri, menu_item_id_t parentId, menu_item_id_t insertAfterId);
+    menu_item_id_t _findStatic(const char *str, bool byLabel, menu_item_id_t parentId) const;
+    menu_item_id_t _findDynamic(const char *str, bool byLabel, menu_item_id_t parentId) const;
+    bool _hasItems(menu_item_id_t menuId);
+
+    // iterate all items of a menu in the order they are displayed
+    void _forEach(menu_item_id_t parentId, ItemCallback callback);
+    void _forEachDynamic(menu_item_id_t parentId, menu_item_id_t anchorId, ItemCallback callback);
+    void _forEachPluginForm(const Item &item, ItemCallback callback);
+    void _invokeCallback(const Item &item, ItemCallback callback);
+
+    void _printItem(Print &output, const ItemView &item, bool listGroup);
+    void _printString(Print &output, const char *str, bool isProgmem);
+
+private:
+    ItemsVector _items;
+    menu_item_id_t _nextId;
+};
 
 struct NavMenu {
-    BootstrapMenu::menu_item_id_t home;
-    BootstrapMenu::menu_item_id_t status;
-    BootstrapMenu::menu_item_id_t config;
-    BootstrapMenu::menu_item_id_t device;
-    BootstrapMenu::menu_item_id_t admin;
-    BootstrapMenu::menu_item_id_t util;
+    static constexpr WebMenu::menu_item_id_t home = WebMenu::getId(WebMenu::MenuType::HOME);
+    static constexpr WebMenu::menu_item_id_t status = WebMenu::getId(WebMenu::MenuType::STATUS);
+    static constexpr WebMenu::menu_item_id_t config = WebMenu::getId(WebMenu::MenuType::CONFIG);
+    static constexpr WebMenu::menu_item_id_t device = WebMenu::getId(WebMenu::MenuType::DEVICE);
+    static constexpr WebMenu::menu_item_id_t admin = WebMenu::getId(WebMenu::MenuType::ADMIN);
+    static constexpr WebMenu::menu_item_id_t util = WebMenu::getId(WebMenu::MenuType::UTIL);
 };
 
 #define bootstrapMenu       PluginComponents::RegisterEx::getBootstrapMenu()
@@ -28,18 +200,17 @@ namespace PluginComponents {
         using Register::Register;
 
         static RegisterEx &getInstance();
-        static BootstrapMenu &getBootstrapMenu();
+        static WebMenu &getBootstrapMenu();
         static NavMenu &getNavMenu();
 
     private:
         friend Register;
 
-        void _createMenu();
-        BootstrapMenu &_getBootstrapMenu();
+        WebMenu &_getBootstrapMenu();
         NavMenu &_getNavMenu();
 
     private:
-        BootstrapMenu _bootstrapMenu;
+        WebMenu _bootstrapMenu;
         NavMenu _navMenu;
     };
 
@@ -52,7 +223,7 @@ namespace PluginComponents {
     }
 
     inline __attribute__((__always_inline__))
-    BootstrapMenu &RegisterEx::getBootstrapMenu()
+    WebMenu &RegisterEx::getBootstrapMenu()
     {
         return getInstance()._getBootstrapMenu();
     }
@@ -64,7 +235,7 @@ namespace PluginComponents {
     }
 
     inline __attribute__((__always_inline__))
-    BootstrapMenu &RegisterEx::_getBootstrapMenu()
+    WebMenu &RegisterEx::_getBootstrapMenu()
     {
         return _bootstrapMenu;
     }
@@ -75,3 +246,138 @@ namespace PluginComponents {
         return _navMenu;
     }
 }
+
+inline WebMenu::MenuString::MenuString(const __FlashStringHelper *str) :
+    _str(reinterpret_cast<const char *>(str)),
+    _allocated(false)
+{
+}
+
+inline WebMenu::MenuString::MenuString(const String &str) :
+    _str(strdup(str.c_str())),
+    _allocated(true)
+{
+}
+
+inline WebMenu::MenuString::MenuString(MenuString &&move) noexcept :
+    _str(std::exchange(move._str, nullptr)),
+    _allocated(std::exchange(move._allocated, false))
+{
+}
+
+inline WebMenu::MenuString::~MenuString()
+{
+    if (_allocated && _str) {
+        free(const_cast<char *>(_str));
+    }
+}
+
+inline WebMenu::MenuString &WebMenu::MenuString::operator=(MenuString &&move) noexcept
+{
+    this->~MenuString();
+    ::new(static_cast<void *>(this)) MenuString(std::move(move));
+    return *this;
+}
+
+inline const char *WebMenu::MenuString::c_str() const
+{
+    return _str ? _str : emptyString.c_str();
+}
+
+inline bool WebMenu::MenuString::isProgmem() const
+{
+    return !_allocated;
+}
+
+inline WebMenu::Item::Item(menu_item_id_t id, menu_item_id_t parentId, menu_item_id_t anchorId, ItemType type, MenuString &&label, MenuString &&uri) :
+    _label(std::move(label)),
+    _uri(std::move(uri)),
+    _id(id),
+    _parentId(parentId),
+    _anchorId(anchorId),
+    _type(type)
+{
+}
+
+inline WebMenu::menu_item_id_t WebMenu::Item::getId() const
+{
+    return _id;
+}
+
+inline WebMenu::MenuItem::MenuItem(WebMenu &menu, menu_item_id_t id) :
+    _menu(menu),
+    _id(id)
+{
+}
+
+inline WebMenu::menu_item_id_t WebMenu::MenuItem::addMenuItem(MenuString &&label, MenuString &&uri)
+{
+    return _menu.addMenuItem(std::move(label), std::move(uri), _id);
+}
+
+inline WebMenu::MenuItem WebMenu::MenuItem::addSubMenu(MenuString &&label)
+{
+    return MenuItem(_menu, _menu.addSubMenu(std::move(label), _id));
+}
+
+inline void WebMenu::MenuItem::addDivider()
+{
+    _menu.addDivider(_id);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::MenuItem::getId() const
+{
+    return _id;
+}
+
+inline WebMenu::MenuItem WebMenu::getMenuItem(menu_item_id_t id)
+{
+    return MenuItem(*this, id);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::addMenuItem(MenuString &&label, MenuString &&uri, menu_item_id_t parentId, menu_item_id_t insertAfterId)
+{
+    return _add(ItemType::ITEM, std::move(label), std::move(uri), parentId, insertAfterId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::addSubMenu(MenuString &&label, menu_item_id_t parentId)
+{
+    return _add(ItemType::SUB_MENU, std::move(label), MenuString(F("")), parentId, kInvalidId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::addDivider(menu_item_id_t parentId)
+{
+    return _add(ItemType::DIVIDER, MenuString(F("")), MenuString(F("")), parentId, kInvalidId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::addPluginForms(const PluginComponent &plugin, menu_item_id_t parentId)
+{
+    return _add(ItemType::PLUGIN_FORMS, MenuString(plugin.getFriendlyName()), MenuString(FPSTR(plugin.getConfigForms())), parentId, kInvalidId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::findMenuByLabel(const __FlashStringHelper *label, menu_item_id_t parentId) const
+{
+    return findMenuByLabel(String(label), parentId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::findMenuByLabel(const String &label, menu_item_id_t parentId) const
+{
+    auto id = _findStatic(label.c_str(), true, parentId);
+    return (id != kInvalidId) ? id : _findDynamic(label.c_str(), true, parentId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::findMenuByURI(const __FlashStringHelper *uri, menu_item_id_t parentId) const
+{
+    return findMenuByURI(String(uri), parentId);
+}
+
+inline WebMenu::menu_item_id_t WebMenu::findMenuByURI(const String &uri, menu_item_id_t parentId) const
+{
+    auto id = _findStatic(uri.c_str(), false, parentId);
+    return (id != kInvalidId) ? id : _findDynamic(uri.c_str(), false, parentId);
+}
+
+inline bool WebMenu::isMenuId(menu_item_id_t id)
+{
+    return id < getId(MenuType::MAX);
+}
@@ -403,6 +403,7 @@ AUTO_STRING_DEF(status_html, "status.html")
 AUTO_STRING_DEF(stk500v1_log_file, "/stk500v1/debug.log")
 AUTO_STRING_DEF(stk500v1_sig_file, "/stk500v1/atmega.csv")
 AUTO_STRING_DEF(stk500v1_tmp_file, "/stk500v1/firmware_tmp.hex")
+AUTO_STRING_DEF(stk500v1_img_file, "/stk500v1/firmware.img")
 AUTO_STRING_DEF(stopped, "stopped")
 AUTO_STRING_DEF(strftime_date_time_zone, "%FT%T %Z")
 AUTO_STRING_DEF(string, "string")
@@ -482,6 +482,7 @@ PROGMEM_STRING_DECL(status_html);
 PROGMEM_STRING_DECL(stk500v1_log_file);
 PROGMEM_STRING_DECL(stk500v1_sig_file);
 PROGMEM_STRING_DECL(stk500v1_tmp_file);
+PROGMEM_STRING_DECL(stk500v1_img_file);
 PROGMEM_STRING_DECL(stopped);
 PROGMEM_STRING_DECL(string);
 PROGMEM_STRING_DECL(sys);
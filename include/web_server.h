@@ -16,6 +16,12 @@
 #    define WEBSERVER_LOG_SERIAL 1
 #endif
 
+// buffer OTA uploads in flash sector sized blocks. on ESP8266 the blocks are written from the main loop after the
+// TCP callback has returned
+#ifndef WEBSERVER_OTA_WRITE_BEHIND
+#    define WEBSERVER_OTA_WRITE_BEHIND 1
+#endif
+
 #if !ENABLE_ARDUINO_OTA && !WEBSERVER_KFC_OTA
 #    error OTA not enabled
 #endif
@@ -27,6 +33,7 @@
 #include <HeapStream.h>
 #include "plugins.h"
 #include "web_socket.h"
+#include "web_server_routes.h"
 #ifdef ENABLE_ARDUINO_OTA
 #    include <ArduinoOTA.h>
 #endif
@@ -104,8 +111,34 @@ namespace WebServer {
         FSR_FFS
     };
 
+    struct UploadStats
+    {
+        uint32_t start;
+        uint32_t duration;
+        uint32_t size;
+        // time spent writing to the flash in microseconds
+        uint32_t flashTime;
+        // time the TCP callback was blocked by flash writes in microseconds
+        uint32_t stallTime;
+        uint32_t maxStallTime;
+        uint16_t writes;
+        // segments received out of order, which have been retransmitted by the sender
+        uint16_t retransmits;
+
+        UploadStats() : start(0), duration(0), size(0), flashTime(0), stallTime(0), maxStallTime(0), writes(0), retransmits(0) {}
+
+        uint32_t getBytesPerSecond() const {
+            return duration ? (static_cast<uint64_t>(size) * 1000) / duration : 0;
+        }
+
+        void dump(Print &output) const;
+    };
+
     struct UploadStatus
     {
+        static constexpr size_t kSectorSize = 4096;
+        static constexpr uint8_t kNumBuffers = 2;
+
         AsyncWebServerResponse *response;
         bool error;
         uint8_t command;
@@ -113,6 +146,15 @@ namespace WebServer {
         bool authenticated;
         uint16_t progress;
         ResetOptionsType resetOptions;
+        #if WEBSERVER_OTA_WRITE_BEHIND
+            // sector buffers, the current one is filled while the other one might wait to be written
+            std::unique_ptr<uint8_t[]> buffer;
+            uint16_t fill;
+            uint8_t current;
+            bool pending;
+        #endif
+        bool outOfOrder;
+        UploadStats stats;
 
         UploadStatus() :
             response(nullptr),
@@ -121,9 +163,25 @@ namespace WebServer {
             size(0),
             authenticated(false),
             progress(~0),
-            resetOptions(ResetOptionsType::NONE)
+            resetOptions(ResetOptionsType::NONE),
+            #if WEBSERVER_OTA_WRITE_BEHIND
+                fill(0),
+                current(0),
+                pending(false),
+            #endif
+            outOfOrder(false)
         {
         }
+        ~UploadStatus();
+
+        #if WEBSERVER_OTA_WRITE_BEHIND
+            uint8_t *getBuffer(uint8_t index) {
+                return &buffer[index * kSectorSize];
+            }
+        #endif
+
+        // upload that receives the pending writes from the main loop
+        static UploadStatus *_active;
     };
 
     class RestHandler {
@@ -143,9 +201,10 @@ namespace WebServer {
 
     class RestRequest {
     public:
-        RestRequest(AsyncWebServerRequest *request, const RestHandler &handler, AuthType auth);
+        RestRequest(AsyncWebServerRequest *request, const RestHandler &handler, AuthType auth, RouteTable::Route *route = nullptr);
 
         AuthType getAuth() const;
+        RouteTable::Route *getRoute() const;
 
         RestHandler &getHandler();
         KFCJson::JsonMapReader &getJsonReader();
@@ -158,6 +217,7 @@ namespace WebServer {
     private:
         AsyncWebServerRequest *_request;
         RestHandler _handler;
+        RouteTable::Route *_route;
         AuthType _auth;
         HeapStream _stream;
         KFCJson::JsonMapReader _reader;
@@ -176,6 +236,25 @@ namespace WebServer {
         }
     };
 
+    // POST /import-settings with a JSON body. the configuration is parsed while the body is received and
+    // the memory usage is limited to the largest single value. form data with the "config" argument is
+    // passed to the not found handler
+    class AsyncImportSettingsWebHandler : public AsyncWebHandler {
+    public:
+        using AsyncWebHandler::AsyncWebHandler;
+
+        inline static const __FlashStringHelper *getURI() {
+            return F("/import-settings");
+        }
+
+        virtual bool canHandle(AsyncWebServerRequest *request) override;
+        virtual void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) override;
+        virtual void handleRequest(AsyncWebServerRequest *request) override;
+        virtual bool isRequestHandlerTrivial() override {
+            return false;
+        }
+    };
+
     #if WEBSERVER_KFC_OTA
 
         class AsyncUpdateWebHandler : public AsyncWebHandler {
@@ -193,8 +272,16 @@ namespace WebServer {
                 return false;
             }
 
+            static void dumpStats(Print &output);
+
         private:
             UploadStatus *_validateSession(AsyncWebServerRequest *request, int index);
+            static void _write(UploadStatus &status, const uint8_t *data, size_t len, bool blocking);
+            static void _writePending(UploadStatus &status, bool blocking);
+            static void _flush(UploadStatus &status);
+
+            // statistics of the last upload
+            static UploadStats _lastStats;
         };
 
     #endif
@@ -285,6 +372,9 @@ namespace WebServer {
 
         static void executeDelayed(AsyncWebServerRequest *request, std::function<void()> callback);
 
+        // returns nullptr if the web server is not running
+        static RouteTable *getRouteTable();
+
     public:
         static const __FlashStringHelper *getAuthTypeStr(AuthType type);
 
@@ -326,6 +416,7 @@ namespace WebServer {
 
     private:
         friend AsyncRestWebHandler;
+        friend AsyncImportSettingsWebHandler;
         #if WEBSERVER_KFC_OTA
             friend AsyncUpdateWebHandler;
         #endif
@@ -420,6 +511,7 @@ namespace WebServer {
         void _handlerExportSettings(AsyncWebServerRequest *request, HttpHeaders &httpHeaders);
         void _handlerAlerts(AsyncWebServerRequest *request, HttpHeaders &httpHeaders);
         void _addRestHandler(RestHandler &&handler);
+        void _addRoutes();
 
     };
 
@@ -430,6 +522,12 @@ namespace WebServer {
         }
     #endif
 
+    inline RouteTable *Plugin::getRouteTable()
+    {
+        auto server = getWebServerObject();
+        return server ? &server->_routes : nullptr;
+    }
+
     inline void Plugin::addRestHandler(RestHandler &&handler)
     {
         getInstance()._addRestHandler(std::move(handler));
@@ -502,6 +600,7 @@ namespace WebServer {
         friend AsyncRestWebHandler;
 
         RestHandlerVector _restCallbacks;
+        RouteTable _routes;
     };
 
     extern "C" Plugin webServerPlugin;
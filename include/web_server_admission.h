@@ -0,0 +1,252 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <EventScheduler.h>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Memory admission control for responses
+//
+// Template, form, directory listing and WiFi scan responses allocate their buffers when the request arrives. Each
+// type has an estimated peak memory usage that is reserved before the response is created and released when the
+// response has been destroyed. If the budget or the free heap is exhausted, the request is queued until another
+// response has finished or answered with "503 Service Unavailable" and a Retry-After header
+//
+// The buffers used to send the responses are shared from a small pool instead of being allocated for each packet. The
+// pool is allocated when the first buffer is requested and freed when the last response has been destroyed
+
+#ifndef WEBSERVER_ADMISSION_CONTROL
+#    define WEBSERVER_ADMISSION_CONTROL 1
+#endif
+
+// max. memory reserved for all responses
+#ifndef WEBSERVER_ADMISSION_BUDGET
+#    if ESP8266
+#        define WEBSERVER_ADMISSION_BUDGET 12288
+#    else
+#        define WEBSERVER_ADMISSION_BUDGET 49152
+#    endif
+#endif
+
+// min. free heap after admitting a response
+#ifndef WEBSERVER_ADMISSION_MIN_FREE_HEAP
+#    if ESP8266
+#        define WEBSERVER_ADMISSION_MIN_FREE_HEAP 6144
+#    else
+#        define WEBSERVER_ADMISSION_MIN_FREE_HEAP 16384
+#    endif
+#endif
+
+// estimated peak memory usage of each response type
+#ifndef WEBSERVER_ADMISSION_TEMPLATE_SIZE
+#    define WEBSERVER_ADMISSION_TEMPLATE_SIZE 3072
+#endif
+
+#ifndef WEBSERVER_ADMISSION_FORM_SIZE
+#    define WEBSERVER_ADMISSION_FORM_SIZE 8192
+#endif
+
+#ifndef WEBSERVER_ADMISSION_DIR_LISTING_SIZE
+#    define WEBSERVER_ADMISSION_DIR_LISTING_SIZE 1536
+#endif
+
+#ifndef WEBSERVER_ADMISSION_NETWORK_SCAN_SIZE
+#    define WEBSERVER_ADMISSION_NETWORK_SCAN_SIZE 2048
+#endif
+
+// max. number of requests waiting for memory
+#ifndef WEBSERVER_ADMISSION_QUEUE_SIZE
+#    define WEBSERVER_ADMISSION_QUEUE_SIZE 4
+#endif
+
+// max. time a request is queued in milliseconds
+#ifndef WEBSERVER_ADMISSION_QUEUE_TIMEOUT
+#    define WEBSERVER_ADMISSION_QUEUE_TIMEOUT 3000
+#endif
+
+// value of the Retry-After header in seconds
+#ifndef WEBSERVER_ADMISSION_RETRY_AFTER
+#    define WEBSERVER_ADMISSION_RETRY_AFTER 2
+#endif
+
+// number of buffers in the pool. the buffers are allocated on first use and kept while any response is in flight
+#ifndef WEBSERVER_RESPONSE_BUFFER_COUNT
+#    define WEBSERVER_RESPONSE_BUFFER_COUNT 2
+#endif
+
+// size of each buffer. the default is the TCP send buffer, which is the max. size of a single write
+#ifndef WEBSERVER_RESPONSE_BUFFER_SIZE
+#    define WEBSERVER_RESPONSE_BUFFER_SIZE TCP_SND_BUF
+#endif
+
+class AsyncWebServerRequest;
+
+namespace WebServer {
+
+    class Admission {
+    public:
+        enum class ResponseType : uint8_t {
+            NONE,
+            TEMPLATE,
+            FORM,
+            DIR_LISTING,
+            NETWORK_SCAN,
+            MAX
+        };
+
+        using Callback = std::function<void(AsyncWebServerRequest *request)>;
+
+        static constexpr uint32_t kBudget = WEBSERVER_ADMISSION_BUDGET;
+        static constexpr uint32_t kMinFreeHeap = WEBSERVER_ADMISSION_MIN_FREE_HEAP;
+        static constexpr uint8_t kQueueSize = WEBSERVER_ADMISSION_QUEUE_SIZE;
+        static constexpr uint16_t kQueueTimeout = WEBSERVER_ADMISSION_QUEUE_TIMEOUT;
+        static constexpr uint8_t kRetryAfter = WEBSERVER_ADMISSION_RETRY_AFTER;
+        static constexpr uint16_t kQueueInterval = 100;
+
+        // reserved memory that is released when the object is destroyed
+        class Ticket {
+        public:
+            Ticket() : _size(0) {}
+            Ticket(const Ticket &) = delete;
+            Ticket(Ticket &&ticket) noexcept : _size(std::exchange(ticket._size, 0)) {}
+            ~Ticket() {
+                release();
+            }
+
+            Ticket &operator=(const Ticket &) = delete;
+            Ticket &operator=(Ticket &&ticket) noexcept {
+                release();
+                _size = std::exchange(ticket._size, 0);
+                return *this;
+            }
+
+            void release();
+
+            uint16_t size() const {
+                return _size;
+            }
+
+        private:
+            friend Admission;
+
+            Ticket(uint16_t size) : _size(size) {}
+
+            uint16_t _size;
+        };
+
+        // the ticket of an admitted request is claimed by the first AsyncBaseResponse that is created while the scope
+        // exists. if no response claims it, the memory is released when the scope is destroyed
+        class Scope {
+        public:
+            Scope() {}
+            ~Scope() {
+                _pending.release();
+            }
+
+            // returns true if the response can be created. otherwise the request has been queued and the callback is
+            // invoked again when memory is available, or the request has been answered with 503
+            bool admit(AsyncWebServerRequest *request, ResponseType type, Callback callback);
+        };
+
+        // shared buffer for sending a response
+        class Buffer {
+        public:
+            Buffer(size_t size);
+            ~Buffer();
+
+            Buffer(const Buffer &) = delete;
+            Buffer &operator=(const Buffer &) = delete;
+
+            uint8_t *get() const {
+                return _buffer;
+            }
+
+            // size of pooled buffers. larger buffers are allocated from the heap
+            static constexpr size_t kPoolSize = WEBSERVER_RESPONSE_BUFFER_SIZE;
+
+        private:
+            uint8_t *_buffer;
+            int8_t _index;
+        };
+
+        // keeps the buffers of the pool allocated during the lifetime of a response
+        class PoolLease {
+        public:
+            PoolLease() {
+                _poolLeases++;
+            }
+            ~PoolLease() {
+                if (--_poolLeases == 0) {
+                    _freePool();
+                }
+            }
+
+            PoolLease(const PoolLease &) = delete;
+            PoolLease &operator=(const PoolLease &) = delete;
+        };
+
+    public:
+        // response type of a request to the not found handler
+        static ResponseType getResponseType(AsyncWebServerRequest *request);
+        static uint16_t getEstimate(ResponseType type);
+
+        // called by AsyncBaseResponse
+        static Ticket claim();
+
+        static void dump(Print &output);
+
+    private:
+        struct QueuedRequest {
+            AsyncWebServerRequest *request;
+            Callback callback;
+            ResponseType type;
+            uint32_t time;
+
+            QueuedRequest(AsyncWebServerRequest *_request, Callback &&_callback, ResponseType _type) :
+                request(_request),
+                callback(std::move(_callback)),
+                type(_type),
+                time(millis())
+            {}
+        };
+
+        static bool _hasMemory(uint16_t size);
+        static void _enqueue(AsyncWebServerRequest *request, ResponseType type, Callback &&callback);
+        static void _remove(AsyncWebServerRequest *request);
+        static void _processQueue();
+        static void _sendServiceUnavailable(AsyncWebServerRequest *request);
+        static void _freePool();
+
+        static Ticket _pending;
+        static std::vector<QueuedRequest> _queue;
+        static Event::Timer _timer;
+        static uint32_t _reserved;
+        static uint8_t _active;
+        static bool _dispatching;
+        // buffer pool
+        static std::unique_ptr<uint8_t[]> _pool[WEBSERVER_RESPONSE_BUFFER_COUNT];
+        static uint8_t _poolUsed;
+        // number of responses in flight
+        static uint16_t _poolLeases;
+        // statistics since boot
+        static uint32_t _admitted;
+        static uint32_t _queued;
+        static uint32_t _rejected;
+        static uint16_t _maxQueueDepth;
+        static uint32_t _maxReserved;
+        static uint32_t _poolHits;
+        static uint32_t _poolMisses;
+    };
+
+    inline Admission::Ticket Admission::claim()
+    {
+        return std::move(_pending);
+    }
+
+}
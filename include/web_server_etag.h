@@ -0,0 +1,70 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <EventScheduler.h>
+#include <vector>
+
+// Content hashes for static files
+//
+// The hash is calculated in the main loop after the file has been requested the first time and stored with the
+// modification time of the file mapping in /.pvt/etags. As long as the modification time does not change, conditional
+// requests with a matching ETag are answered with "304 Not Modified" without opening the file. If the cache is full,
+// the least recently used entry is removed
+
+#ifndef WEBSERVER_ETAG_SUPPORT
+#    define WEBSERVER_ETAG_SUPPORT 1
+#endif
+
+// max. number of files with a stored hash
+#ifndef WEBSERVER_ETAG_CACHE_SIZE
+#    define WEBSERVER_ETAG_CACHE_SIZE 64
+#endif
+
+class FileMapping;
+
+namespace WebServer {
+
+    class ETagCache {
+    public:
+        struct Entry {
+            uint32_t path;
+            uint32_t modificationTime;
+            uint32_t hash;
+        };
+
+        static constexpr uint32_t kMagic = 0x47415445; // ETAG
+
+    public:
+        // returns the strong ETag of the file or an empty string if the hash has not been calculated yet
+        static String getETag(const FileMapping &mapping);
+        // check if an If-None-Match header contains the ETag
+        static bool match(const String &ifNoneMatch, const String &etag);
+        // remove all hashes
+        static void clear();
+
+        static void dump(Print &output);
+
+    private:
+        static Entry *_find(uint32_t path);
+        static bool _calcHash(const FileMapping &mapping, uint32_t &hash);
+        static void _update(const FileMapping &mapping, uint32_t path);
+        static void _load();
+        static void _scheduleSave();
+        static void _save();
+
+        // ordered by last use
+        static std::vector<Entry> _entries;
+        // hashes waiting to be calculated in the main loop
+        static std::vector<uint32_t> _pending;
+        static Event::Timer _saveTimer;
+        static bool _loaded;
+        // statistics since boot
+        static uint32_t _hits;
+        static uint32_t _misses;
+    };
+
+}
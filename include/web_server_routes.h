@@ -0,0 +1,136 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <memory>
+#include <vector>
+
+// Route table for the web server
+//
+// The URLs of the internal handlers and the REST API are stored in PROGMEM. When the routes have been added, a seed
+// is searched that maps each method and URL to its own slot of a hash table. A request is dispatched by hashing the
+// method and URL and comparing it to the single route stored in the slot instead of comparing it with each route.
+// Routes that accept any method are looked up with a second probe if no route exists for the method of the request
+//
+// Each route counts hits and keeps a histogram of the time spent in the handler. If no seed is found, the routes are
+// searched linearly
+
+namespace WebServer {
+
+    enum class RouteType : uint8_t {
+        NONE,
+        START_ARDUINO_OTA,
+        STOP_ARDUINO_OTA,
+        IS_ALIVE,
+        WEBUI_HANDLER,
+        ALERTS,
+        SYNC_TIME,
+        EXPORT_SETTINGS,
+        IMPORT_SETTINGS,
+        SCAN_WIFI,
+        LOGOUT,
+        MQTT_PUBLISH_AD,
+        ZEROCONF,
+        MDNS_DISCOVERY,
+        SAVECRASH_JSON,
+        AMBIENT_LIGHT_SENSOR,
+        SPEEDTEST_ZIP,
+        SPEEDTEST_BMP,
+        REST,
+        METRICS,
+        BENCHMARK,
+    };
+
+    class RouteTable {
+    public:
+        // upper limits of the latency histogram in microseconds, the last bucket counts everything above
+        static constexpr uint8_t kHistogramSize = 6;
+        static constexpr uint8_t kMinBits = 3;
+        static constexpr uint8_t kMaxBits = 8;
+        // WebRequestMethod of the request or any method
+        static constexpr uint8_t kAnyMethod = 0;
+
+        struct Route {
+            const __FlashStringHelper *url;
+            RouteType type;
+            // index of the REST handler
+            uint8_t index;
+            uint8_t method;
+            uint32_t hits;
+            uint16_t histogram[kHistogramSize];
+
+            Route(const __FlashStringHelper *aUrl, RouteType aType, uint8_t aIndex, uint8_t aMethod) : url(aUrl), type(aType), index(aIndex), method(aMethod), hits(0), histogram() {}
+        };
+
+        // counts the hit and measures the time spent in the handler of a route
+        class Measure {
+        public:
+            Measure(Route *route) : _route(route), _start(micros()) {
+                if (_route) {
+                    _route->hits++;
+                }
+            }
+            ~Measure() {
+                if (_route) {
+                    RouteTable::addLatency(*_route, micros() - _start);
+                }
+            }
+
+        private:
+            Route *_route;
+            uint32_t _start;
+        };
+
+    public:
+        RouteTable();
+
+        void clear();
+        // the table is rebuilt with the next find(). each method and URL can be added once
+        void add(const __FlashStringHelper *url, RouteType type, uint8_t index = 0, uint8_t method = kAnyMethod);
+        // returns nullptr if the method and URL do not match any route
+        Route *find(uint8_t method, const String &url);
+        Route *find(uint8_t method, const char *url, size_t len);
+
+        void resetStats();
+        void dump(Print &output) const;
+
+        static void addLatency(Route &route, uint32_t micros);
+
+        // compare the lookup time of the hash table with a linear search for a growing number of routes
+        static void benchmark(Print &output, uint16_t iterations);
+
+    private:
+        static uint32_t _hash(uint8_t method, const char *str, size_t len, uint32_t seed);
+        static uint32_t _hash_P(uint8_t method, PGM_P str, uint32_t seed);
+        static bool _isMatch(const Route &route, uint8_t method, const char *url, size_t len);
+        Route *_find(uint8_t method, const char *url, size_t len);
+        bool _build();
+        uint16_t _getSlot(uint32_t hash) const;
+
+        std::vector<Route> _routes;
+        // route index + 1, 0 = empty
+        std::unique_ptr<uint8_t[]> _slots;
+        uint32_t _seed;
+        uint8_t _bits;
+        bool _dirty;
+    };
+
+    inline RouteTable::Route *RouteTable::find(uint8_t method, const String &url)
+    {
+        return find(method, url.c_str(), url.length());
+    }
+
+    inline bool RouteTable::_isMatch(const Route &route, uint8_t method, const char *url, size_t len)
+    {
+        return route.method == method && strlen_P(reinterpret_cast<PGM_P>(route.url)) == len && strcmp_P(url, reinterpret_cast<PGM_P>(route.url)) == 0;
+    }
+
+    inline uint16_t RouteTable::_getSlot(uint32_t hash) const
+    {
+        return (hash * 2654435761U) >> (32 - _bits);
+    }
+
+}
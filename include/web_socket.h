@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <vector>
 #include "web_server.h"
+#include "metrics.h"
 // #include <ESPAsyncWebServer.h>
 #if ESP8266
 #include <interrupts.h>
@@ -37,6 +38,11 @@ namespace WebServer {
 //typedef std::function<WsClient *(WsClient *wsSClient, WsAwsEventType type, AsyncWebSocket *server, AsyncWebSocketClient *client, uint8_t *data, size_t len, void *arg)> WsEventHandlerCallback;
 typedef std::function<WsClient *(AsyncWebSocketClient *client)> WsGetInstance;
 
+#if KFC_METRICS
+// messages that have not been sent to a client since its queue was full
+extern Metrics::Counter wsDroppedMessages;
+#endif
+
 class WsClient {
 public:
     enum WsErrorType {
@@ -49,6 +55,7 @@ public:
         TOUCHPAD_DATA,
         ADC_READINGS,
         LED_MATRIX_DATA,
+        WEBUI_VALUES,
     };
 
     WsClient(AsyncWebSocketClient *client);
@@ -211,12 +218,12 @@ protected:
     // does not validate server or sender
     static void _broadcast(AsyncWebSocket *server, WsClient *sender, AsyncWebSocketMessageBuffer *buffer);
     static void invokeStartOrEndCallback(WsClient *wsClient, bool isStart);
+    static uint16_t getQueueDelay();
+    static AsyncWebSocketMessageBuffer *moveStringToBuffer(AsyncWebSocket *server, String &&str);
 
 private:
-    static uint16_t getQueueDelay();
     // static AsyncWebSocketMessageBuffer *jsonToBuffer(AsyncWebSocket *server, const JsonUnnamedObject &json);
     static AsyncWebSocketMessageBuffer *utf8ToBuffer(AsyncWebSocket *server, const char *str, size_t length);
-    static AsyncWebSocketMessageBuffer *moveStringToBuffer(AsyncWebSocket *server, String &&str);
 
     bool _authenticated;
     AsyncWebSocketClient *_client;
@@ -14,6 +14,8 @@ uint32_t &_FS_end = *(uint32_t *)0x402FEFF0;
 uint32_t &_KFCFW_start = *(uint32_t *)0x405AB000;
 uint32_t &_KFCFW_end = *(uint32_t *)0x405BA000;
 uint32_t &_SAVECRASH_start = *(uint32_t *)0x405bb000;
-uint32_t &_SAVECRASH_end = *(uint32_t *)0x405FA000;
+uint32_t &_SAVECRASH_end = *(uint32_t *)0x405F8000;
+uint32_t &_ENERGY_start = *(uint32_t *)0x405F9000;
+uint32_t &_ENERGY_end = *(uint32_t *)0x405FA000;
 uint32_t &_EEPROM_start = *(uint32_t *)0x405FB000;
 uint32_t &_EEPROM_end = *(uint32_t *)0x405FB000;
@@ -47,6 +47,8 @@ def create_eagle_ld(file, split, layout):
             '_NVS_end': split['nvs'][1] - 4095,
             '_SAVECRASH_start': split['savecrash'][0],
             '_SAVECRASH_end': split['savecrash'][1] - 4095,
+            '_ENERGY_start': split['energy'][0],
+            '_ENERGY_end': split['energy'][1] - 4095,
             '_EEPROM_start': split['eeprom'][0],
             '_EEPROM_end': split['eeprom'][1] - 4095,
             '/* The following symbols are DEPRECATED and will be REMOVED in a future release */': -1,
@@ -79,7 +81,9 @@ if not os.path.isdir(eagle_dir):
 nvs_size = 8 # 4K blocks, 8 blocks take about 16ms to initialize while 16 take 25ms.
 # nvs_size = 1 # set to 1 to disable, init with less than 12KB will fail
 
-savecrash_size = 8
+savecrash_size = 6
+
+energy_size = 2 # energy counter journal, must be 2 or more
 
 sketch_addr = 0x40200000
 empty_addr = 0x402FEFF0
@@ -90,9 +94,10 @@ layout = 'flash=4M fs=1M (256 sectors)'
 split = {
     'sketch': sketch_addr,
     'empty': empty_addr,
-    'fs': eeprom_addr - ((nvs_size + savecrash_size + 256) * 0x1000),
-    'nvs': eeprom_addr - ((nvs_size + savecrash_size) * 0x1000),
-    'savecrash': eeprom_addr - (savecrash_size * 0x1000),
+    'fs': eeprom_addr - ((nvs_size + savecrash_size + energy_size + 256) * 0x1000),
+    'nvs': eeprom_addr - ((nvs_size + savecrash_size + energy_size) * 0x1000),
+    'savecrash': eeprom_addr - ((savecrash_size + energy_size) * 0x1000),
+    'energy': eeprom_addr - (energy_size * 0x1000),
     'eeprom': eeprom_addr,
     'rfcal': eeprom_addr + 0x1000,
     'wifi': eeprom_addr + 0x2000,
@@ -104,9 +109,10 @@ layout = 'flash=4M fs=2M (480 sectors to keep "empty" bigger as the sketch for O
 split = {
     'sketch': sketch_addr,
     'empty': empty_addr,
-    'fs': eeprom_addr - ((nvs_size + savecrash_size + 480) * 0x1000),
-    'nvs': eeprom_addr - ((nvs_size + savecrash_size) * 0x1000),
-    'savecrash': eeprom_addr - (savecrash_size * 0x1000),
+    'fs': eeprom_addr - ((nvs_size + savecrash_size + energy_size + 480) * 0x1000),
+    'nvs': eeprom_addr - ((nvs_size + savecrash_size + energy_size) * 0x1000),
+    'savecrash': eeprom_addr - ((savecrash_size + energy_size) * 0x1000),
+    'energy': eeprom_addr - (energy_size * 0x1000),
     'eeprom': eeprom_addr,
     'rfcal': eeprom_addr + 0x1000,
     'wifi': eeprom_addr + 0x2000,
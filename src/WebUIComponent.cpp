@@ -5,6 +5,7 @@
 #include "WebUIComponent.h"
 #include "plugins_menu.h"
 #include "plugins.h"
+#include <algorithm>
 
 #if DEBUG_WEBUI
 #    include <debug_helper_enable.h>
@@ -93,6 +94,9 @@ namespace WebUINS {
 
     void Root::addValues()
     {
+        #if WEBUI_BINARY_VALUES
+            BinaryTable::Capture capture;
+        #endif
         auto values = WebUINS::Events(WebUINS::Events::Values());
 
 #ifndef _MSC_VER
@@ -104,7 +108,117 @@ namespace WebUINS {
         }
 #endif
 
+        #if WEBUI_BINARY_VALUES
+            BinaryTable::update(std::move(values.getTable()));
+        #endif
         _json.append(values);
+        #if WEBUI_BINARY_VALUES
+            _json.append(NamedUint32(F("bv"), BinaryTable::getVersion()));
+        #endif
     }
 
+    #if WEBUI_BINARY_VALUES
+
+        BinaryTable::EntryVector BinaryTable::_table;
+        uint8_t BinaryTable::_version = 0;
+        BinaryTable::Mode BinaryTable::_mode = BinaryTable::Mode::AUTO;
+        uint8_t BinaryTable::_clients = 0;
+        uint8_t BinaryTable::_capture = 0;
+
+        const std::vector<uint8_t> Events::_empty;
+
+        uint32_t BinaryTable::hash(const __FlashStringHelper *id, uint8_t &length)
+        {
+            // FNV-1a
+            uint32_t hash = 0x811c9dc5;
+            auto ptr = reinterpret_cast<PGM_P>(id);
+            uint8_t ch;
+            length = 0;
+            while ((ch = pgm_read_byte(ptr++)) != 0) {
+                hash = (hash ^ ch) * 0x01000193;
+                if (length < 0xff) {
+                    length++;
+                }
+            }
+            return hash;
+        }
+
+        uint32_t BinaryTable::hash(const String &id, uint8_t &length)
+        {
+            uint32_t hash = 0x811c9dc5;
+            for(auto ch: id) {
+                hash = (hash ^ static_cast<uint8_t>(ch)) * 0x01000193;
+            }
+            length = std::min<size_t>(id.length(), 0xff);
+            return hash;
+        }
+
+        uint8_t BinaryTable::find(uint32_t hash)
+        {
+            auto iterator = std::find_if(_table.begin(), _table.end(), [hash](const Entry &entry) {
+                return entry.hash == hash;
+            });
+            if (iterator == _table.end()) {
+                return kInvalidIndex;
+            }
+            return std::distance(_table.begin(), iterator);
+        }
+
+        void BinaryTable::update(EntryVector &&table)
+        {
+            if (table.size() > kMaxIndex + 1U) {
+                table.resize(kMaxIndex + 1U);
+            }
+            if (table.size() == _table.size() && std::equal(table.begin(), table.end(), _table.begin(), [](const Entry &a, const Entry &b) {
+                return a.hash == b.hash && a.length == b.length;
+            })) {
+                return;
+            }
+            _table = std::move(table);
+            _table.shrink_to_fit();
+            _version++;
+            __LDBG_printf("binary table version=%u size=%u", _version, _table.size());
+        }
+
+        uint8_t BinaryTable::getPrecision(const __FlashStringHelper *format)
+        {
+            // "%.2f" = 2, "%05.3f" = 3, "%f" = 6
+            auto ptr = reinterpret_cast<PGM_P>(format);
+            char ch;
+            while ((ch = pgm_read_byte(ptr++)) != 0) {
+                if (ch == '.') {
+                    uint8_t precision = 0;
+                    while (isdigit(ch = pgm_read_byte(ptr++))) {
+                        precision = (precision * 10) + (ch - '0');
+                    }
+                    return precision;
+                }
+            }
+            return 6;
+        }
+
+        void Events::_encode(const WebUINS::Values &value)
+        {
+            if (_capture) {
+                _table.emplace_back(value.getHash(), value.getIdLength());
+            }
+            if (!_binaryValid || !value.hasBinary()) {
+                _binaryValid = false;
+                return;
+            }
+            auto index = BinaryTable::find(value.getHash());
+            if (index == BinaryTable::kInvalidIndex || (!_binary.empty() && _binary[0] == 0xff)) {
+                _binaryValid = false;
+                return;
+            }
+            if (_binary.empty()) {
+                _binary.push_back(0);
+            }
+            _binary[0]++;
+            _binary.push_back(index);
+            value.encodeTo(_binary);
+        }
+
+    #endif
+
 }
@@ -23,6 +23,31 @@ PROGMEM_STRING_DEF(webui_socket_uri, "/webui-ws");
 
 WsClientAsyncWebSocket *WebUISocket::_server;
 WebUISocket *WebUISocket::_sender;
+#if WEBUI_BINARY_VALUES
+    WebUISocket::Stats WebUISocket::_stats = {};
+#endif
+
+#if KFC_METRICS
+
+// the library does not expose the length of the queue, count the clients that cannot receive any messages
+static int32_t getBlockedClients()
+{
+    auto server = WebUISocket::getServerSocket();
+    if (!server) {
+        return 0;
+    }
+    int32_t count = 0;
+    WsClient::foreach(server, nullptr, [&count](AsyncWebSocketClient *client) {
+        if (!client->canSend()) {
+            count++;
+        }
+    });
+    return count;
+}
+
+METRICS_GAUGE_CALLBACK_DEF(wsBlockedClients, "kfc_websocket_queue_full_clients", "WebUI clients with a full message queue", getBlockedClients);
+
+#endif
 
 void webui_socket_event_handler(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)
 {
@@ -75,6 +100,21 @@ void WebUISocket::onText(uint8_t *data, size_t len)
         if (command.equalsIgnoreCase(F("+get_values"))) {
             sendValues(client);
         }
+        #if WEBUI_BINARY_VALUES
+            else if (command.equalsIgnoreCase(F("+binary"))) {
+                // the client can decode WsClient::BinaryPacketType::WEBUI_VALUES
+                bool binary = args[0].toInt();
+                if (binary != _binary) {
+                    _binary = binary;
+                    if (binary) {
+                        WebUINS::BinaryTable::attachClient();
+                    }
+                    else {
+                        WebUINS::BinaryTable::detachClient();
+                    }
+                }
+            }
+        #endif
         else if (command.equalsIgnoreCase(F("+set_state"))) {
             bool state = args[1].toInt() || (strcasecmp_P(args[1].c_str(), SPGM(true)) == 0);
             for(auto plugin: PluginComponents::Register::getPlugins()) {
@@ -130,6 +170,217 @@ void WebUISocket::sendValue(AsyncWebSocketClient *client, const __FlashStringHel
     send(client, WebUINS::UpdateEvents(WebUINS::Events(WebUINS::Values(id, value, state))));
 }
 
+void WebUISocket::broadcast(WebUISocket *sender, const WebUINS::UpdateEvents &events)
+{
+    #if WEBUI_BINARY_VALUES
+        AsyncWebSocket *server = getServerSocket();
+        if (!server) {
+            if (!sender || !sender->getClient()) {
+                return;
+            }
+            server = sender->getClient()->server();
+        }
+        if (!WsClient::hasAuthenticatedClients(server) || !server->availableForWriteAll()) {
+            return;
+        }
+        auto &data = events.getBinary();
+        size_t binaryLength = data.size() + 3;
+        size_t jsonLength = 0;
+        AsyncWebSocketMessageBuffer *jsonBuffer = nullptr;
+        AsyncWebSocketMessageBuffer *binaryBuffer = nullptr;
+        auto qDelay = getQueueDelay();
+        WsClient::foreach(server, sender, [&](AsyncWebSocketClient *client) {
+            if (!client->canSend()) {
+                #if KFC_METRICS
+                    wsDroppedMessages.add();
+                #endif
+                return;
+            }
+            auto socket = reinterpret_cast<WebUISocket *>(client->_tempObject);
+            if (socket->_binary && !data.empty()) {
+                if (!binaryBuffer) {
+                    // header: uint16_t type, uint8_t table version
+                    if ((binaryBuffer = server->makeBuffer(binaryLength)) == nullptr) {
+                        return;
+                    }
+                    auto ptr = binaryBuffer->get();
+                    uint16_t type = static_cast<uint16_t>(WsClient::BinaryPacketType::WEBUI_VALUES);
+                    memcpy(ptr, &type, sizeof(type));
+                    ptr[2] = WebUINS::BinaryTable::getVersion();
+                    memcpy(ptr + 3, data.data(), data.size());
+                    binaryBuffer->lock();
+                }
+                client->binary(binaryBuffer);
+                _stats.binaryFrames++;
+                _stats.binaryBytes += binaryLength;
+            }
+            else {
+                if (!jsonBuffer) {
+                    jsonLength = events.length();
+                    if ((jsonBuffer = moveStringToBuffer(server, String(events.toString()))) == nullptr) {
+                        return;
+                    }
+                    jsonBuffer->lock();
+                }
+                client->text(jsonBuffer);
+                _stats.jsonFrames++;
+                _stats.jsonBytes += jsonLength;
+            }
+            #if ESP32
+                esp_task_wdt_reset();
+            #elif ESP8266
+                if (can_yield()) {
+                    delay(qDelay); // let the device work on its tcp buffers
+                }
+            #endif
+        });
+        if (jsonBuffer) {
+            jsonBuffer->unlock();
+        }
+        if (binaryBuffer) {
+            binaryBuffer->unlock();
+        }
+        server->_cleanBuffers();
+    #else
+        WsClient::broadcast(getServerSocket(), sender, events);
+    #endif
+}
+
+#if WEBUI_BINARY_VALUES
+
+void WebUISocket::dumpStats(Print &output)
+{
+    output.printf_P(PSTR("WebUI updates %u JSON frame(s) %u byte, %u binary frame(s) %u byte"), _stats.jsonFrames, _stats.jsonBytes, _stats.binaryFrames, _stats.binaryBytes);
+    if (_stats.jsonFrames && _stats.binaryFrames) {
+        output.printf_P(PSTR(", avg. %u/%u byte"), _stats.jsonBytes / _stats.jsonFrames, _stats.binaryBytes / _stats.binaryFrames);
+    }
+}
+
+void WebUISocket::_decodeValues(WebUINS::Events &events, const std::vector<uint8_t> &data, const std::vector<String> &ids)
+{
+    using WebUINS::BinaryTable;
+    using WebUINS::Values;
+
+    auto ptr = data.data();
+    auto count = *ptr++;
+    while(count--) {
+        auto &id = ids[*ptr++];
+        auto flags = *ptr++;
+        int8_t state = (flags & BinaryTable::kHasState) ? ((flags & BinaryTable::kState) ? Values::kStateTrue : Values::kStateFalse) : Values::kStateNone;
+        uint8_t precision = flags >> BinaryTable::kPrecisionShift;
+        switch(static_cast<BinaryTable::ValueType>(flags & BinaryTable::kTypeMask)) {
+            case BinaryTable::ValueType::BOOL:
+                events.append(Values(id, *ptr++ != 0, state));
+                break;
+            case BinaryTable::ValueType::INT32: {
+                    int32_t value;
+                    memcpy(&value, ptr, sizeof(value));
+                    ptr += sizeof(value);
+                    events.append(Values(id, value, state));
+                }
+                break;
+            case BinaryTable::ValueType::UINT32: {
+                    uint32_t value;
+                    memcpy(&value, ptr, sizeof(value));
+                    ptr += sizeof(value);
+                    events.append(Values(id, value, state));
+                }
+                break;
+            case BinaryTable::ValueType::FLOAT: {
+                    float value;
+                    memcpy(&value, ptr, sizeof(value));
+                    ptr += sizeof(value);
+                    events.append(Values(id, WebUINS::TrimmedFloat(value, precision), state));
+                }
+                break;
+            case BinaryTable::ValueType::DOUBLE: {
+                    double value;
+                    memcpy(&value, ptr, sizeof(value));
+                    ptr += sizeof(value);
+                    events.append(Values(id, WebUINS::TrimmedDouble(value, precision), state));
+                }
+                break;
+            case BinaryTable::ValueType::STRING: {
+                    auto length = *ptr++;
+                    String value;
+                    value.concat(reinterpret_cast<const char *>(ptr), length);
+                    ptr += length;
+                    events.append(Values(id, value, state));
+                }
+                break;
+            default:
+                events.append(Values(id, WebUINS::TrimmedFloat(NAN, precision), state));
+                break;
+        }
+    }
+}
+
+void WebUISocket::benchmark(Print &output, uint16_t iterations)
+{
+    using WebUINS::BinaryTable;
+
+    // current values of all plugins
+    BinaryTable::setMode(BinaryTable::Mode::ON);
+    WebUINS::Events events;
+    for(const auto plugin: PluginComponents::Register::getPlugins()) {
+        if (plugin->hasWebUI()) {
+            plugin->getValues(events);
+        }
+    }
+    auto &data = events.getBinary();
+    if (data.size() <= 1) {
+        BinaryTable::setMode(BinaryTable::Mode::AUTO);
+        output.print(F("No values or the values cannot be encoded. Open the WebUI to create the ID table\n"));
+        return;
+    }
+
+    // the values are decoded and encoded again with placeholder IDs of the same length
+    std::vector<String> ids;
+    BinaryTable::EntryVector table;
+    for(const auto &entry: BinaryTable::getTable()) {
+        String id(ids.size());
+        while(id.length() < entry.length) {
+            id += '_';
+        }
+        uint8_t length;
+        table.emplace_back(BinaryTable::hash(id, length), length);
+        ids.emplace_back(std::move(id));
+    }
+    BinaryTable::swap(table);
+
+    size_t jsonLength;
+    size_t binaryLength;
+    {
+        WebUINS::Events tmp;
+        _decodeValues(tmp, data, ids);
+        WebUINS::UpdateEvents update(tmp);
+        jsonLength = update.length();
+        binaryLength = update.getBinary().size() + 3;
+    }
+
+    uint32_t time[2];
+    for(uint8_t binary = 0; binary < 2; binary++) {
+        BinaryTable::setMode(binary ? BinaryTable::Mode::ON : BinaryTable::Mode::OFF);
+        auto start = micros();
+        for(uint16_t i = 0; i < iterations; i++) {
+            WebUINS::Events tmp;
+            _decodeValues(tmp, data, ids);
+            WebUINS::UpdateEvents update(tmp);
+        }
+        time[binary] = micros() - start;
+    }
+    BinaryTable::setMode(BinaryTable::Mode::AUTO);
+    BinaryTable::swap(table);
+
+    output.printf_P(PSTR("%u values, %u iterations\n"), data[0], iterations);
+    output.printf_P(PSTR("JSON: %u byte, %.1fus per update\n"), jsonLength, time[0] / static_cast<float>(iterations));
+    output.printf_P(PSTR("Binary: %u byte (%u%%), %.1fus per update in addition to JSON\n"), binaryLength, (binaryLength * 100) / jsonLength,
+        (static_cast<int32_t>(time[1] - time[0])) / static_cast<float>(iterations)
+    );
+}
+
+#endif
+
 WebUINS::Root WebUISocket::createWebUIJSON()
 {
     WebUINS::Root webUI;
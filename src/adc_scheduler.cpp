@@ -0,0 +1,149 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <ReadADC.h>
+#include <algorithm>
+#include "adc_scheduler.h"
+
+#if DEBUG_ADC_SCHEDULER
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+// ------------------------------------------------------------------------
+// ADCScheduler::Consumer
+// ------------------------------------------------------------------------
+
+ADCScheduler::Consumer::Consumer(const __FlashStringHelper *name, uint16_t intervalMillis, uint8_t window, PriorityType priority) :
+    _name(name),
+    _buffer(std::max<uint8_t>(1, window), 0),
+    _sum(0),
+    _due(millis()),
+    _interval(std::max<uint16_t>(1, intervalMillis)),
+    _pos(0),
+    _count(0),
+    _priority(priority),
+    _samples(0),
+    _missed(0),
+    _jitterSum(0),
+    _jitterMax(0)
+{
+}
+
+void ADCScheduler::Consumer::_push(uint16_t value)
+{
+    if (_count == _buffer.size()) {
+        _sum -= _buffer[_pos];
+    }
+    else {
+        _count++;
+    }
+    _buffer[_pos] = value;
+    _sum += value;
+    _pos = (_pos + 1) % _buffer.size();
+}
+
+void ADCScheduler::Consumer::dump(Print &output) const
+{
+    output.printf_P(PSTR("%s: interval=%ums window=%u/%u priority=%u value=%u avg=%u samples=%u missed=%u jitter=%.2f/%ums\n"),
+        _name, _interval, _count, _buffer.size(), static_cast<uint8_t>(_priority), getValue(), getAverage(),
+        _samples, _missed, _samples ? (_jitterSum / static_cast<float>(_samples)) : 0.0f, _jitterMax
+    );
+}
+
+// ------------------------------------------------------------------------
+// ADCScheduler
+// ------------------------------------------------------------------------
+
+ADCScheduler::ADCScheduler() : _interval(0), _locked(0), _reads(0)
+{
+}
+
+ADCScheduler &ADCScheduler::getInstance()
+{
+    static ADCScheduler scheduler;
+    return scheduler;
+}
+
+ADCScheduler::Consumer *ADCScheduler::add(const __FlashStringHelper *name, uint16_t intervalMillis, uint8_t window, PriorityType priority)
+{
+    auto consumer = new Consumer(name, intervalMillis, window, priority);
+    // sorted by priority
+    auto iterator = std::find_if(_consumers.begin(), _consumers.end(), [priority](const ConsumerPtr &item) {
+        return item->_priority < priority;
+    });
+    _consumers.emplace(iterator, consumer);
+    __LDBG_printf("name=%s interval=%u window=%u priority=%u", name, intervalMillis, window, priority);
+    _updateTimer();
+    return consumer;
+}
+
+void ADCScheduler::remove(Consumer *consumer)
+{
+    _consumers.erase(std::remove_if(_consumers.begin(), _consumers.end(), [consumer](const ConsumerPtr &item) {
+        return item.get() == consumer;
+    }), _consumers.end());
+    _updateTimer();
+}
+
+void ADCScheduler::dump(Print &output) const
+{
+    output.printf_P(PSTR("ADC scheduler consumers=%u interval=%ums reads=%u locked=%u\n"), _consumers.size(), _interval, _reads, _locked);
+    for(const auto &consumer: _consumers) {
+        consumer->dump(output);
+    }
+}
+
+void ADCScheduler::_updateTimer()
+{
+    if (_consumers.empty()) {
+        _interval = 0;
+        _Timer(_timer).remove();
+        return;
+    }
+    // the timer runs at the shortest interval of all consumers
+    auto interval = (*std::min_element(_consumers.begin(), _consumers.end(), [](const ConsumerPtr &a, const ConsumerPtr &b) {
+        return a->_interval < b->_interval;
+    }))->_interval;
+    if (interval != _interval || !_timer) {
+        _interval = interval;
+        _Timer(_timer).add(Event::milliseconds(_interval), true, [this](Event::CallbackTimerPtr) {
+            _timerCallback();
+        });
+    }
+}
+
+void ADCScheduler::_timerCallback()
+{
+    auto now = millis();
+    bool hasValue = false;
+    uint16_t value = 0;
+    for(auto &consumer: _consumers) {
+        int32_t late = now - consumer->_due;
+        if (late < 0) {
+            continue;
+        }
+        uint32_t periods = late / consumer->_interval;
+        // keep the phase of the consumer
+        consumer->_due += (periods + 1) * consumer->_interval;
+        if (_locked) {
+            consumer->_missed += periods + 1;
+            continue;
+        }
+        // a single reading for all consumers that are due
+        if (!hasValue) {
+            value = ADCManager::getInstance().readValue();
+            hasValue = true;
+            _reads++;
+        }
+        consumer->_push(value);
+        consumer->_samples++;
+        consumer->_missed += periods;
+        uint16_t jitter = late % consumer->_interval;
+        consumer->_jitterSum += jitter;
+        consumer->_jitterMax = std::max(consumer->_jitterMax, jitter);
+    }
+}
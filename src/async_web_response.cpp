@@ -18,7 +18,8 @@
 #    define DEBUG_ASYNC_WEB_RESPONSE_DIR_RESPONSE 0
 #endif
 
-AsyncBaseResponse::AsyncBaseResponse(bool chunked)
+AsyncBaseResponse::AsyncBaseResponse(bool chunked) :
+    _ticket(WebServer::Admission::claim())
 {
     if (chunked) {
         // change those 2 values for chunked
@@ -109,8 +110,12 @@ size_t AsyncBaseResponse::_ack(AsyncWebServerRequest* request, size_t len, uint3
             outLen = std::min(space, (_contentLength - _sentLength)); // max. data we have to send
         }
 
-        auto bufPtr = std::unique_ptr<uint8_t[]>(new uint8_t[outLen + headLen]);
-        auto buf = bufPtr.get();
+        // use a buffer from the pool if the headers fit
+        if (outLen + headLen > WebServer::Admission::Buffer::kPoolSize && headLen + 64 < WebServer::Admission::Buffer::kPoolSize) {
+            outLen = WebServer::Admission::Buffer::kPoolSize - headLen;
+        }
+        WebServer::Admission::Buffer buffer(outLen + headLen);
+        auto buf = buffer.get();
         if (!buf) {
             __DBG_printf_E("memory allocation failed");
             return 0;
@@ -24,11 +24,15 @@
 #include "save_crash.h"
 #include "web_server.h"
 #include "web_socket.h"
+#include "WebUISocket.h"
+#include "failure_counter.h"
+#include "metrics.h"
 #include "async_web_response.h"
 #include "serial_handler.h"
 #include "blink_led_timer.h"
 #include "plugins.h"
 #include "PinMonitor.h"
+#include "adc_scheduler.h"
 #include "../src/plugins/plugins.h"
 #include <stl_ext/memory.h>
 #include "HeapSelector.h"
@@ -279,7 +283,7 @@ PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(RST, "RST", "[<s>]", "Soft reset. 's' enab
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(CMDS, "CMDS", "Send a list of available AT commands");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(LOAD, "LOAD", "Discard changes and load settings from EEPROM");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(IMPORT, "IMPORT", "<filename|set_dirty>[,<handle>[,<handle>,...]]", "Import settings from JSON file");
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(STORE, "STORE", "Store current settings in EEPROM");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(STORE, "STORE", "[<stats>]", "Store current settings in EEPROM or display statistics");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(FACTORY, "FACTORY", "Restore factory settings (but do not store in EEPROM)");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(FSR, "FSR", "FACTORY, STORE, RST in sequence");
 #if defined(HAVE_NVS_FLASH)
@@ -354,7 +358,14 @@ PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(HEAP, "HEAP", "[interval in seconds|0=disa
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(RSSI, "RSSI", "[interval in seconds|0=disable]", "Display WiFi RSSI");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(GPIO, "GPIO", "[interval in seconds|0=disable]", "Display GPIO states");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(PWM, "PWM", "<pin>,<input|input_pullup|waveform|level=0-" __STRINGIFY(PWMRANGE) ">[,<frequency=100-40000Hz>[,<duration/ms>]]", "PWM output on PIN, min./max. level set it to LOW/HIGH");
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(ADC, "ADC", "<off|display interval=1s>[,<period=1s>,<multiplier=1.0>,<unit=mV>,<read delay=5000us>]", "Read the ADC and display values");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(ADC, "ADC", "<off|scheduler|display interval=1s>[,<period=1s>,<multiplier=1.0>,<unit=mV>,<read delay=5000us>]", "Read the ADC and display values or the statistics of the ADC scheduler");
+#if SECURITY_LOGIN_ATTEMPTS
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(LOGINF, "LOGINF", "<status|clear|bench>[,<failures=2000>,<addresses=64>]", "Display or clear the login failures or replay failed logins from random addresses");
+#endif
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(HTTPR, "HTTPR", "<stats|reset|bench>[,<iterations=1000>]", "Display or reset the statistics of the web server routes or compare hashed and linear route lookup");
+#if WEBUI_BINARY_VALUES
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(WEBUI, "WEBUI", "<stats|bench>[,<iterations=100>]", "Display statistics of the WebUI value updates or compare JSON and binary encoding");
+#endif
 #if ESP32
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(CPU, "CPU", "Toggle displaying CPU usage");
 #endif
@@ -366,7 +377,7 @@ PROGMEM_AT_MODE_HELP_COMMAND_DEF(CPU, "CPU", "<80|160>", "Set CPU speed", "Displ
 #if DEBUG
 
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(PSTORE, "PSTORE", "[<clear|remove|add>[,<key>[,<value>]]]", "Display/modify persistent storage");
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(METRICS, "METRICS", "Display system metrics");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(METRICS, "METRICS", "[<prom>]", "Display system metrics or the metrics registry in the Prometheus text format");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(DUMP, "DUMP", "[<dirty|config.name>]", "Display settings");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PNPN(DUMPT, "DUMPT", "Dump timers");
 #if DEBUG_CONFIGURATION_GETHANDLE
@@ -440,6 +451,13 @@ void at_mode_help_commands()
     at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(GPIO), name);
     at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(PWM), name);
     at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(ADC), name);
+#if SECURITY_LOGIN_ATTEMPTS
+    at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(LOGINF), name);
+#endif
+    at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(HTTPR), name);
+#if WEBUI_BINARY_VALUES
+    at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(WEBUI), name);
+#endif
 #if ESP32
     at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(CPU), name);
 #endif
@@ -934,8 +952,11 @@ static void at_mode_adc_delete_object();
 class AtModeADC {
 public:
     AtModeADC() : _adcIntegralMultiplier(0), _adc(ADCManager::getInstance()) {
+        // the readings are not shared with other consumers
+        ADCScheduler::getInstance().lock();
     }
     virtual ~AtModeADC() {
+        ADCScheduler::getInstance().unlock();
         _Timer(_displayTimer).remove();
         if (_adcIntegralMultiplier) {
             LoopFunctions::remove(at_mode_adc_loop);
@@ -1709,7 +1730,13 @@ void at_mode_serial_handle_event(String &commandString)
 
         }
         else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(METRICS))) {
-            #if 1
+            #if KFC_METRICS
+                if (args.equalsIgnoreCase(0, F("prom"))) {
+                    Metrics::print(args.getStream());
+                }
+                else
+            #endif
+            {
                 args.print(F("Device name: %s"), System::Device::getName());
                 #if ESP32
                     args.print(F("Framework Arduino ESP32 " ARDUINO_ESP32_RELEASE));
@@ -1800,7 +1827,7 @@ void at_mode_serial_handle_event(String &commandString)
                     args.print(tmp);
                 #endif
 
-            #endif
+            }
         }
         else
     #endif
@@ -1829,8 +1856,13 @@ void at_mode_serial_handle_event(String &commandString)
         args.ok();
     }
     else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(STORE))) {
-        config.write();
-        args.ok();
+        if (args.equalsIgnoreCase(0, F("stats"))) {
+            config.printWriteStats(output);
+        }
+        else {
+            config.write();
+            args.ok();
+        }
     }
     else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(IMPORT))) {
         if (args.requireArgs(1)) {
@@ -2668,6 +2700,9 @@ void at_mode_serial_handle_event(String &commandString)
                 }
 
             }
+            else if (args.equalsIgnoreCase(0, F("scheduler"))) {
+                ADCScheduler::getInstance().dump(args.getStream());
+            }
             else if (args.isAnyMatchIgnoreCase(0, F("0|off|stop"))) {
                 args.print(F("ADC display off"));
                 at_mode_adc_delete_object();
@@ -2701,6 +2736,58 @@ void at_mode_serial_handle_event(String &commandString)
             }
         }
     }
+    #if SECURITY_LOGIN_ATTEMPTS
+        else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(LOGINF))) {
+            if (args.equalsIgnoreCase(0, F("bench"))) {
+                auto failures = args.toIntMinMax<uint16_t>(1, 1, 50000, 2000);
+                auto addresses = args.toIntMinMax<uint16_t>(2, 1, 4096, 64);
+                FailureCounterContainer::benchmark(args.getStream(), failures, addresses);
+            }
+            else {
+                auto container = WebServer::Plugin::getLoginFailureContainer();
+                if (!container) {
+                    args.print(F("Login failures are not logged"));
+                }
+                else {
+                    if (args.equalsIgnoreCase(0, F("clear"))) {
+                        container->clear();
+                    }
+                    container->dump(args.getStream());
+                    args.getStream().println();
+                }
+            }
+        }
+    #endif
+    else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(HTTPR))) {
+        if (args.equalsIgnoreCase(0, F("bench"))) {
+            auto iterations = args.toIntMinMax<uint16_t>(1, 1, 10000, 1000);
+            WebServer::RouteTable::benchmark(args.getStream(), iterations);
+        }
+        else {
+            auto routes = WebServer::Plugin::getRouteTable();
+            if (!routes) {
+                args.print(F("Web server not running"));
+            }
+            else {
+                if (args.equalsIgnoreCase(0, F("reset"))) {
+                    routes->resetStats();
+                }
+                routes->dump(args.getStream());
+            }
+        }
+    }
+    #if WEBUI_BINARY_VALUES
+        else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(WEBUI))) {
+            if (args.equalsIgnoreCase(0, F("bench"))) {
+                auto iterations = args.toIntMinMax<uint16_t>(1, 1, 500, 100);
+                WebUISocket::benchmark(args.getStream(), iterations);
+            }
+            else {
+                WebUISocket::dumpStats(args.getStream());
+                args.getStream().println();
+            }
+        }
+    #endif
     #if ESP32
         else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(CPU))) {
             if (perfmon_start(&const_cast<Stream &>(args.getStream())) == ESP_OK) {
@@ -9,6 +9,7 @@
 #include "esp_freertos_hooks.h"
 #include "esp_log.h"
 #include "sdkconfig.h"
+#include "metrics.h"
 
 static TaskHandle_t perfmonTask = nullptr;
 static constexpr int kDisplayCpuIntervalMillis = 5000;
@@ -130,6 +131,9 @@ void perfmon_task(void *args)
         // cpuPercent = ((99.9 / 90.0) * idleCnt/1000.0) / 10.0;
         float cpuPercent1 = adjust * (float)idleCnt / 10.0;
         output.printf("Core 0 at %.0f%%, core 1 at %.0f%%, total %.0f%%\n", 100 - cpuPercent0, 100 - cpuPercent1, 100 - ((cpuPercent0 + cpuPercent1) / 2));
+        #if KFC_METRICS
+            Metrics::cpuLoad.set(100 - ((cpuPercent0 + cpuPercent1) / 2));
+        #endif
 
         vTaskDelay(kDisplayCpuIntervalMillis / portTICK_RATE_MS); // measure every 10 seconds
     }
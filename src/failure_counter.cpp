@@ -9,6 +9,7 @@
 #include <Arduino_compat.h>
 #include <PrintString.h>
 #include <kfc_fw_config.h>
+#include <algorithm>
 #include "failure_counter.h"
 
 #    if DEBUG_LOGIN_FAILURES
@@ -19,198 +20,257 @@
 
 using KFCConfigurationClasses::System;
 
-FailureCounter::FailureCounter(FailureCounterContainer &container) :
-    _counter(FailureCounter::INVALID_DATA),
-    _container(container)
-{
-}
-
-FailureCounter::FailureCounter(FailureCounterContainer &container, const FailureCounterFileRecord_t &record) :
-    _addr(record.addr),
-    _counter(record.counter),
-    _firstFailure(record.firstFailure),
-    _lastFailure(record.lastFailure),
-    _container(container)
+String FailureCounter::getFirstFailure() const
 {
+    PrintString tmp;
+    tmp.strftime_P(PSTR("%Y-%m-%dT%H:%M:%S %Z"), _firstFailure);
+    return tmp;
 }
 
-FailureCounter::FailureCounter(FailureCounterContainer &container, const IPAddress &addr) :
-    _addr(addr),
-    _counter(0),
-    _firstFailure(time(nullptr)),
-    _lastFailure(_firstFailure),
-    _container(container)
+FailureCounterContainer::FailureCounterContainer(bool persistent) :
+    _persistent(persistent),
+    _dirty(false),
+    _used(0),
+    _evicted(0),
+    _blocked(0),
+    _writes(0)
 {
-    addFailure();
+    auto cfg = System::WebServer::getConfig();
+    _rewriteInterval = cfg.getLoginRewriteInterval();
+    _storageTimeframe = cfg.getLoginStorageTimeframe();
+    _checkTimeframe = cfg.login_timeframe;
+    _attempts = std::max<uint8_t>(1, cfg.login_attempts);
 }
 
-bool FailureCounter::operator !() const
+FailureCounterContainer::~FailureCounterContainer()
 {
-    return _counter == FailureCounter::INVALID_DATA;
+    _Timer(_flushTimer).remove();
+    if (_dirty) {
+        flush();
+    }
 }
 
-FailureCounter::operator bool() const
+void FailureCounterContainer::clear()
 {
-    return _counter != FailureCounter::INVALID_DATA;
+    std::fill(std::begin(_table), std::end(_table), FailureCounter());
+    _used = 0;
+    _dirty = true;
+    _scheduleFlush();
 }
 
-uint32_t FailureCounter::getTimeframe() const
+const FailureCounter &FailureCounterContainer::addFailure(const IPAddress &addr)
 {
-    return _lastFailure - _firstFailure;
+    uint32_t now = millis();
+    auto failure = _find(addr);
+    if (failure) {
+        _refill(*failure, now);
+    }
+    else {
+        failure = &_insert(addr);
+    }
+    if (failure->_counter < FailureCounter::kMaxCounter) {
+        failure->_counter++;
+    }
+    // consume one token
+    failure->_tokens -= std::min(failure->_tokens, FailureCounter::kTokenScale);
+    failure->_lastFailure = time(nullptr);
+    failure->_lastMillis = now;
+    __LDBG_printf("Failed attempt from %s #%u tokens=%u", addr.toString().c_str(), failure->_counter, failure->_tokens);
+    _dirty = true;
+    _scheduleFlush();
+    return *failure;
 }
 
-bool FailureCounter::isBlocked(const IPAddress &addr) const
+bool FailureCounterContainer::isAddressBlocked(const IPAddress &addr)
 {
-    if (_counter > SECURITY_LOGIN_ATTEMPTS && getTimeframe() <= _container._checkTimeframe) {
-        __LDBG_printf("Failed attempt from %s #%u, timeframe %u, access blocked", _addr.toString().c_str(), _counter, getTimeframe());
+    auto failure = _find(addr);
+    if (!failure) {
+        return false;
+    }
+    _refill(*failure, millis());
+    if (failure->_tokens < FailureCounter::kTokenScale) {
+        __LDBG_printf("Failed attempt from %s #%u, timeframe %u, access blocked", addr.toString().c_str(), failure->_counter, failure->getTimeframe());
+        _blocked++;
         return true;
     }
     return false;
 }
 
-bool FailureCounter::isMatch(const IPAddress &addr) const
-{
-    return addr == _addr;
-}
-
-uint32_t FailureCounter::getCounter() const {
-    return _counter;
-}
-
-const IPAddress &FailureCounter::getIPAddress() const
+/**
+ * Read data from SPIIFS and clean up expired records
+ */
+void FailureCounterContainer::readFromFS()
 {
-    return _addr;
+    std::fill(std::begin(_table), std::end(_table), FailureCounter());
+    _used = 0;
+    auto file = KFCFS.open(FSPGM(login_failure_file), fs::FileOpenMode::read);
+    if (!file) {
+        return;
+    }
+    auto now = time(nullptr);
+    uint16_t count = 0;
+    FailureCounterFileRecord_t record;
+    while(file.read(reinterpret_cast<uint8_t *>(&record), sizeof(record)) == sizeof(record)) {
+        count++;
+        if (record.addr == 0 || (isTimeValid(now) && isTimeValid(record.lastFailure) && (now - record.lastFailure) > static_cast<time_t>(_storageTimeframe))) {
+            continue;
+        }
+        // older versions appended a record for each failure, the last one is the most recent
+        auto &failure = _insert(record.addr);
+        failure._counter = record.counter;
+        failure._firstFailure = record.firstFailure;
+        failure._lastFailure = record.lastFailure;
+        // restore the bucket from the failures within the check timeframe
+        if (isTimeValid(now) && (now - record.lastFailure) <= _checkTimeframe) {
+            failure._tokens = record.counter >= _attempts ? 0 : (_attempts - record.counter) * FailureCounter::kTokenScale;
+        }
+    }
+    file.close();
+    __LDBG_printf("%u records read from disk, %u stored in memory", count, _used);
+    if (count != _used) {
+        // compact the file
+        _dirty = true;
+        _scheduleFlush();
+    }
 }
 
-void FailureCounter::addFailure()
+void FailureCounterContainer::flush()
 {
-    if (_counter < FailureCounter::MAX_COUNTER) {
-        _counter++;
+    _Timer(_flushTimer).remove();
+    _dirty = false;
+    if (!_persistent) {
+        _writes++;
+        return;
     }
-    _lastFailure = time(nullptr);
-    __LDBG_printf("Failed attempt from %s #%u", _addr.toString().c_str(), _counter);
-    if (isTimeValid(_lastFailure) && _lastFailure > _container._lastRewrite + _container._rewriteInterval) {
-        _container._lastRewrite = _container._rewriteInterval;
-        _container.rewriteStorageFile();
+    auto file = KFCFS.open(FSPGM(login_failure_file), fs::FileOpenMode::write);
+    if (!file) {
+        return;
     }
-    else {
-        auto file = KFCFS.open(FSPGM(login_failure_file), fs::FileOpenMode::append);
-        if (file) {
-            write(file);
-            file.close();
+    auto now = time(nullptr);
+    for(auto &failure: _table) {
+        if (failure && !_isExpired(failure, now)) {
+            auto record = failure.getRecord();
+            file.write(reinterpret_cast<const uint8_t *>(&record), sizeof(record));
         }
     }
+    file.close();
+    _writes++;
+    __LDBG_printf("Written %u records to FS", _used);
 }
 
-void FailureCounter::write(File &file) const
+void FailureCounterContainer::dump(Print &output) const
 {
-    FailureCounterFileRecord_t record = { _addr, _counter, _firstFailure, _lastFailure };
-    file.write(reinterpret_cast<uint8_t *>(&record), sizeof(record));
+    output.printf_P(PSTR("Login failures %u/%u records, %u evicted, %u blocked, %u writes"), _used, kTableSize, _evicted, _blocked, _writes);
 }
 
-const FailureCounter &FailureCounterContainer::addFailure(const IPAddress &addr)
+FailureCounter *FailureCounterContainer::_find(uint32_t addr)
 {
-    for(auto failure = _failures.rbegin(); failure != _failures.rend(); ++failure) {
-        __LDBG_printf("add failure ip %s record %s # %d", addr.toString().c_str(), failure->getIPAddress().toString().c_str(), failure->getCounter());
-        if (failure->isMatch(addr)) {
-            failure->addFailure();
-            return *failure;
+    // empty slots do not end the search, records are removed without moving the others
+    auto index = _getIndex(addr);
+    for(uint8_t i = 0; i < kMaxProbe; i++) {
+        auto &failure = _table[(index + i) & (kTableSize - 1)];
+        if (failure.isMatch(addr)) {
+            return &failure;
         }
     }
-    _failures.push_back(FailureCounter(*this, addr));
-    return _failures.back();
+    return nullptr;
 }
 
-bool FailureCounterContainer::isAddressBlocked(const IPAddress &addr)
+FailureCounter &FailureCounterContainer::_insert(uint32_t addr)
 {
-    _removeOldRecords();
-    for(auto &failure: _failures) {
-        __LDBG_printf("is blocked ip %s record %s # %u, timeframe %u", addr.toString().c_str(), failure.getIPAddress().toString().c_str(), failure.getCounter(), failure.getTimeframe());
-        if (failure.isBlocked(addr)) {
-            return true;
+    auto existing = _find(addr);
+    if (existing) {
+        return *existing;
+    }
+    auto index = _getIndex(addr);
+    FailureCounter *lru = nullptr;
+    uint32_t now = millis();
+    for(uint8_t i = 0; i < kMaxProbe; i++) {
+        auto &failure = _table[(index + i) & (kTableSize - 1)];
+        if (!failure) {
+            lru = &failure;
+            break;
+        }
+        if (!lru || (now - failure._lastMillis) > (now - lru->_lastMillis)) {
+            lru = &failure;
         }
     }
-    return false;
+    if (*lru) {
+        __LDBG_printf("evicting %s #%u", lru->getIPAddress().toString().c_str(), lru->_counter);
+        _evicted++;
+    }
+    else {
+        _used++;
+    }
+    *lru = FailureCounter();
+    lru->_addr = addr;
+    lru->_firstFailure = time(nullptr);
+    lru->_lastFailure = lru->_firstFailure;
+    lru->_lastMillis = now;
+    lru->_tokens = _attempts * FailureCounter::kTokenScale;
+    return *lru;
 }
 
-String FailureCounter::getFirstFailure() const
+void FailureCounterContainer::_refill(FailureCounter &failure, uint32_t now) const
 {
-    PrintString tmp;
-    tmp.strftime_P(PSTR("%Y-%m-%dT%H:%M:%S %Z"), _firstFailure);
-    return tmp;
+    uint16_t capacity = _attempts * FailureCounter::kTokenScale;
+    uint32_t elapsed = now - failure._lastMillis;
+    if (_checkTimeframe == 0 || elapsed >= _checkTimeframe * 1000U) {
+        failure._tokens = capacity;
+    }
+    else {
+        // all attempts are restored after the check timeframe
+        uint32_t tokens = failure._tokens + (static_cast<uint64_t>(elapsed) * capacity) / (_checkTimeframe * 1000U);
+        failure._tokens = std::min<uint32_t>(tokens, capacity);
+    }
+    failure._lastMillis = now;
 }
 
-
-FailureCounterContainer::FailureCounterContainer() :
-    _lastRewrite(0)
+bool FailureCounterContainer::_isExpired(const FailureCounter &failure, time_t now) const
 {
-    auto cfg = System::WebServer::getConfig();
-    _rewriteInterval = cfg.getLoginRewriteInterval();
-    _storageTimeframe = cfg.getLoginStorageTimeframe();
-    _checkTimeframe = cfg.login_timeframe;
-    _attempts = cfg.login_attempts;
+    // keep all records if the time has not been set
+    return isTimeValid(now) && isTimeValid(failure._lastFailure) && (now - failure._lastFailure) > static_cast<time_t>(_storageTimeframe);
 }
 
-
-/**
- * Read data from SPIIFS and clean up expired records
- */
-void FailureCounterContainer::readFromFS()
+void FailureCounterContainer::_scheduleFlush()
 {
-    _failures.clear();
-    auto file = KFCFS.open(FSPGM(login_failure_file), fs::FileOpenMode::read);
-    if (file) {
-#if DEBUG_LOGIN_FAILURES
-        auto count = 0;
-#endif
-        while(file.available()) {
-            FailureCounterFileRecord_t record;
-            if (file.read((uint8_t *)&record, sizeof(record)) != sizeof(record)) {
-                break;
-            }
-#if DEBUG_LOGIN_FAILURES
-            count++;
-#endif
-            uint32_t timeframe = record.lastFailure - record.firstFailure;
-            if (isTimeValid() == false || timeframe < _storageTimeframe) { // keep all records if the time has not been set
-                _failures.push_back(FailureCounter(*this, record));
-            }
-        }
-        file.close();
-
-        __LDBG_printf("%d records read from disk, %d stored in memory", count, _failures.size());
+    // collect all failures of a burst before writing
+    if (!_flushTimer) {
+        _Timer(_flushTimer).add(Event::seconds(_rewriteInterval), false, [this](Event::CallbackTimerPtr) {
+            flush();
+        });
     }
 }
 
-/**
- * Remove expires records and store on FS
- **/
-void FailureCounterContainer::rewriteStorageFile()
+void FailureCounterContainer::benchmark(Print &output, uint16_t failures, uint16_t addresses)
 {
-    auto file = KFCFS.open(FSPGM(login_failure_file), fs::FileOpenMode::write);
-    if (file) {
-#if DEBUG_LOGIN_FAILURES
-        auto count = _failures.size();
-#endif
-        _removeOldRecords();
-        for(auto &failure: _failures) {
-            failure.write(file);
+    std::unique_ptr<FailureCounterContainer> container(new FailureCounterContainer(false));
+    if (!container) {
+        return;
+    }
+    uint32_t blocked = 0;
+    auto start = micros();
+    for(uint16_t i = 0; i < failures; i++) {
+        // 10.x.y.z from a fixed set of addresses
+        IPAddress addr(10, 0, 0, 0);
+        uint16_t n = rand() % addresses;
+        addr[2] = n >> 8;
+        addr[3] = n & 0xff;
+        if (container->isAddressBlocked(addr)) {
+            blocked++;
+        }
+        else {
+            container->addFailure(addr);
+        }
+        if (i % 256 == 0) {
+            delay(0);
         }
-        file.close();
-
-        __LDBG_printf("Written %d out of %d records to FS", _failures.size(), count);
     }
-}
-
-void FailureCounterContainer::_removeOldRecords()
-{
-    // if (this == nullptr) {
-    //     __DBG_printf("_removeOldRecords: self=nullptr");
-    //     return;
-    // }
-    _failures.erase(std::remove_if(_failures.begin(), _failures.end(), [this](const FailureCounter &failure) {
-        return failure.getTimeframe() > _storageTimeframe;
-    }), _failures.end());
+    auto duration = micros() - start;
+    container->flush();
+    output.printf_P(PSTR("%u failed logins from %u addresses in %uus (%.2fus per login), %u blocked\n"), failures, addresses, duration, duration / static_cast<float>(failures), blocked);
+    container->dump(output);
+    output.printf_P(PSTR("\nFile system writes %u, writes without batching %u\n"), container->_writes, failures - blocked);
 }
 
 #endif
@@ -14,6 +14,7 @@
 #include "blink_led_timer.h"
 #include "deep_sleep.h"
 #include "kfc_fw_config.h"
+#include "metrics.h"
 #include "plugins_menu.h"
 #include "reset_detector.h"
 #include "save_crash.h"
@@ -582,6 +583,9 @@ void setup()
 
 void loop()
 {
+    #if KFC_METRICS
+        Metrics::loopInterval();
+    #endif
     auto &loopFunctions = LoopFunctions::getVector();
     bool cleanUp = false;
     for(uint32_t i = 0; i < static_cast<uint32_t>(loopFunctions.size()); i++) { // do not use iterators since the vector can be modified inside the callback
@@ -34,6 +34,9 @@
 #if IOT_WEATHER_STATION
 #    include "../src/plugins/weather_station/weather_station.h"
 #endif
+#if MDNS_PLUGIN
+#    include "../src/plugins/mdns/zeroconf_cache.h"
+#endif
 
 #if defined(ESP8266)
 #    include <core_esp8266_version.h>
@@ -169,7 +172,9 @@ KFCFWConfiguration::KFCFWConfiguration() :
     _wifiNumActive(0),
     _wifiErrorCount(0),
     _dirty(false),
-    _safeMode(false)
+    _safeMode(false),
+    _dirtyBytes(0),
+    _writeStats({})
 {
     _setupWiFiCallbacks();
 }
@@ -841,7 +846,13 @@ void SaveCrash::Data::FirmwareVersion::printTo(Print &output, const __FlashStrin
 
 void KFCFWConfiguration::read(bool wakeup)
 {
-    if (!Configuration::read()) {
+    auto start = micros();
+    auto result = Configuration::read();
+    _writeStats.readTime = micros() - start;
+    _dirtyHandles.clear();
+    _writeableHandles.clear();
+    _dirtyBytes = 0;
+    if (!result) {
         Logger_error(F("Failed to read configuration, restoring factory settings"));
         config.restoreFactorySettings();
         Configuration::write();
@@ -866,10 +877,101 @@ void KFCFWConfiguration::read(bool wakeup)
 
 void KFCFWConfiguration::write()
 {
+    _collectWriteableHandles();
+    // values that have been set to the same value do not mark the configuration dirty
+    if (!isDirty() && _dirtyHandles.empty()) {
+        _writeStats.skipped++;
+        __LDBG_printf("no changes, skipped=%u", _writeStats.skipped);
+        return;
+    }
+    auto start = micros();
     auto result = Configuration::write();
+    auto time = micros() - start;
+    _writeStats.lastWriteTime = time;
+    _writeStats.maxWriteTime = std::max(_writeStats.maxWriteTime, time);
+    _writeStats.totalWriteTime += time;
+    _writeStats.lastHandles = _dirtyHandles.size();
+    _writeStats.lastBytes = _dirtyBytes;
+    __LDBG_printf("time=%uus handles=%u bytes=%u", time, _dirtyHandles.size(), _dirtyBytes);
+    _dirtyHandles.clear();
+    _dirtyHandles.shrink_to_fit();
+    _dirtyBytes = 0;
     if (result != Configuration::WriteResultType::SUCCESS) {
+        _writeStats.failed++;
         Logger_error(F("Failed to write settings to EEPROM. %s"), Configuration::getWriteResultTypeStr(result));
+        return;
+    }
+    _writeStats.writes++;
+    #if defined(HAVE_NVS_FLASH)
+        // NVS appends the modified items to the current page, pages are erased when they get recycled
+        _writeStats.lastFlashErased = 0;
+        _writeStats.lastFlashWritten = _writeStats.lastBytes;
+    #else
+        // the EEPROM emulation erases the sector and writes the entire buffer
+        _writeStats.lastFlashErased = SPI_FLASH_SEC_SIZE;
+        _writeStats.lastFlashWritten = CONFIG_EEPROM_SIZE;
+    #endif
+    _writeStats.totalFlashErased += _writeStats.lastFlashErased;
+    _writeStats.totalFlashWritten += _writeStats.lastFlashWritten;
+}
+
+void KFCFWConfiguration::addWriteableHandle(Handle_t handle, const void *data, uint16_t length)
+{
+    // keep the CRC of the value before it was modified for the first time
+    for(const auto &item: _writeableHandles) {
+        if (item.handle == handle) {
+            return;
+        }
+    }
+    _writeableHandles.emplace_back(WriteableHandle({handle, length, crc16_update(~0, data, length)}));
+}
+
+void KFCFWConfiguration::_collectWriteableHandles()
+{
+    for(const auto &item: _writeableHandles) {
+        uint16_t length;
+        auto data = getBinaryV(item.handle, length);
+        if (!data || length != item.length || crc16_update(~0, data, length) != item.crc) {
+            addDirtyHandle(item.handle, length);
+        }
+        else {
+            _writeStats.identical++;
+        }
     }
+    _writeableHandles.clear();
+    _writeableHandles.shrink_to_fit();
+}
+
+void KFCFWConfiguration::addDirtyHandle(Handle_t handle, uint16_t length)
+{
+    if (std::find(_dirtyHandles.begin(), _dirtyHandles.end(), handle) == _dirtyHandles.end()) {
+        _dirtyHandles.push_back(handle);
+        _dirtyBytes += length;
+    }
+}
+
+void KFCFWConfiguration::printWriteStats(Print &output) const
+{
+    output.printf_P(PSTR("read=%uus writes=%u skipped=%u failed=%u identical values=%u\n"),
+        _writeStats.readTime, _writeStats.writes, _writeStats.skipped, _writeStats.failed, _writeStats.identical
+    );
+    output.printf_P(PSTR("write time last=%uus avg=%uus max=%uus, last write handles=%u size=%u, pending handles=%u size=%u writeable=%u dirty=%u\n"),
+        _writeStats.lastWriteTime,
+        _writeStats.writes ? static_cast<uint32_t>(_writeStats.totalWriteTime / _writeStats.writes) : 0,
+        _writeStats.maxWriteTime,
+        _writeStats.lastHandles,
+        _writeStats.lastBytes,
+        _dirtyHandles.size(),
+        _dirtyBytes,
+        _writeableHandles.size(),
+        isDirty()
+    );
+    output.printf_P(PSTR("flash last write erased=%u written=%u, total erased=%.0f written=%.0f bytes\n"),
+        _writeStats.lastFlashErased,
+        _writeStats.lastFlashWritten,
+        static_cast<double>(_writeStats.totalFlashErased),
+        static_cast<double>(_writeStats.totalFlashWritten)
+    );
 }
 
 #if defined(HAVE_NVS_FLASH)
@@ -987,18 +1089,18 @@ void KFCFWConfiguration::printDiag(Print &output, const String &prefix)
     #endif
 }
 
-bool KFCFWConfiguration::resolveZeroConf(const String &name, const String &hostname, uint16_t port, MDNSResolver::ResolvedCallback callback) const
+bool KFCFWConfiguration::resolveZeroConf(const String &name, const String &hostname, uint16_t port, MDNSResolver::ResolvedCallback callback, bool cached) const
 {
-    __LDBG_printf("resolveZeroConf=%s port=%u", hostname.c_str(), port);
+    __LDBG_printf("resolveZeroConf=%s port=%u cached=%u", hostname.c_str(), port, cached);
     String prefix, suffix;
     auto start = hostname.indexOf(FSPGM(_var_zeroconf));
     if (start != -1) {
         start += 11;
         auto end = hostname.indexOf('}', start);
         if (end != -1) {
-            auto serviceEnd = hostname.indexOf('.');
-            auto protoEnd = hostname.indexOf(',');
-            auto valuesEnd = hostname.indexOf('|');
+            auto serviceEnd = hostname.indexOf('.', start);
+            auto protoEnd = hostname.indexOf(',', start);
+            auto valuesEnd = hostname.indexOf('|', start);
             __LDBG_printf("start=%d end=%d service_end=%d proto_end=%d name_end=%d", start, end, serviceEnd, protoEnd, valuesEnd);
             if (serviceEnd != -1 && protoEnd != -1 && serviceEnd < protoEnd && (valuesEnd == -1 || protoEnd < valuesEnd)) {
                 auto service = hostname.substring(start, serviceEnd);
@@ -1036,16 +1138,49 @@ bool KFCFWConfiguration::resolveZeroConf(const String &name, const String &hostn
 
                 __LDBG_printf("service=%s proto=%s values=%s:%s default=%s port=%d", service.c_str(), proto.c_str(), addressValue.c_str(), portValue.c_str(), defaultValue.c_str(), port);
 
+                using MDNSResolver::ZeroConfCache;
+
+                // use the last known address and validate it in the background
+                auto key = ZeroConfCache::getKey(hostname, port);
+                ZeroConfCache::Entry entry;
+                if (cached && ZeroConfCache::find(key, entry)) {
+                    IPAddress address(entry.address);
+                    auto resolved = prefix + address.toString() + suffix;
+                    __LDBG_printf("cached address=%s port=%u", address.toString().c_str(), entry.port);
+                    LoopFunctions::callOnce([address, entry, resolved, callback]() {
+                        callback(address.toString(), address, entry.port, resolved, MDNSResolver::ResponseType::RESOLVED);
+                    });
+                }
+                else {
+                    cached = false;
+                }
+
                 auto mdns = PluginComponent::getPlugin<MDNSPlugin>(F("mdns"), true);
                 if (!mdns) {
                     Logger_error(F("Cannot resolve Zeroconf, MDNS plugin not loaded: %s"), hostname.c_str());
-                    LoopFunctions::callOnce([defaultValue, port, callback]() {
-                        callback(defaultValue, IPAddress(), port, defaultValue, MDNSResolver::ResponseType::TIMEOUT);
-                    });
+                    if (!cached) {
+                        LoopFunctions::callOnce([defaultValue, port, callback]() {
+                            callback(defaultValue, IPAddress(), port, defaultValue, MDNSResolver::ResponseType::TIMEOUT);
+                        });
+                    }
                     return true;
                 }
 
-                mdns->resolveZeroConf(new MDNSResolver::Query(name, service, proto, addressValue, portValue, defaultValue, port, prefix, suffix, callback, System::Device::getConfig().zeroconf_timeout));
+                mdns->resolveZeroConf(new MDNSResolver::Query(name, service, proto, addressValue, portValue, defaultValue, port, prefix, suffix, [key, cached, entry, callback](const String &hostname, const IPAddress &address, uint16_t port, const String &resolved, MDNSResolver::ResponseType type) {
+                    bool changed = false;
+                    if (type == MDNSResolver::ResponseType::RESOLVED) {
+                        auto ipAddress = IPAddress_isValid(address) ? address : convertToIPAddress(hostname);
+                        if (IPAddress_isValid(ipAddress)) {
+                            changed = ZeroConfCache::update(key, ipAddress, port);
+                        }
+                    }
+                    // the client has been using the cached address already
+                    if (cached && !changed) {
+                        __LDBG_printf("cached address validated type=%u", type);
+                        return;
+                    }
+                    callback(hostname, address, port, resolved, type);
+                }, System::Device::getConfig().zeroconf_timeout));
                 return true;
 
             }
@@ -17,13 +17,24 @@ namespace KFCConfigurationClasses {
     {
         auto data = config.getWriteableBinary(handle, length);
         __CDBG_printf("handle=%04x data=%p len=%u", handle, data, length);
+        if (data) {
+            config.addWriteableHandle(handle, data, length);
+        }
         return data;
     }
 
     inline void storeBinaryConfig(HandleType handle, const void *data, uint16_t length)
     {
         __CDBG_printf("handle=%04x data=%p len=%u", handle, data, length);
+        // do not mark the configuration dirty if the value did not change
+        uint16_t curLength;
+        auto cur = config.getBinaryV(handle, curLength);
+        if (cur && curLength == length && memcmp(cur, data, length) == 0) {
+            config.addIdenticalValue();
+            return;
+        }
         config.setBinary(handle, data, length);
+        config.addDirtyHandle(handle, length);
     }
 
     inline const char *loadStringConfig(HandleType handle)
@@ -41,19 +52,37 @@ namespace KFCConfigurationClasses {
     inline void storeStringConfig(HandleType handle, const char *str)
     {
         __CDBG_printf("handle=%04x str=%s len=%u", handle, _S_STR(str), _S_STRLEN(str));
+        auto cur = config.getString(handle);
+        if (cur && str && strcmp(cur, str) == 0) {
+            config.addIdenticalValue();
+            return;
+        }
         config.setString(handle, str);
+        config.addDirtyHandle(handle, str ? strlen(str) : 0);
     }
 
     inline void storeStringConfig(HandleType handle, const __FlashStringHelper *str)
     {
         __CDBG_printf("handle=%04x str=%s len=%u", handle, _S_STR(str), _S_STRLEN(str));
+        auto cur = config.getString(handle);
+        if (cur && str && strcmp_P(cur, reinterpret_cast<PGM_P>(str)) == 0) {
+            config.addIdenticalValue();
+            return;
+        }
         config.setString(handle, str);
+        config.addDirtyHandle(handle, str ? strlen_P(reinterpret_cast<PGM_P>(str)) : 0);
     }
 
     inline void storeStringConfig(HandleType handle, const String &str)
     {
         __CDBG_printf("handle=%04x str=%s len=%u", handle, _S_STR(str), _S_STRLEN(str));
+        auto cur = config.getString(handle);
+        if (cur && strcmp(cur, str.c_str()) == 0) {
+            config.addIdenticalValue();
+            return;
+        }
         config.setString(handle, str);
+        config.addDirtyHandle(handle, str.length());
     }
 
 }
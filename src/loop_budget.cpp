@@ -0,0 +1,136 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include "loop_budget.h"
+
+#if DEBUG_LOOP_BUDGET
+#    include "debug_helper_enable.h"
+#else
+#    include "debug_helper_disable.h"
+#endif
+
+namespace LoopBudget {
+
+    static const char _name_animation[] PROGMEM = "Animation";
+    static const char _name_led_show[] PROGMEM = "LED Show";
+    static const char _name_web_server[] PROGMEM = "Web Server";
+    static const char _name_mqtt[] PROGMEM = "MQTT";
+
+    static constexpr uint8_t kNumConsumers = static_cast<uint8_t>(ConsumerType::MAX);
+
+    static uint32_t _resetTime;
+    // time spent in yieldToOthers(). the consumers that run during delay() measure their own time
+    static uint64_t _yieldTime;
+    static uint32_t _yieldCalls;
+
+    static Consumer _consumers[kNumConsumers] = {
+        { _name_animation, LOOP_BUDGET_ANIMATION, 0, 0, 0, 0 },
+        { _name_led_show, LOOP_BUDGET_LED_SHOW, 0, 0, 0, 0 },
+        { _name_web_server, LOOP_BUDGET_WEB_SERVER, 0, 0, 0, 0 },
+        { _name_mqtt, LOOP_BUDGET_MQTT, 0, 0, 0, 0 }
+    };
+
+    Consumer &getConsumer(ConsumerType type)
+    {
+        return _consumers[static_cast<uint8_t>(type)];
+    }
+
+    void setBudget(ConsumerType type, uint16_t budget, uint8_t priority)
+    {
+        auto &consumer = getConsumer(type);
+        consumer.budget = budget;
+        consumer.priority = std::max<uint8_t>(1, priority);
+    }
+
+    void addTime(ConsumerType type, uint32_t time)
+    {
+        auto &consumer = getConsumer(type);
+        consumer.totalTime += time;
+        consumer.calls++;
+        // alpha = 1/8
+        consumer.avgCost = ((consumer.avgCost * 7) + (time << 4)) >> 3;
+    }
+
+    uint32_t getYieldTime(ConsumerType owner, uint32_t usedTime)
+    {
+        auto &self = getConsumer(owner);
+        uint32_t weights = 0;
+        uint32_t demand = 0;
+        for(const auto &consumer: _consumers) {
+            if (&consumer == &self || !consumer.isActive()) {
+                continue;
+            }
+            weights += consumer.priority;
+            demand += consumer.budget * static_cast<uint32_t>(consumer.demand);
+        }
+        if (!weights) {
+            return 0;
+        }
+        // split the time of this pass by weight and limit it to the demand of the active consumers
+        // if the owner exceeds its budget, the others get more time to catch up
+        auto time = (std::max<uint32_t>(usedTime, self.getAvgCost()) * weights) / self.priority;
+        if (usedTime > self.budget) {
+            time += usedTime - self.budget;
+        }
+        return std::min<uint32_t>(std::min<uint32_t>(time, demand), LOOP_BUDGET_MAX_YIELD_TIME);
+    }
+
+    uint32_t yieldToOthers(ConsumerType owner, uint32_t usedTime)
+    {
+        auto time = getYieldTime(owner, usedTime);
+        if (!time) {
+            return 0;
+        }
+        auto start = micros();
+        if (time >= 1000) {
+            delay(time / 1000);
+        }
+        else {
+            yield();
+        }
+        time = micros() - start;
+        _yieldTime += time;
+        _yieldCalls++;
+        __LDBG_printf("owner=%u used=%u yield=%u", owner, usedTime, time);
+        return time;
+    }
+
+    void reset()
+    {
+        for(auto &consumer: _consumers) {
+            consumer.totalTime = 0;
+            consumer.calls = 0;
+        }
+        _yieldTime = 0;
+        _yieldCalls = 0;
+        _resetTime = millis();
+    }
+
+    void printReport(Print &output)
+    {
+        uint32_t elapsed = millis() - _resetTime;
+        output.printf_P(PSTR("elapsed %.3fs\n"), elapsed / 1000.0);
+        for(const auto &consumer: _consumers) {
+            output.printf_P(PSTR("%-10.10s prio=%u budget=%uus demand=%u avg=%uus calls=%u time=%.3fms cpu=%.2f%%\n"),
+                consumer.name,
+                consumer.priority,
+                consumer.budget,
+                consumer.demand,
+                consumer.getAvgCost(),
+                consumer.calls,
+                consumer.totalTime / 1000.0,
+                elapsed ? (consumer.totalTime / (elapsed * 10.0)) : 0.0
+            );
+        }
+        // includes idle time and the time of consumers that do not measure their costs
+        output.printf_P(PSTR("%-10.10s calls=%u time=%.3fms cpu=%.2f%%\n"),
+            PSTR("Yielded"),
+            _yieldCalls,
+            _yieldTime / 1000.0,
+            elapsed ? (_yieldTime / (elapsed * 10.0)) : 0.0
+        );
+    }
+
+}
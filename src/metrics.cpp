@@ -0,0 +1,193 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <PrintString.h>
+#include "kfc_fw_config.h"
+#include "metrics.h"
+
+#if KFC_METRICS
+
+#if DEBUG_METRICS
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+using namespace Metrics;
+
+// constant initialization, the pointers are valid before any metric is constructed
+Metric *Metric::_head = nullptr;
+Metric **Metric::_tail = &Metric::_head;
+
+Metric::Metric(PGM_P name, PGM_P help, Type type) : _name(name), _help(help), _next(nullptr), _type(type)
+{
+    // keep the order of registration
+    *_tail = this;
+    _tail = &_next;
+}
+
+// ------------------------------------------------------------------------
+// samples
+
+void Counter::printSamples(Print &output) const
+{
+    output.printf_P(PSTR("%s %u\n"), getName(), get());
+}
+
+void Gauge::printSamples(Print &output) const
+{
+    output.printf_P(PSTR("%s %d\n"), getName(), get());
+}
+
+HistogramBase::HistogramBase(PGM_P name, PGM_P help, const uint32_t *bounds, uint32_t *counts, uint8_t size) :
+    Metric(name, help, Type::HISTOGRAM),
+    _bounds(bounds),
+    _counts(counts),
+    _sum(0),
+    _count(0),
+    _size(size)
+{
+}
+
+void HistogramBase::observe(uint32_t value)
+{
+    uint8_t i = 0;
+    while(i < _size && value > pgm_read_dword(&_bounds[i])) {
+        i++;
+    }
+    #if ESP32
+        __atomic_fetch_add(&_counts[i], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&_count, 1, __ATOMIC_RELAXED);
+    #else
+        _counts[i]++;
+        _count++;
+    #endif
+    _sum += value;
+}
+
+void HistogramBase::printSamples(Print &output) const
+{
+    // the buckets of the text format are cumulative
+    uint32_t total = 0;
+    for(uint8_t i = 0; i < _size; i++) {
+        total += __atomic_load_n(&_counts[i], __ATOMIC_RELAXED);
+        output.printf_P(PSTR("%s_bucket{le=\"%u\"} %u\n"), getName(), pgm_read_dword(&_bounds[i]), total);
+    }
+    total += __atomic_load_n(&_counts[_size], __ATOMIC_RELAXED);
+    output.printf_P(PSTR("%s_bucket{le=\"+Inf\"} %u\n"), getName(), total);
+    output.printf_P(PSTR("%s_sum %.0f\n"), getName(), static_cast<double>(_sum));
+    output.printf_P(PSTR("%s_count %u\n"), getName(), total);
+}
+
+// ------------------------------------------------------------------------
+// export
+
+void Metrics::printMetric(Print &output, const Metric &metric)
+{
+    PGM_P type;
+    switch(metric.getType()) {
+        case Type::COUNTER:
+            type = PSTR("counter");
+            break;
+        case Type::GAUGE:
+            type = PSTR("gauge");
+            break;
+        default:
+            type = PSTR("histogram");
+            break;
+    }
+    output.printf_P(PSTR("# HELP %s %s\n# TYPE %s %s\n"), metric.getName(), metric.getHelp(), metric.getName(), type);
+    metric.printSamples(output);
+}
+
+void Metrics::print(Print &output)
+{
+    for(auto metric = Metric::getFirst(); metric; metric = metric->getNext()) {
+        printMetric(output, *metric);
+    }
+}
+
+Writer::Writer() : _metric(Metric::getFirst())
+{
+}
+
+size_t Writer::read(uint8_t *buffer, size_t maxLen)
+{
+    size_t len = 0;
+    while(len < maxLen) {
+        if (_pending.length() == 0) {
+            if (!_metric) {
+                break;
+            }
+            PrintString str;
+            printMetric(str, *_metric);
+            _metric = _metric->getNext();
+            _pending = std::move(str);
+        }
+        size_t size = std::min<size_t>(maxLen - len, _pending.length());
+        memcpy(buffer + len, _pending.c_str(), size);
+        _pending.remove(0, size);
+        len += size;
+    }
+    return len;
+}
+
+// ------------------------------------------------------------------------
+// system metrics
+
+static int32_t getUptime()
+{
+    return getSystemUptime();
+}
+
+static int32_t getFreeHeap()
+{
+    return ESP.getFreeHeap();
+}
+
+static int32_t getMaxBlockSize()
+{
+    #if ESP32
+        return ESP.getMaxAllocHeap();
+    #else
+        return ESP.getMaxFreeBlockSize();
+    #endif
+}
+
+static int32_t getFragmentation()
+{
+    #if ESP8266
+        return ESP.getHeapFragmentation();
+    #else
+        auto free = ESP.getFreeHeap();
+        return free ? 100 - ((ESP.getMaxAllocHeap() * 100ULL) / free) : 0;
+    #endif
+}
+
+METRICS_GAUGE_CALLBACK_DEF(uptimeSeconds, "kfc_uptime_seconds", "Time since boot", getUptime);
+METRICS_GAUGE_CALLBACK_DEF(heapFreeBytes, "kfc_heap_free_bytes", "Free heap", getFreeHeap);
+METRICS_GAUGE_CALLBACK_DEF(heapMaxBlockBytes, "kfc_heap_max_block_bytes", "Largest block that can be allocated", getMaxBlockSize);
+METRICS_GAUGE_CALLBACK_DEF(heapFragmentation, "kfc_heap_fragmentation_percent", "Heap fragmentation", getFragmentation);
+METRICS_HISTOGRAM_DEF(loopIntervalMicros, "kfc_loop_interval_microseconds", "Time between two passes of the main loop", 100, 500, 1000, 5000, 20000, 100000);
+
+#if ESP32
+
+static const char cpuLoad_name[] PROGMEM = "kfc_cpu_load_percent";
+static const char cpuLoad_help[] PROGMEM = "CPU load of both cores while the CPU monitor is running";
+Gauge Metrics::cpuLoad(cpuLoad_name, cpuLoad_help);
+
+#endif
+
+void Metrics::loopInterval()
+{
+    static uint32_t last = 0;
+    uint32_t now = micros();
+    if (last) {
+        loopIntervalMicros.observe(now - last);
+    }
+    last = now;
+}
+
+#endif
@@ -80,49 +80,6 @@ void Register::dumpList(Print &output)
     output.print(FPSTR(header));
 }
 
-void RegisterEx::_createMenu()
-{
-    _navMenu.home = _bootstrapMenu.addMenu(FSPGM(Home));
-    _bootstrapMenu.getItem(_navMenu.home)->setUri(FSPGM(index_html));
-
-    // since "home" has an URI, this menu is hidden
-    _bootstrapMenu.addMenuItem(FSPGM(Home), FSPGM(index_html), _navMenu.home);
-    _bootstrapMenu.addMenuItem(FSPGM(Status), FSPGM(status_html), _navMenu.home);
-    _bootstrapMenu.addMenuItem(F("Manage WiFi"), FSPGM(wifi_html), _navMenu.home);
-    _bootstrapMenu.addMenuItem(F("Configure Network"), FSPGM(network_html), _navMenu.home);
-    _bootstrapMenu.addMenuItem(FSPGM(Change_Password), FSPGM(password_html), _navMenu.home);
-    _bootstrapMenu.addMenuItem(FSPGM(Reboot_Device), FSPGM(reboot_html), _navMenu.home);
-    _bootstrapMenu.addMenuItem(F("About"), F("about.html"), _navMenu.home);
-
-    _navMenu.status = _bootstrapMenu.addMenu(FSPGM(Status));
-    _bootstrapMenu.getItem(_navMenu.status)->setUri(FSPGM(status_html));
-
-    _navMenu.config = _bootstrapMenu.addMenu(FSPGM(Configuration));
-    _bootstrapMenu.addMenuItem(FSPGM(WiFi), FSPGM(wifi_html), _navMenu.config);
-    _bootstrapMenu.addMenuItem(FSPGM(Network), FSPGM(network_html), _navMenu.config);
-    _bootstrapMenu.addMenuItem(FSPGM(Device), FSPGM(device_html), _navMenu.config);
-    _bootstrapMenu.addMenuItem(F("Remote Access"), FSPGM(remote_html), _navMenu.config);
-
-    _navMenu.device = _bootstrapMenu.addMenu(FSPGM(Device));
-
-    _navMenu.admin = _bootstrapMenu.addMenu(FSPGM(Admin));
-    _bootstrapMenu.addMenuItem(FSPGM(Change_Password), FSPGM(password_html), _navMenu.admin);
-    _bootstrapMenu.addMenuItem(FSPGM(Reboot_Device), FSPGM(reboot_html), _navMenu.admin);
-    _bootstrapMenu.addMenuItem(F("Restore Factory Defaults"), FSPGM(factory_html), _navMenu.admin);
-    _bootstrapMenu.addMenuItem(F("Export Settings"), F("export-settings"), _navMenu.admin);
-    #if WEBSERVER_KFC_OTA
-        _bootstrapMenu.addMenuItem(F("Update Firmware"), FSPGM(update_fw_html), _navMenu.admin);
-    #endif
-    #if ENABLE_ARDUINO_OTA && !ENABLE_ARDUINO_OTA_AUTOSTART
-        _bootstrapMenu.addMenuItem(F("Enable ArduinoOTA"), F("start-arduino-ota"), _navMenu.admin);
-    #endif
-
-    _navMenu.util = _bootstrapMenu.addMenu(F("Utilities"));
-    #if WEBSERVER_SPEED_TEST
-        _bootstrapMenu.addMenuItem(F("Speed Test"), F("speed-test.html"), _navMenu.util);
-    #endif
-}
-
 void Register::sort()
 {
     __LDBG_printf("sort=%u", _plugins.size());
@@ -138,18 +95,12 @@ void Register::setup(SetupModeType mode, DependenciesPtr dependencies)
     if (!dependencies.get()) {
         dependencies.reset(new PluginComponents::Dependencies());
     }
-    __LDBG_printf("main menu");
+    // the static part of the menu is stored in PROGMEM, see plugins_menu.cpp
     auto &_bootstrapMenu = RegisterEx::getBootstrapMenu();
-    __LDBG_printf("nav menu");
     auto &_navMenu = RegisterEx::getNavMenu();
 
     __LDBG_printf("mode=%d counter=%d", mode, _plugins.size());
 
-    if (mode != SetupModeType::DELAYED_AUTO_WAKE_UP) {
-        __LDBG_printf("create menu");
-        RegisterEx::getInstance()._createMenu();
-    }
-
     __LDBG_printf("get blacklist");
     auto blacklist = System::Firmware::getPluginBlacklist();
 
@@ -193,20 +144,13 @@ void Register::setup(SetupModeType mode, DependenciesPtr dependencies)
                 __LDBG_printf("menu=custom plugin=%s", plugin->getName_P());
                 plugin->createMenu();
                 break;
-            case MenuType::AUTO: {
-                StringVector list;
-                explode_P(plugin->getConfigForms(), ',', list);
-                if (std::find(list.begin(), list.end(), plugin->getName()) == list.end()) {
-                    list.emplace_back(plugin->getName());
-                }
-                __LDBG_printf("menu=auto plugin=%s forms=%s", plugin->getName_P(), implode(',', list).c_str());
-                for (const auto &str : list) {
-                    if (plugin->canHandleForm(str)) {
-                        __LDBG_printf("menu=auto form=%s can_handle=true", str.c_str());
-                        _bootstrapMenu.addMenuItem(plugin->getFriendlyName(), str + FSPGM(_html), _navMenu.config);
-                    }
+            case MenuType::AUTO:
+                // the menu entries are rendered from the config forms stored in PROGMEM
+                if (plugin->getOptions().has_config_forms) {
+                    __LDBG_printf("menu=auto plugin=%s forms=%s", plugin->getName_P(), plugin->getConfigForms());
+                    _bootstrapMenu.addPluginForms(*plugin, _navMenu.config);
                 }
-            } break;
+                break;
             case MenuType::NONE:
             default:
                 __LDBG_printf("menu=none plugin=%s", plugin->getName_P());
@@ -222,7 +166,7 @@ void Register::setup(SetupModeType mode, DependenciesPtr dependencies)
             auto webUi = FSPGM(WebUI);
             _bootstrapMenu.addMenuItem(webUi, url, _navMenu.device, _navMenu.device/*insert at the top*/);
 
-            auto home = _bootstrapMenu.addMenuItem(webUi, url, _navMenu.home, _bootstrapMenu.getId(_bootstrapMenu.findMenuByURI(FSPGM(status_html), _navMenu.home)));
+            auto home = _bootstrapMenu.addMenuItem(webUi, url, _navMenu.home, _bootstrapMenu.findMenuByURI(FSPGM(status_html), _navMenu.home));
             (void)home;
 
             #if WEATHER_STATION_HAVE_BMP_SCREENSHOT
@@ -268,5 +268,6 @@ void BlindsControl::_updateAdc()
     if (_adcIntegral > _adcIntegralPeak) {
         _adcIntegralPeak = _adcIntegral;
     }
+    _recorder.add(_adcIntegral);
 }
 
@@ -9,6 +9,7 @@
 #include <MicrosTimer.h>
 #include <MillisTimer.h>
 #include <ReadADC.h>
+#include "adc_scheduler.h"
 #include <Buffer.h>
 #include <FunctionalInterrupt.h>
 #include "../src/plugins/mqtt/component.h"
@@ -16,6 +17,7 @@
 #include "PluginComponent.h"
 #include <kfc_fw_config.h>
 #include "blinds_defines.h"
+#include "blinds_recorder.h"
 #include <stl_ext/algorithm.h>
 
 #if DEBUG_IOT_BLINDS_CTRL
@@ -376,6 +378,7 @@ protected:
     float _adcIntegralPeak;
     MicrosTimer _currentTimer;
     Event::Timer _toneTimer;
+    BlindsCurrentRecorder _recorder;
 
 private:
     ADCManager &_adc;
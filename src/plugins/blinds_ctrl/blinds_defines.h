@@ -65,6 +65,21 @@
 #    define IOT_BLINDS_CTRL_SHUNT 100
 #endif
 
+// number of motor current traces kept in memory
+#ifndef IOT_BLINDS_CTRL_TRACE_COUNT
+#    define IOT_BLINDS_CTRL_TRACE_COUNT 2
+#endif
+
+// max. number of samples per trace. if a trace is full, the samples are averaged in pairs and the interval is doubled
+#ifndef IOT_BLINDS_CTRL_TRACE_SAMPLES
+#    define IOT_BLINDS_CTRL_TRACE_SAMPLES 256
+#endif
+
+// stop the motor if the learned signature predicts the end stop before the current limit has been reached
+#ifndef IOT_BLINDS_CTRL_PREDICT_END_STOP
+#    define IOT_BLINDS_CTRL_PREDICT_END_STOP 1
+#endif
+
 namespace BlindsControllerConversion {
 
     static constexpr double kShuntValue = IOT_BLINDS_CTRL_SHUNT / 1000.0; // Ohm
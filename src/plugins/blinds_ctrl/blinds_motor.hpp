@@ -14,10 +14,15 @@ inline void BlindsControl::_startMotor(ChannelType channel, bool open)
     _stop();
     // set active channel
     _activeChannel = channel;
+    // the motor current has precedence over other ADC consumers
+    ADCScheduler::getInstance().lock();
 
     auto &cfg = _config.channels[*channel];
     _currentLimit = cfg.current_limit_mA * BlindsControllerConversion::kConvertCurrentToADCValueMultiplier;
 
+    auto &state = _states[channel];
+    _recorder.begin(*channel, open, state.isOpen() ? 100 : (state.isClosed() ? 0 : -1));
+
     _states[channel] = open ? StateType::OPEN : StateType::CLOSED;
 
     _publishState();
@@ -62,11 +67,19 @@ inline bool BlindsControl::_checkMotor()
     if (_adcIntegral > _currentLimit) {
         __LDBG_printf("current limit time=%.2f @ %u ms", _adcIntegral, _motorTimeout.getDelay() - _motorTimeout.getTimeLeft());
         Logger_notice("Channel %u, current limit %umA (%.2f/%.2f) triggered after %ums (max. %ums)", _activeChannel, (uint32_t)(_adcIntegral * BlindsControllerConversion::kConvertADCValueToCurrentMultiplier), _adcIntegral, _currentLimit, _motorTimeout.getDelay() - _motorTimeout.getTimeLeft(), _motorTimeout.getDelay());
+        _recorder.end(BlindsCurrentRecorder::EndType::CURRENT_LIMIT);
+        return true;
+    }
+    if (_recorder.isEndStopPredicted(_adcIntegral, _currentLimit)) {
+        __LDBG_printf("end stop predicted current=%.2f @ %u ms", _adcIntegral, _motorTimeout.getDelay() - _motorTimeout.getTimeLeft());
+        Logger_notice("Channel %u, end stop predicted at %umA (%.2f/%.2f) after %ums", _activeChannel, (uint32_t)(_adcIntegral * BlindsControllerConversion::kConvertADCValueToCurrentMultiplier), _adcIntegral, _currentLimit, _motorTimeout.getDelay() - _motorTimeout.getTimeLeft());
+        _recorder.end(BlindsCurrentRecorder::EndType::PREDICTED);
         return true;
     }
     if (_motorTimeout.reached()) {
         __LDBG_printf("timeout");
         Logger_notice("Channel %u, motor stopped after %ums timeout, peak current %umA (%.2f/%.2f)", _activeChannel, _motorTimeout.getDelay(), (uint32_t)(_adcIntegralPeak * BlindsControllerConversion::kConvertADCValueToCurrentMultiplier), _adcIntegralPeak, _currentLimit);
+        _recorder.end(BlindsCurrentRecorder::EndType::TIMEOUT);
         return true;
     }
     return false;
@@ -155,7 +168,11 @@ inline void BlindsControl::_stop()
     _motorStartTime = 0;
     _motorPWMValue = 0;
     _motorTimeout.disable();
+    _recorder.end(BlindsCurrentRecorder::EndType::STOPPED);
 
+    if (_activeChannel != ChannelType::NONE) {
+        ADCScheduler::getInstance().unlock();
+    }
     _activeChannel = ChannelType::NONE;
     _disableMotors();
     digitalWrite(_config.pins[kMultiplexerPin], LOW);
@@ -14,6 +14,7 @@
 #include "BlindsControl.h"
 #include "plugins_menu.h"
 #include "../src/plugins/mqtt/mqtt_client.h"
+#include "web_server.h"
 
 #if DEBUG_IOT_BLINDS_CTRL
 #    include <debug_helper_enable.h>
@@ -67,6 +68,43 @@ void BlindsControlPlugin::setup(SetupModeType mode, const PluginComponents::Depe
         _publishState();
     }
 
+    dependencies->dependsOn(F("http"), [](const PluginComponent *, DependencyResponseType response) {
+        if (response == DependencyResponseType::SUCCESS) {
+            WebServer::Plugin::addHandler(F("/blinds_traces.csv"), _sendTraces);
+        }
+    }, this);
+}
+
+void BlindsControlPlugin::_sendTraces(AsyncWebServerRequest *request)
+{
+    if (WebServer::Plugin::getInstance().isAuthenticated(request) == false) {
+        request->send(403);
+        return;
+    }
+    // the CSV file is created line by line while sending
+    auto line = std::make_shared<uint16_t>(0);
+    auto pending = std::make_shared<String>();
+    auto response = request->beginChunkedResponse(F("text/csv"), [line, pending](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        size_t len = 0;
+        while(len < maxLen) {
+            if (pending->length() == 0) {
+                PrintString str;
+                if (!getInstance()._recorder.printTraceLine(str, (*line)++)) {
+                    break;
+                }
+                *pending = std::move(str);
+            }
+            size_t size = std::min<size_t>(maxLen - len, pending->length());
+            memcpy(buffer + len, pending->c_str(), size);
+            pending->remove(0, size);
+            len += size;
+        }
+        return len;
+    });
+    HttpHeaders headers;
+    headers.addNoCache(true);
+    headers.setResponseHeaders(response);
+    request->send(response);
 }
 
 void BlindsControlPlugin::reconfigure(const String &source)
@@ -101,6 +139,12 @@ void BlindsControlPlugin::getStatus(Print &output)
             channelConfig.current_limit_mA,
             channelConfig.current_avg_period_us / 1000.0
         );
+        auto &open = _recorder.getSignature(*channel, true);
+        auto &close = _recorder.getSignature(*channel, false);
+        auto position = _recorder.getPosition(*channel);
+        if (open.isValid() || close.isValid() || position != -1) {
+            output.printf_P(PSTR("Learned travel time open/close %ums / %ums, estimated position %d%%" HTML_S(br)), open.travelTime, close.travelTime, position);
+        }
     }
 }
 
@@ -153,7 +197,7 @@ BlindsControlPlugin &BlindsControlPlugin::getInstance()
 
 #include "at_mode.h"
 
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(BCME, "BCME", "<open|close|stop|tone|imperial|init>[,<channel>][,<tone_frequency>,<tone_pwm_value>]", "Open, close a channel, stop motor or run tone test, play imperial march, init. state");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(BCME, "BCME", "<open|close|stop|tone|imperial|init|trace|signature>[,<channel>][,<tone_frequency>,<tone_pwm_value>]", "Open, close a channel, stop motor or run tone test, play imperial march, init. state, display the motor current traces or the learned signatures (signature,clear to reset)");
 
 #if AT_MODE_HELP_SUPPORTED
 
@@ -172,7 +216,7 @@ bool BlindsControlPlugin::atModeHandler(AtModeArgs &args)
 {
     if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(BCME))) {
         if (args.requireArgs(1, 8)) {
-            auto cmds = PSTR("open|close|stop|tone|imperial|init");
+            auto cmds = PSTR("open|close|stop|tone|imperial|init|trace|signature");
             int cmd = stringlist_find_P_P(cmds, args.get(0), '|');
             int channel = args.toIntMinMax(1, 0, 1, 0);
             switch(cmd) {
@@ -254,6 +298,16 @@ bool BlindsControlPlugin::atModeHandler(AtModeArgs &args)
                         _saveState();
                     }
                     break;
+                case 6:
+                    _recorder.printTraces(args.getStream());
+                    break;
+                case 7:
+                    if (args.equalsIgnoreCase(1, F("clear"))) {
+                        _recorder.clearSignatures();
+                        args.print(F("signatures cleared"));
+                    }
+                    _recorder.dump(args.getStream());
+                    break;
                 default:
                     _stop();
                     args.printf_P(PSTR("motor stopped"));
@@ -44,6 +44,11 @@ public:
 public:
     static void loopMethod();
 
+private:
+    static void _sendTraces(AsyncWebServerRequest *request);
+
+public:
+
     static BlindsControlPlugin &getInstance();
 };
 
@@ -0,0 +1,257 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <kfc_fw_config.h>
+#include <algorithm>
+#include "blinds_recorder.h"
+
+#if DEBUG_IOT_BLINDS_CTRL
+#    include <debug_helper_enable.h>
+#else
+#    include <debug_helper_disable.h>
+#endif
+
+#define BLINDS_SIGNATURE_FILE "/.pvt/blinds_signature"
+
+void BlindsCurrentRecorder::Trace::add(float value)
+{
+    if (count >= kMaxSamples) {
+        // keep the entire move with half the resolution
+        for(uint16_t i = 0; i < kMaxSamples / 2; i++) {
+            samples[i] = (samples[i * 2] + samples[i * 2 + 1] + 1) / 2;
+        }
+        count = kMaxSamples / 2;
+        interval *= 2;
+    }
+    samples[count++] = std::clamp<int>(value / 4, 0, 255);
+}
+
+BlindsCurrentRecorder::BlindsCurrentRecorder() :
+    _active(nullptr),
+    _next(0),
+    _start(0),
+    _nextSample(0),
+    _startPosition(-1),
+    _loaded(false)
+{
+    _position.fill(-1);
+}
+
+void BlindsCurrentRecorder::begin(uint8_t channel, bool open, int8_t position)
+{
+    _loadSignatures();
+    end(EndType::STOPPED);
+    if (_position[channel] == -1) {
+        _position[channel] = position;
+    }
+    _startPosition = _position[channel];
+    if (!_traces) {
+        _traces.reset(new Trace[kTraceCount]());
+        if (!_traces) {
+            __LDBG_printf("memory allocation failed");
+            return;
+        }
+    }
+    _active = &_traces[_next];
+    _next = (_next + 1) % kTraceCount;
+    _active->duration = 0;
+    _active->interval = kSampleInterval;
+    _active->count = 0;
+    _active->channel = channel;
+    _active->open = open;
+    _active->end = EndType::NONE;
+    _start = millis();
+    _nextSample = _start;
+}
+
+void BlindsCurrentRecorder::add(float value)
+{
+    if (!_active) {
+        return;
+    }
+    auto now = millis();
+    if (static_cast<int32_t>(now - _nextSample) < 0) {
+        return;
+    }
+    _active->add(value);
+    _nextSample = now + _active->interval;
+}
+
+void BlindsCurrentRecorder::end(EndType type)
+{
+    if (!_active) {
+        return;
+    }
+    auto &trace = *_active;
+    trace.duration = millis() - _start;
+    trace.end = type;
+    auto &signature = _getSignature();
+    switch(type) {
+        case EndType::CURRENT_LIMIT:
+            // learn from full moves only
+            if (_startPosition == (trace.open ? 0 : 100)) {
+                _learn(trace);
+            }
+            // fallthrough
+        case EndType::PREDICTED:
+        case EndType::TIMEOUT:
+            _position[trace.channel] = trace.open ? 100 : 0;
+            break;
+        default:
+            if (signature.travelTime && _startPosition != -1) {
+                int32_t moved = (trace.duration * 100) / signature.travelTime;
+                _position[trace.channel] = std::clamp<int32_t>(_startPosition + (trace.open ? moved : -moved), 0, 100);
+            }
+            else {
+                _position[trace.channel] = -1;
+            }
+            break;
+    }
+    __LDBG_printf("channel=%u open=%u end=%u duration=%u samples=%u interval=%u position=%d", trace.channel, trace.open, type, trace.duration, trace.count, trace.interval, _position[trace.channel]);
+    _active = nullptr;
+}
+
+bool BlindsCurrentRecorder::isEndStopPredicted(float value, float limit) const
+{
+    #if IOT_BLINDS_CTRL_PREDICT_END_STOP
+        if (!_active) {
+            return false;
+        }
+        auto &signature = _signatures[_active->channel][_active->open];
+        if (!signature.isValid() || signature.current >= limit) {
+            return false;
+        }
+        // the signature has been learned from full moves only
+        if (_startPosition != (_active->open ? 0 : 100)) {
+            return false;
+        }
+        if ((millis() - _start) < (signature.travelTime * kPredictTravelPercent) / 100) {
+            return false;
+        }
+        // the current rises towards the limit when the end stop has been reached
+        return value > (signature.current + limit) / 2;
+    #else
+        return false;
+    #endif
+}
+
+void BlindsCurrentRecorder::clearSignatures()
+{
+    for(auto &channel: _signatures) {
+        channel[0] = Signature();
+        channel[1] = Signature();
+    }
+    _position.fill(-1);
+    _loaded = true;
+    String filename = F(BLINDS_SIGNATURE_FILE);
+    if (KFCFS.exists(filename)) {
+        KFCFS.remove(filename);
+    }
+}
+
+bool BlindsCurrentRecorder::printTraceLine(Print &output, uint16_t line) const
+{
+    if (line == 0) {
+        output.print(F("trace,channel,direction,end,duration_ms,time_ms,current_mA\n"));
+        return true;
+    }
+    if (!_traces) {
+        return false;
+    }
+    line--;
+    // oldest trace first
+    for(uint8_t i = 0; i < kTraceCount; i++) {
+        auto &trace = _traces[(_next + i) % kTraceCount];
+        if (&trace == _active) {
+            continue;
+        }
+        if (line < trace.count) {
+            output.printf_P(PSTR("%u,%u,%s,%u,%u,%u,%u\n"), i, trace.channel, trace.open ? PSTR("open") : PSTR("close"), trace.end, trace.duration,
+                line * trace.interval, static_cast<uint32_t>(trace.samples[line] * 4 * BlindsControllerConversion::kConvertADCValueToCurrentMultiplier)
+            );
+            return true;
+        }
+        line -= trace.count;
+    }
+    return false;
+}
+
+void BlindsCurrentRecorder::printTraces(Print &output) const
+{
+    uint16_t line = 0;
+    while(printTraceLine(output, line++)) {
+    }
+}
+
+void BlindsCurrentRecorder::dump(Print &output) const
+{
+    for(uint8_t channel = 0; channel < kChannelCount; channel++) {
+        output.printf_P(PSTR("Channel %u position %d%%"), channel, _position[channel]);
+        for(uint8_t open = 0; open < 2; open++) {
+            auto &signature = _signatures[channel][open];
+            output.printf_P(PSTR(", %s travel time %ums current %umA moves %u"), open ? PSTR("open") : PSTR("close"), signature.travelTime,
+                static_cast<uint32_t>(signature.current * BlindsControllerConversion::kConvertADCValueToCurrentMultiplier), signature.count
+            );
+        }
+        output.println();
+    }
+}
+
+void BlindsCurrentRecorder::_learn(const Trace &trace)
+{
+    if (trace.count < 8) {
+        return;
+    }
+    // average current while moving, without soft start and end stop
+    uint32_t sum = 0;
+    uint16_t from = trace.count / 4;
+    uint16_t to = (trace.count * 3) / 4;
+    for(uint16_t i = from; i < to; i++) {
+        sum += trace.samples[i];
+    }
+    uint16_t current = (sum * 4) / (to - from);
+
+    auto &signature = _getSignature();
+    if (signature.count == 0) {
+        signature.travelTime = trace.duration;
+        signature.current = current;
+    }
+    else {
+        signature.travelTime = ((signature.travelTime * 3) + trace.duration) / 4;
+        signature.current = ((signature.current * 3) + current) / 4;
+    }
+    if (signature.count < 255) {
+        signature.count++;
+    }
+    _saveSignatures();
+}
+
+void BlindsCurrentRecorder::_loadSignatures()
+{
+    if (_loaded) {
+        return;
+    }
+    _loaded = true;
+    auto file = KFCFS.open(F(BLINDS_SIGNATURE_FILE), fs::FileOpenMode::read);
+    if (!file) {
+        return;
+    }
+    uint32_t magic;
+    if (file.read(reinterpret_cast<uint8_t *>(&magic), sizeof(magic)) != sizeof(magic) || magic != kMagic ||
+        file.read(reinterpret_cast<uint8_t *>(_signatures), sizeof(_signatures)) != sizeof(_signatures)
+    ) {
+        clearSignatures();
+    }
+}
+
+void BlindsCurrentRecorder::_saveSignatures()
+{
+    auto file = KFCFS.open(F(BLINDS_SIGNATURE_FILE), fs::FileOpenMode::write);
+    if (file) {
+        uint32_t magic = kMagic;
+        file.write(reinterpret_cast<const uint8_t *>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const uint8_t *>(_signatures), sizeof(_signatures));
+    }
+}
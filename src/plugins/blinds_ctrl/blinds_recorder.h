@@ -0,0 +1,120 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <array>
+#include <memory>
+#include "blinds_defines.h"
+
+// Motor current recorder
+//
+// The current of each move is stored in a ring buffer of traces. Moves that end at the end stop are used to learn
+// the signature of each channel and direction (travel time and average current while moving). The signature is
+// used to predict the end stop and to estimate the position if a move has been stopped
+
+class BlindsCurrentRecorder {
+public:
+    static constexpr uint8_t kTraceCount = IOT_BLINDS_CTRL_TRACE_COUNT;
+    static constexpr uint16_t kMaxSamples = IOT_BLINDS_CTRL_TRACE_SAMPLES;
+    static constexpr uint8_t kChannelCount = IOT_BLINDS_CTRL_CHANNEL_COUNT;
+    // initial interval between samples in milliseconds
+    static constexpr uint16_t kSampleInterval = 10;
+    // min. number of moves before the signature is used
+    static constexpr uint8_t kMinLearnedMoves = 3;
+    // the end stop is predicted after this percentage of the learned travel time
+    static constexpr uint8_t kPredictTravelPercent = 90;
+    static constexpr uint32_t kMagic = 0x53434c42; // BLCS
+
+    static_assert(kTraceCount >= 1, "IOT_BLINDS_CTRL_TRACE_COUNT must be 1 or greater");
+
+    enum class EndType : uint8_t {
+        NONE,
+        CURRENT_LIMIT,
+        PREDICTED,
+        TIMEOUT,
+        STOPPED,
+    };
+
+    struct Trace {
+        uint32_t duration;
+        uint16_t interval;
+        uint16_t count;
+        uint8_t channel;
+        uint8_t open;
+        EndType end;
+        // ADC value / 4
+        uint8_t samples[kMaxSamples];
+
+        void add(float value);
+    };
+
+    struct Signature {
+        // travel time in milliseconds
+        uint32_t travelTime;
+        // average ADC value while moving
+        uint16_t current;
+        uint8_t count;
+        uint8_t reserved;
+
+        Signature() : travelTime(0), current(0), count(0), reserved(0) {}
+
+        bool isValid() const {
+            return count >= kMinLearnedMoves;
+        }
+    };
+
+public:
+    BlindsCurrentRecorder();
+
+    // position is the last known position of the channel in percent or -1
+    void begin(uint8_t channel, bool open, int8_t position);
+    void add(float value);
+    void end(EndType type);
+
+    // returns true if the current indicates that the end stop has been reached
+    bool isEndStopPredicted(float value, float limit) const;
+
+    // estimated position in percent, 0 = closed, 100 = open or -1 if unknown
+    int8_t getPosition(uint8_t channel) const;
+    const Signature &getSignature(uint8_t channel, bool open) const;
+    void clearSignatures();
+
+    // output all traces as CSV. line 0 is the header. returns false if the line does not exist
+    bool printTraceLine(Print &output, uint16_t line) const;
+    void printTraces(Print &output) const;
+    void dump(Print &output) const;
+
+private:
+    Signature &_getSignature();
+    void _learn(const Trace &trace);
+    void _loadSignatures();
+    void _saveSignatures();
+
+    std::unique_ptr<Trace[]> _traces;
+    Trace *_active;
+    uint8_t _next;
+    uint32_t _start;
+    uint32_t _nextSample;
+    int8_t _startPosition;
+    bool _loaded;
+    std::array<int8_t, kChannelCount> _position;
+    Signature _signatures[kChannelCount][2];
+};
+
+inline int8_t BlindsCurrentRecorder::getPosition(uint8_t channel) const
+{
+    return _position[channel];
+}
+
+inline const BlindsCurrentRecorder::Signature &BlindsCurrentRecorder::getSignature(uint8_t channel, bool open) const
+{
+    return _signatures[channel][open];
+}
+
+inline BlindsCurrentRecorder::Signature &BlindsCurrentRecorder::_getSignature()
+{
+    return _signatures[_active->channel][_active->open];
+}
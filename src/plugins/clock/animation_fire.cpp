@@ -0,0 +1,110 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include "animation.h"
+#include "clock.h"
+
+#if DEBUG_IOT_CLOCK
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+using namespace Clock;
+
+// previous implementation of a single line using rand(), only used for the benchmark
+static void legacyNextFrame(uint8_t *heat, uint16_t num, uint8_t cooling, uint8_t sparking)
+{
+    for (uint16_t i = 0; i < num; i++) {
+        uint8_t cooldownValue = rand() % (((cooling * 10) / num) + 2);
+        if (cooldownValue > heat[i]) {
+            heat[i] = 0;
+        }
+        else {
+            heat[i] -= cooldownValue;
+        }
+    }
+    for(uint16_t k = num - 1; k >= 2; k--) {
+        heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 2]) / 3;
+    }
+    auto n = std::max<uint8_t>(num / 5, 2);
+    if (random(255) < sparking) {
+        uint8_t y = rand() % n;
+        heat[y] += (rand() % (255 - 160)) + 160;
+    }
+}
+
+void FireAnimation::benchmark(Print &output, uint16_t frames)
+{
+    if (!_lineCount) {
+        return;
+    }
+    std::unique_ptr<uint8_t[]> legacyHeat(new uint8_t[_lineCount * _cellCount]);
+    std::unique_ptr<DisplayBufferType> buffer(new DisplayBufferType());
+    if (!legacyHeat || !buffer) {
+        return;
+    }
+    buffer->setSize(getRows(), getCols());
+    std::fill_n(legacyHeat.get(), _lineCount * _cellCount, 0);
+
+    // previous implementation, the color is calculated and the coordinates are translated for each pixel
+    uint8_t mapping = ((_cfg.cast_enum_orientation(_cfg.orientation) == Orientation::VERTICAL ? 2 : 0) + (_cfg.invert_direction));
+    uint32_t legacyFrame = 0;
+    uint32_t legacyCopy = 0;
+    for(uint16_t frame = 0; frame < frames; frame++) {
+        auto start = micros();
+        srand(frame);
+        for(uint16_t i = 0; i < _lineCount; i++) {
+            legacyNextFrame(&legacyHeat[i * _cellCount], _cellCount, _cfg.cooling, _cfg.sparking);
+        }
+        auto copyStart = micros();
+        for(uint16_t i = 0; i < _lineCount; i++) {
+            for(uint16_t j = 0; j < _cellCount; j++) {
+                auto color = _getHeatColor(legacyHeat[i * _cellCount + j], _cfg.factor);
+                auto coords = PixelCoordinatesType(i, j);
+                switch(mapping) {
+                    case 1:
+                        coords.invertColumn(buffer->getCols());
+                        break;
+                    case 2:
+                        coords.rotate();
+                        break;
+                    case 3:
+                        coords.rotate();
+                        coords.invertRow(buffer->getRows());
+                        break;
+                    default:
+                        break;
+                }
+                buffer->setPixel(coords, color.get());
+            }
+        }
+        legacyCopy += micros() - copyStart;
+        legacyFrame += copyStart - start;
+        if (frame % 32 == 0) {
+            delay(0);
+        }
+    }
+
+    uint32_t nextFrame = 0;
+    uint32_t copy = 0;
+    for(uint16_t frame = 0; frame < frames; frame++) {
+        auto start = micros();
+        _nextFrame();
+        auto copyStart = micros();
+        _copyTo(*buffer, 0);
+        copy += micros() - copyStart;
+        nextFrame += copyStart - start;
+        if (frame % 32 == 0) {
+            delay(0);
+        }
+    }
+
+    output.printf_P(PSTR("%u frames %ux%u: previous frame=%.2fus copy=%.2fus, fixed-point frame=%.2fus copy=%.2fus\n"),
+        frames, _lineCount, _cellCount,
+        legacyFrame / static_cast<float>(frames), legacyCopy / static_cast<float>(frames),
+        nextFrame / static_cast<float>(frames), copy / static_cast<float>(frames)
+    );
+}
@@ -18,173 +18,86 @@ namespace Clock {
         using FireAnimationConfig = KFCConfigurationClasses::Plugins::ClockConfigNS::FireAnimationType;
         using Orientation = FireAnimationConfig::OrientationType;
 
-    private:
-        class Line {
+        // xorshift32, each number provides 4 random bytes
+        class Random {
         public:
-
-            Line(const Line &) = delete;
-            Line &operator==(const Line &) = delete;
-
-            Line(Line &&move) :
-                _num(std::exchange(move._num, 0)),
-                _heat(std::exchange(move._heat, nullptr))
-            {
-            }
-
-            Line &operator==(Line &&move)
+            Random(uint32_t seed = kDefaultSeed) : _state(seed ? seed : kDefaultSeed)
             {
-                _heat = std::exchange(move._heat, nullptr);
-                _num = std::exchange(move._num, 0);
-                return *this;
             }
 
-            Line() : _num(0), _heat(nullptr)
+            void seed(uint32_t seed)
             {
+                _state = seed ? seed : kDefaultSeed;
             }
 
-            Line(CoordinateType num, uint8_t *heat) : _num(num), _heat(heat)
-            {
-                if (!_heat) {
-                    _num = 0;
-                }
-            }
-
-            void init(uint8_t *buffer, CoordinateType num)
+            uint32_t next()
             {
-                _heat = buffer;
-                _num = num;
-                std::fill_n(_heat, _num, 0);
+                _state ^= _state << 13;
+                _state ^= _state >> 17;
+                _state ^= _state << 5;
+                return _state;
             }
 
-            void cooldown(uint8_t cooling)
+            // scale a random byte to 0 - (range - 1)
+            static uint16_t scale(uint8_t value, uint16_t range)
             {
-                // Step 1.  Cool down every cell a little
-                for (uint16_t i = 0; i < _num; i++) {
-                    uint8_t cooldownValue = rand() % (((cooling * 10) / _num) + 2);
-                    if (cooldownValue > _heat[i]) {
-                        _heat[i] = 0;
-                    }
-                    else {
-                        _heat[i] -= cooldownValue;
-                    }
-                }
-            }
-
-            void heatup()
-            {
-                // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-                for(uint16_t k = _num - 1; k >= 2; k--) {
-                    _heat[k] = (_heat[k - 1] + _heat[k - 2] + _heat[k - 2]) / 3;
-                }
-            }
-
-            void ignite(uint8_t sparking)
-            {
-                // Step 3.  Randomly ignite new 'sparks' near the bottom
-                auto n = std::max<uint8_t>(_num / 5, 2);
-                if (random(255) < sparking) {
-                    uint8_t y = rand() % n;
-                    _heat[y] += (rand() % (255 - 160)) + 160;
-                    //heat[y] = random(160, 255);
-                }
-            }
-
-            uint16_t getNum() const
-            {
-                return _num;
-            }
-
-            Color getHeatColor(uint16_t num, ColorType factor)
-            {
-                if (num >= _num) {
-                    return 0U;
-                }
-                // Step 4.  Convert heat to LED colors
-
-                // Scale 'heat' down from 0-255 to 0-191
-                uint8_t t192 = _heat[num] * (uint16_t)191 / 255;
-                // uint8_t t192 = round((_heat[num] / 255.0) * 191);
-
-                // calculate ramp up from
-                uint8_t heatramp = t192 & 0x3F; // 0..63
-                heatramp <<= 2; // scale up to 0..252
-
-                // figure out which third of the spectrum we're in:
-                uint32_t col;
-                if (t192 > 0x80) {                     // hottest
-                    col = Color(255, 255, heatramp);
-                }
-                else if (t192 > 0x40) {             // middle
-                    col = Color(255, heatramp, 0);
-                }
-                else {
-                    col = Color(heatramp, 0, 0);
-                }
-                if (factor) {
-                    col =
-                        (blend8(col >> 16, 0xff, factor >> 16) << 16) |
-                        (blend8(col >> 8, 0xff, factor >> 8) << 8) |
-                        (blend8(col, 0xff, factor));
-                }
-                return col;
+                return (value * static_cast<uint32_t>(range)) >> 8;
             }
 
         private:
-            CoordinateType _num;
-            uint8_t *_heat;
+            static constexpr uint32_t kDefaultSeed = 2463534242U;
+
+            uint32_t _state;
         };
 
     public:
         FireAnimation(ClockPlugin &clock, FireAnimationConfig &cfg) :
             Animation(clock),
             _lineCount((cfg.cast_enum_orientation(cfg.orientation) == Orientation::VERTICAL) ? getCols() : getRows()), // rows
-            _lines(new Line[_lineCount + 1]),
-            _lineBuffer(new uint8_t[getNumPixels() + 1]),
+            _cellCount((cfg.cast_enum_orientation(cfg.orientation) == Orientation::VERTICAL) ? getRows() : getCols()), // columns
+            _heat(new uint8_t[getNumPixels() + 1]),
+            _palette(new CRGB[256]),
+            _paletteFactor(0),
             _cfg(cfg)
         {
             _disableBlinkColon = false;
-            if (!_lines || !_lineBuffer) {
+            if (!_heat || !_palette) {
                 _lineCount = 0;
+                _cellCount = 0;
             }
             else {
-                auto cols = (_cfg.cast_enum_orientation(_cfg.orientation) == Orientation::VERTICAL) ? getRows() : getCols(); // columns
-                for(uint16_t i = 0; i < _lineCount; i++) {
-                    _lines[i].init(&_lineBuffer[i * cols], cols);
-                }
+                std::fill_n(_heat, _lineCount * _cellCount, 0);
+                _updatePalette();
             }
         }
 
         ~FireAnimation() {
             __LDBG_printf("end lines=%u", _lineCount);
-            if (_lines) {
-                delete[] _lines;
-                _lines = nullptr;
+            if (_heat) {
+                delete[] _heat;
+                _heat = nullptr;
             }
-            if (_lineBuffer) {
-                delete[] _lineBuffer;
-                _lineBuffer = nullptr;
+            if (_palette) {
+                delete[] _palette;
+                _palette = nullptr;
             }
             _lineCount = 0;
+            _cellCount = 0;
         }
 
         virtual void begin() override
         {
             _loopTimer = millis();
             _updateRate = std::max<uint16_t>(5, _cfg.speed);
-            __LDBG_printf("begin lines=%u update_rate=%u", _lineCount, _updateRate);
+            _random.seed(micros());
+            __LDBG_printf("begin lines=%u cells=%u update_rate=%u", _lineCount, _cellCount, _updateRate);
         }
 
         virtual void loop(uint32_t millisValue) override
         {
             if (get_time_since(_loopTimer, millisValue) >= _updateRate) {
                 _loopTimer = millisValue;
-                // update all lines
-                srand(millisValue);
-                for(uint16_t i = 0; i < _lineCount; i++) {
-                    _lines[i].cooldown(_cfg.cooling);
-                    _lines[i].heatup();
-                    _lines[i].ignite(_cfg.sparking);
-                }
+                _nextFrame();
             }
         }
 
@@ -198,40 +111,125 @@ namespace Clock {
             _copyTo(buffer, millisValue);
         }
 
+        // compare the frame time with the previous implementation
+        void benchmark(Print &output, uint16_t frames);
+
         template<typename _Ta>
         void _copyTo(_Ta &output, uint32_t millisValue)
         {
-            uint8_t mapping = ((_cfg.cast_enum_orientation(_cfg.orientation) == Orientation::VERTICAL ? 2 : 0) + (_cfg.invert_direction));
-            for(uint16_t i = 0; i < _lineCount; i++) {
-                auto &line = _lines[i];
-                for(uint16_t j = 0; j < line.getNum(); j++) {
-                    auto color = line.getHeatColor(j, _cfg.factor);
-                    auto coords = PixelCoordinatesType(i, j);
-                    switch(mapping) {
-                        case 1:
-                            coords.invertColumn(output.getCols());
-                            break;
-                        case 2:
-                            coords.rotate();
-                            break;
-                        case 3:
-                            coords.rotate();
-                            coords.invertRow(output.getRows());
-                            break;
-                        default:
-                            break;
+            if (!_lineCount) {
+                return;
+            }
+            if (_paletteFactor != _cfg.factor) {
+                _updatePalette();
+            }
+            // the heat is mapped to the color through the palette and written into the buffer of the output, the
+            // orientation selects the loop instead of translating the coordinates of each pixel
+            auto heat = _heat;
+            auto invert = _cfg.invert_direction;
+            if (_cfg.cast_enum_orientation(_cfg.orientation) == Orientation::VERTICAL) {
+                for(CoordinateType col = 0; col < _lineCount; col++) {
+                    for(CoordinateType j = 0; j < _cellCount; j++) {
+                        output[output.getAddress(invert ? (output.getRows() - 1) - j : j, col)] = _palette[*heat++];
                     }
-                    output.setPixel(coords, color.get());
                 }
             }
+            else {
+                for(CoordinateType row = 0; row < _lineCount; row++) {
+                    for(CoordinateType j = 0; j < _cellCount; j++) {
+                        output[output.getAddress(row, invert ? (output.getCols() - 1) - j : j)] = _palette[*heat++];
+                    }
+                }
+            }
+        }
+
+    private:
+        void _nextFrame()
+        {
+            if (!_lineCount) {
+                return;
+            }
+            // Step 1.  Cool down every cell a little
+            // all lines are stored in a single buffer and processed at once, each random number cools 4 cells
+            uint16_t range = ((_cfg.cooling * 10) / _cellCount) + 2;
+            auto heat = _heat;
+            auto end = _heat + (_lineCount * _cellCount);
+            while(heat < end) {
+                auto rnd = _random.next();
+                for(uint8_t n = 0; n < 4 && heat < end; n++, rnd >>= 8) {
+                    auto value = Random::scale(rnd, range);
+                    *heat = (value >= *heat) ? 0 : *heat - value;
+                    heat++;
+                }
+            }
+
+            auto sparks = std::max<uint8_t>(_cellCount / 5, 2);
+            for(heat = _heat; heat < end; heat += _cellCount) {
+                // Step 2.  Heat from each cell drifts 'up' and diffuses a little
+                // (a + 2b) / 3 in fixed-point, 21846 / 65536 is exact for the sum of 3 bytes
+                for(uint16_t k = _cellCount - 1; k >= 2; k--) {
+                    heat[k] = ((heat[k - 1] + heat[k - 2] + heat[k - 2]) * 21846U) >> 16;
+                }
+
+                // Step 3.  Randomly ignite new 'sparks' near the bottom
+                auto rnd = _random.next();
+                if ((rnd & 0xff) < _cfg.sparking) {
+                    auto &cell = heat[Random::scale(rnd >> 8, sparks)];
+                    cell = qadd8(cell, Random::scale(rnd >> 16, 255 - 160) + 160);
+                }
+            }
+        }
+
+        void _updatePalette()
+        {
+            _paletteFactor = _cfg.factor;
+            for(uint16_t i = 0; i < 256; i++) {
+                _palette[i] = _getHeatColor(i, _paletteFactor);
+            }
+        }
+
+        static Color _getHeatColor(uint8_t heat, ColorType factor)
+        {
+            // Step 4.  Convert heat to LED colors
+
+            // Scale 'heat' down from 0-255 to 0-191
+            uint8_t t192 = heat * (uint16_t)191 / 255;
+
+            // calculate ramp up from
+            uint8_t heatramp = t192 & 0x3F; // 0..63
+            heatramp <<= 2; // scale up to 0..252
+
+            // figure out which third of the spectrum we're in:
+            uint32_t col;
+            if (t192 > 0x80) {                     // hottest
+                col = Color(255, 255, heatramp);
+            }
+            else if (t192 > 0x40) {             // middle
+                col = Color(255, heatramp, 0);
+            }
+            else {
+                col = Color(heatramp, 0, 0);
+            }
+            if (factor) {
+                col =
+                    (blend8(col >> 16, 0xff, factor >> 16) << 16) |
+                    (blend8(col >> 8, 0xff, factor >> 8) << 8) |
+                    (blend8(col, 0xff, factor));
+            }
+            return col;
         }
 
     private:
         uint32_t _loopTimer;
         uint16_t _updateRate;
         uint16_t _lineCount;
-        Line *_lines;
-        uint8_t *_lineBuffer;
+        uint16_t _cellCount;
+        // heat of all cells, line by line
+        uint8_t *_heat;
+        // color of each heat value
+        CRGB *_palette;
+        ColorType _paletteFactor;
+        Random _random;
         FireAnimationConfig &_cfg;
     };
 
@@ -14,6 +14,7 @@
 #include "clock.h"
 #include "web_server.h"
 #include "blink_led_timer.h"
+#include "loop_budget.h"
 #include "../src/plugins/plugins.h"
 #include "../src/plugins/sensor/sensor.h"
 #include "../src/plugins/mqtt/mqtt_json.h"
@@ -1090,6 +1091,7 @@ void IRAM_ATTR ClockPlugin::_loop()
         }
     }
 
+    auto start = micros();
     if (_animation) {
         _animation->loop(options.getMillis());
     }
@@ -1100,26 +1102,29 @@ void IRAM_ATTR ClockPlugin::_loop()
     if (options.doUpdate()) {
         _loopDoUpdate(options);
     }
+    auto showStart = micros();
+    LoopBudget::addTime(LoopBudget::ConsumerType::ANIMATION, showStart - start);
 
     _display_show();
 
+    auto end = micros();
+    LoopBudget::addTime(LoopBudget::ConsumerType::LED_SHOW, end - showStart);
+
     #if ESP8266 && HAVE_ESP_ASYNC_WEBSERVER_COUNTERS
-        if (WebServer::Plugin::getRunningRequests() || WebServer::Plugin::getRunningResponses()) {
-            // give system time to process the requests
-            // if the cpu is overloaded, the animation will get very choppy and the web server will be slow
-            uint32_t count = WebServer::Plugin::getRunningRequestsAndResponses();
-            delay(count > 2 ? 50 : count > 1 ? 25 : 5);
-
-            #if DEBUG_IOT_CLOCK
-                static uint32_t lastValue = 0;
-                uint32_t currentValue;
-                if ((currentValue = WebServer::Plugin::getRunningRequestsAndResponsesUint32()) != lastValue) {
-                    lastValue = currentValue;
-                    __DBG_printf("requests=%u responses=%u sum=%u _fps=%.1f fps=%u", WebServer::Plugin::getRunningRequests(), WebServer::Plugin::getRunningResponses(), count, _fps, FastLED.getFPS());
-                }
-            #endif
-        }
+        // give the system time to process the requests depending on the measured costs of the animation
+        // if the cpu is overloaded, the animation will get choppy and the web server will be slow
+        LoopBudget::setDemand(LoopBudget::ConsumerType::WEB_SERVER, WebServer::Plugin::getRunningRequestsAndResponses());
+
+        #if DEBUG_IOT_CLOCK
+            static uint32_t lastValue = 0;
+            uint32_t currentValue;
+            if ((currentValue = WebServer::Plugin::getRunningRequestsAndResponsesUint32()) != lastValue) {
+                lastValue = currentValue;
+                __DBG_printf("requests=%u responses=%u yield=%uus _fps=%.1f fps=%u", WebServer::Plugin::getRunningRequests(), WebServer::Plugin::getRunningResponses(), LoopBudget::getYieldTime(LoopBudget::ConsumerType::ANIMATION, end - start), _fps, FastLED.getFPS());
+            }
+        #endif
     #endif
+    LoopBudget::yieldToOthers(LoopBudget::ConsumerType::ANIMATION, end - start);
 }
 
 // use O3 for the show function on ESP8266 and keep all code in IRAM since it is called very frequently
@@ -9,6 +9,7 @@
 #include "../src/plugins/plugins.h"
 #include "animation.h"
 #include "clock.h"
+#include "loop_budget.h"
 
 #if DEBUG_IOT_CLOCK
 #include <debug_helper_enable.h>
@@ -287,6 +288,21 @@ bool ClockPlugin::atModeHandler(AtModeArgs &args)
             }
             args.printf_P(PSTR("set color %s"), getColor().toString().c_str());
         }
+        // cpu[,<reset>]
+        // display CPU share of the animation, LED show, web server and MQTT
+        else if (args.startsWithIgnoreCase(0, F("cpu"))) {
+            LoopBudget::printReport(args.getStream());
+            if (args.startsWithIgnoreCase(1, F("res"))) {
+                LoopBudget::reset();
+                args.print(F("statistics reset"));
+            }
+        }
+        // fire[,<frames>]
+        // compare the frame time of the fire animation with the previous implementation
+        else if (args.equalsIgnoreCase(0, F("fire"))) {
+            auto frames = args.toIntMinMax<uint16_t>(1, 1, 10000, 500);
+            Clock::FireAnimation(*this, _config.fire).benchmark(args.getStream(), frames);
+        }
         // met[hod][,<fastled|neoex|neo|none|toggle>]
         // +lmc=method,tog
         else if (args.startsWithIgnoreCase(0, F("met"))) {
@@ -461,6 +461,15 @@ void FileManagerWebHandler::handleRequest(AsyncWebServerRequest *request)
     // request->url() starts with _uri
     auto uri = request->url().c_str() + strlen_P(RFPSTR(_uri));
     __LDBG_printf("file manager %s (%s)", uri, request->url().c_str());
+    #if WEBSERVER_ADMISSION_CONTROL
+        // reserve memory for the directory listing
+        WebServer::Admission::Scope admission;
+        if (!strcmp_P(uri, PSTR("list")) && !admission.admit(request, WebServer::Admission::ResponseType::DIR_LISTING, [this](AsyncWebServerRequest *request) {
+            handleRequest(request);
+        })) {
+            return;
+        }
+    #endif
     FileManager fm(request, WebServer::Plugin::getInstance().isAuthenticated(request) == true, uri);
     fm.handleRequest();
 }
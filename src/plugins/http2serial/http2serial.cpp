@@ -137,7 +137,7 @@ public:
 
     virtual void createMenu() override {
         bootstrapMenu.addMenuItem(FSPGM(Serial_Console), FSPGM(serial_console_html), navMenu.util);
-        bootstrapMenu.addMenuItem(FSPGM(Serial_Console), FSPGM(serial_console_html), navMenu.home, bootstrapMenu.findMenuByURI(FSPGM(password_html), navMenu.home)->getId());
+        bootstrapMenu.addMenuItem(FSPGM(Serial_Console), FSPGM(serial_console_html), navMenu.home, bootstrapMenu.findMenuByURI(FSPGM(password_html), navMenu.home));
     }
 
     #if AT_MODE_SUPPORTED
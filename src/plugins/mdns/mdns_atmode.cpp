@@ -9,6 +9,7 @@
 #include <EventScheduler.h>
 #include <Mutex.h>
 #include "mdns_plugin.h"
+#include "zeroconf_cache.h"
 #include "at_mode.h"
 
 using namespace KFCJson;
@@ -22,7 +23,7 @@ using namespace KFCJson;
 using KFCConfigurationClasses::System;
 
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(MDNSQ, "MDNSQ", "<service>,<proto>,[<wait=3000ms>]", "Query MDNS");
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(MDNSR, "MDNSR", "<stop|start|enable|disable|zeroconf>", "Configure MDNS");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(MDNSR, "MDNSR", "<stop|start|enable|disable|zeroconf|cache[,clear]>", "Configure MDNS");
 
 #if AT_MODE_HELP_SUPPORTED
 
@@ -263,10 +264,11 @@ bool MDNSPlugin::atModeHandler(AtModeArgs &args)
             ENABLE,
             DISABLE,
             ZEROCONF,
+            CACHE,
         };
 
         if (args.requireArgs(1)) {
-            auto action = static_cast<MDNSCommand>(stringlist_find_P_P(PSTR("stop|start|enable|disable|zeroconf"), args.get(0), '|'));
+            auto action = static_cast<MDNSCommand>(stringlist_find_P_P(PSTR("stop|start|enable|disable|zeroconf|cache"), args.get(0), '|'));
             switch(action) {
                 case MDNSCommand::STOP: {
                         args.print(F("Stopping MDNS"));
@@ -307,6 +309,15 @@ bool MDNSPlugin::atModeHandler(AtModeArgs &args)
                         }
                     }
                     break;
+                case MDNSCommand::CACHE:
+                    if (args.equalsIgnoreCase(1, F("clear"))) {
+                        MDNSResolver::ZeroConfCache::clear();
+                        args.print(F("ZeroConf cache cleared"));
+                    }
+                    else {
+                        MDNSResolver::ZeroConfCache::dump(args.getStream());
+                    }
+                    break;
                 default:
                     args.printf_P(PSTR("Invalid argument: %s"), args.get(0));
                     break;
@@ -0,0 +1,156 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#if MDNS_PLUGIN
+
+#include <Arduino_compat.h>
+#include <kfc_fw_config.h>
+#include "RTCMemoryManager.h"
+#include "zeroconf_cache.h"
+
+#if DEBUG_MDNS_SD
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+#define ZEROCONF_CACHE_FILE "/.pvt/zeroconf.cache"
+
+using namespace MDNSResolver;
+
+ZeroConfCache::Data ZeroConfCache::_data;
+ZeroConfCache::Stats ZeroConfCache::_stats;
+bool ZeroConfCache::_loaded = false;
+
+uint32_t ZeroConfCache::getKey(const String &zeroconf, uint16_t port)
+{
+    // 0 marks unused entries
+    auto key = crc32(zeroconf.c_str(), zeroconf.length()) ^ port;
+    return key ? key : 1;
+}
+
+bool ZeroConfCache::find(uint32_t key, Entry &entry)
+{
+    _load();
+    auto ptr = _find(key);
+    if (!ptr) {
+        _stats.misses++;
+        return false;
+    }
+    #if ZEROCONF_CACHE_TTL
+        // if the time is not valid yet, the entry is used and validated by the query
+        auto now = time(nullptr);
+        if (ptr->time && isTimeValid(now) && (static_cast<uint32_t>(now) - ptr->time) > ZEROCONF_CACHE_TTL) {
+            __LDBG_printf("expired key=%08x time=%u", key, ptr->time);
+            _stats.expired++;
+            _stats.misses++;
+            return false;
+        }
+    #endif
+    _stats.hits++;
+    entry = *ptr;
+    return true;
+}
+
+bool ZeroConfCache::update(uint32_t key, const IPAddress &address, uint16_t port)
+{
+    _load();
+    auto now = time(nullptr);
+    uint32_t timestamp = isTimeValid(now) ? now : 0;
+    bool changed = false;
+    auto entry = _find(key);
+    if (!entry) {
+        // use an unused entry or replace the oldest one
+        entry = std::min_element(std::begin(_data.entries), std::end(_data.entries), [](const Entry &a, const Entry &b) {
+            return (a.key != 0) < (b.key != 0) || ((a.key != 0) == (b.key != 0) && a.time < b.time);
+        });
+        *entry = Entry();
+        entry->key = key;
+        changed = true;
+    }
+    else if (entry->address != static_cast<uint32_t>(address) || entry->port != port) {
+        _stats.changed++;
+        changed = true;
+    }
+    entry->address = address;
+    entry->port = port;
+    entry->time = timestamp;
+
+    // avoid writing the file if only the time has been updated
+    bool writeFile = changed || (timestamp && (timestamp - entry->fileTime) > (ZEROCONF_CACHE_TTL / 2));
+    if (writeFile) {
+        entry->fileTime = timestamp;
+    }
+    __LDBG_printf("key=%08x address=%s port=%u changed=%u write_file=%u", key, address.toString().c_str(), port, changed, writeFile);
+    _save(writeFile);
+    return changed;
+}
+
+void ZeroConfCache::clear()
+{
+    _data = Data();
+    _data.magic = kMagic;
+    _loaded = true;
+    RTCMemoryManager::remove(RTCMemoryManager::RTCMemoryId::ZEROCONF);
+    String filename = F(ZEROCONF_CACHE_FILE);
+    if (KFCFS.exists(filename)) {
+        KFCFS.remove(filename);
+    }
+}
+
+void ZeroConfCache::dump(Print &output)
+{
+    _load();
+    output.printf_P(PSTR("ZeroConf cache hits=%u misses=%u expired=%u changed=%u file_writes=%u\n"), _stats.hits, _stats.misses, _stats.expired, _stats.changed, _stats.fileWrites);
+    for(const auto &entry: _data.entries) {
+        if (entry.key) {
+            output.printf_P(PSTR("key=%08x address=%s:%u time=%u file_time=%u\n"), entry.key, IPAddress(entry.address).toString().c_str(), entry.port, entry.time, entry.fileTime);
+        }
+    }
+}
+
+void ZeroConfCache::_load()
+{
+    if (_loaded) {
+        return;
+    }
+    _loaded = true;
+    // RTC memory is the most recent copy
+    if (RTCMemoryManager::read(RTCMemoryManager::RTCMemoryId::ZEROCONF, &_data, sizeof(_data)) && _data.magic == kMagic) {
+        __LDBG_printf("loaded from RTC memory");
+        return;
+    }
+    auto file = KFCFS.open(F(ZEROCONF_CACHE_FILE), fs::FileOpenMode::read);
+    if (file && file.read(reinterpret_cast<uint8_t *>(&_data), sizeof(_data)) == sizeof(_data) && _data.magic == kMagic) {
+        __LDBG_printf("loaded from file");
+        RTCMemoryManager::write(RTCMemoryManager::RTCMemoryId::ZEROCONF, &_data, sizeof(_data));
+        return;
+    }
+    _data = Data();
+    _data.magic = kMagic;
+}
+
+void ZeroConfCache::_save(bool writeFile)
+{
+    RTCMemoryManager::write(RTCMemoryManager::RTCMemoryId::ZEROCONF, &_data, sizeof(_data));
+    if (writeFile) {
+        auto file = KFCFS.open(F(ZEROCONF_CACHE_FILE), fs::FileOpenMode::write);
+        if (file) {
+            file.write(reinterpret_cast<const uint8_t *>(&_data), sizeof(_data));
+            _stats.fileWrites++;
+        }
+    }
+}
+
+ZeroConfCache::Entry *ZeroConfCache::_find(uint32_t key)
+{
+    for(auto &entry: _data.entries) {
+        if (entry.key == key) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#if MDNS_PLUGIN
+
+#include <Arduino_compat.h>
+
+// Cache for resolved zeroconf addresses
+//
+// The entries are stored in RTC memory and in a file. Clients get the cached address immediately and the zeroconf
+// query is executed in the background. If the address or port has changed, the client gets a second callback
+
+// entries older than the TTL are not used. time in seconds
+#ifndef ZEROCONF_CACHE_TTL
+#    define ZEROCONF_CACHE_TTL (86400 * 7)
+#endif
+
+#ifndef ZEROCONF_CACHE_SIZE
+#    define ZEROCONF_CACHE_SIZE 4
+#endif
+
+namespace MDNSResolver {
+
+    class ZeroConfCache {
+    public:
+        struct Entry {
+            // crc32 of the zeroconf string and default port
+            uint32_t key;
+            uint32_t address;
+            // time of the last successful query, 0 = unknown
+            uint32_t time;
+            // time when the entry was written to the file
+            uint32_t fileTime;
+            uint16_t port;
+            uint16_t reserved;
+
+            Entry() : key(0), address(0), time(0), fileTime(0), port(0), reserved(0) {}
+        };
+
+        struct Data {
+            uint32_t magic;
+            Entry entries[ZEROCONF_CACHE_SIZE];
+        };
+
+        static constexpr uint32_t kMagic = 0x435a4331; // 1CZC
+
+        struct Stats {
+            uint32_t hits;
+            uint32_t misses;
+            uint32_t expired;
+            uint32_t changed;
+            uint32_t fileWrites;
+        };
+
+    public:
+        static uint32_t getKey(const String &zeroconf, uint16_t port);
+
+        // returns true if a valid entry has been found
+        static bool find(uint32_t key, Entry &entry);
+        // store the result of a query. returns true if the address or port has changed
+        static bool update(uint32_t key, const IPAddress &address, uint16_t port);
+        // remove all entries from RTC memory and the file
+        static void clear();
+
+        static const Stats &getStats();
+        static void dump(Print &output);
+
+    private:
+        static void _load();
+        static void _save(bool writeFile);
+        static Entry *_find(uint32_t key);
+
+        static Data _data;
+        static Stats _stats;
+        static bool _loaded;
+    };
+
+    inline const ZeroConfCache::Stats &ZeroConfCache::getStats()
+    {
+        return _stats;
+    }
+
+}
+
+#endif
@@ -17,6 +17,8 @@
 #    include <debug_helper_disable.h>
 #endif
 
+#define MQTT_AUTO_DISCOVERY_MANIFEST_FILE "/.pvt/mqtt_ad.manifest"
+
 using Plugins = KFCConfigurationClasses::PluginsType;
 using KFCConfigurationClasses::System;
 
@@ -27,7 +29,8 @@ Queue::Queue(Client &client) :
     _client(client),
     _mutexLock(_lock, false),
     _packetId(0),
-    _runFlags(RunFlags::DEFAULTS)
+    _runFlags(RunFlags::DEFAULTS),
+    _manifestVerified(0)
 {
     MQTT::Client::registerComponent(this);
 }
@@ -183,6 +186,15 @@ void Queue::runPublish(uint32_t delayMillis)
                 _callback(StatusType::STARTED);
             }
 
+            #if MQTT_AUTO_DISCOVERY_MANIFEST
+                // the broker confirmed that the auto discovery published last time is still the same
+                if (!(_runFlags & RunFlags::FORCE_UPDATE) && _isManifestValid()) {
+                    __LDBG_printf("auto discovery matches manifest digest=%08x", _client._autoDiscoveryDigest);
+                    _publishDone(StatusType::SUCCESS);
+                    return;
+                }
+            #endif
+
             // get all topics that belong to this device
             __LDBG_printf("starting CollectTopicsComponent");
             _collect.reset(new CollectTopicsComponent(&_client, std::move(_client._createAutoDiscoveryTopics())));
@@ -343,10 +355,24 @@ void Queue::_publishDone(StatusType result, uint16_t onErrorDelay)
     switch(result) {
         case StatusType::SUCCESS:
             resultStr = F("published");
-            _client.updateAutoDiscoveryTimestamps(true);
+            #if MQTT_AUTO_DISCOVERY_MANIFEST
+                {
+                    auto crcs = _entities.crc();
+                    if (!_manifestVerified) {
+                        // the retained topics have been verified or published during this run
+                        auto now = time(nullptr);
+                        _saveManifest(crcs, isTimeValid(now) ? now : 0);
+                    }
+                    _client.updateAutoDiscoveryTimestamps(true, crcs.crc32b());
+                }
+            #else
+                _client.updateAutoDiscoveryTimestamps(true);
+            #endif
             break;
         case StatusType::FAILURE:
             resultStr = F("aborted");
+            // the state of the retained topics is unknown
+            removeManifest();
             _client.updateAutoDiscoveryTimestamps(false);
             break;
         case StatusType::DEFERRED:
@@ -393,3 +419,90 @@ void Queue::_publishDone(StatusType result, uint16_t onErrorDelay)
     _client._autoDiscoveryQueue.reset(); // deletes itself, the timer and releases the lock
     return;
 }
+
+void Queue::removeManifest()
+{
+    #if MQTT_AUTO_DISCOVERY_MANIFEST
+        String filename = F(MQTT_AUTO_DISCOVERY_MANIFEST_FILE);
+        if (KFCFS.exists(filename)) {
+            KFCFS.remove(filename);
+        }
+    #endif
+}
+
+#if MQTT_AUTO_DISCOVERY_MANIFEST
+
+bool Queue::_isManifestValid()
+{
+    if (!_client._autoDiscoveryDigest) {
+        __LDBG_printf("no digest received from broker");
+        return false;
+    }
+    CrcVector manifest;
+    uint32_t verified;
+    if (!_loadManifest(manifest, verified)) {
+        __LDBG_printf("manifest missing or invalid");
+        return false;
+    }
+    #if MQTT_AUTO_DISCOVERY_MANIFEST_MAX_AGE
+        // verify the retained topics on the broker once in a while in case they have been removed by another client
+        auto now = time(nullptr);
+        if (!verified || !isTimeValid(now) || (static_cast<uint32_t>(now) - verified) > MQTT_AUTO_DISCOVERY_MANIFEST_MAX_AGE) {
+            __LDBG_printf("manifest expired verified=%u", verified);
+            return false;
+        }
+    #endif
+    if (manifest.crc32b() != _client._autoDiscoveryDigest) {
+        __LDBG_printf("digest mismatch manifest=%08x broker=%08x", manifest.crc32b(), _client._autoDiscoveryDigest);
+        return false;
+    }
+    auto currentCrcs = _entities.crc();
+    _diff = currentCrcs.difference(manifest);
+    if (!_diff.equal) {
+        __LDBG_printf("auto discovery modified add=%u modified=%u removed=%u", _diff.add, _diff.modify, _diff.remove);
+        _diff.clear();
+        return false;
+    }
+    _manifestVerified = verified;
+    return true;
+}
+
+bool Queue::_loadManifest(CrcVector &crcs, uint32_t &verified)
+{
+    auto file = KFCFS.open(F(MQTT_AUTO_DISCOVERY_MANIFEST_FILE), fs::FileOpenMode::read);
+    if (!file) {
+        return false;
+    }
+    ManifestHeader header;
+    if (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header) || header.magic != kManifestMagic) {
+        return false;
+    }
+    // the number of entities must match the size of the file before allocating any memory
+    size_t size = header.count * sizeof(*crcs.data());
+    if (file.size() != sizeof(header) + size) {
+        __LDBG_printf("invalid manifest count=%u size=%u", header.count, file.size());
+        return false;
+    }
+    crcs.resize(header.count);
+    if (file.read(reinterpret_cast<uint8_t *>(crcs.data()), size) != size) {
+        crcs.clear();
+        return false;
+    }
+    verified = header.verified;
+    return true;
+}
+
+void Queue::_saveManifest(const CrcVector &crcs, uint32_t verified)
+{
+    auto file = KFCFS.open(F(MQTT_AUTO_DISCOVERY_MANIFEST_FILE), fs::FileOpenMode::write);
+    if (!file) {
+        __LDBG_printf_E("cannot write %s", PSTR(MQTT_AUTO_DISCOVERY_MANIFEST_FILE));
+        return;
+    }
+    ManifestHeader header = { kManifestMagic, verified, static_cast<uint16_t>(crcs.size()), 0 };
+    file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const uint8_t *>(crcs.data()), crcs.size() * sizeof(*crcs.data()));
+    __LDBG_printf("manifest saved entities=%u digest=%08x verified=%u", crcs.size(), crcs.crc32b(), verified);
+}
+
+#endif
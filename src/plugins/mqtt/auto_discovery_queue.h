@@ -49,10 +49,30 @@ namespace MQTT {
                 _callback = callback;
             }
 
+            // remove the local manifest. the next run collects all retained topics from the broker
+            static void removeManifest();
+
         private:
             void _publishNextMessage();
             void _publishDone(StatusType result = StatusType::SUCCESS, uint16_t onErrorDelay = 15);
 
+            #if MQTT_AUTO_DISCOVERY_MANIFEST
+                struct ManifestHeader {
+                    uint32_t magic;
+                    // time of the last verification with the broker
+                    uint32_t verified;
+                    uint16_t count;
+                    uint16_t reserved;
+                };
+
+                static constexpr uint32_t kManifestMagic = 0x4d414431; // 1DAM
+
+                // returns true if the manifest matches the current entities and the digest of the broker
+                bool _isManifestValid();
+                static bool _loadManifest(CrcVector &crcs, uint32_t &verified);
+                static void _saveManifest(const CrcVector &crcs, uint32_t verified);
+            #endif
+
         private:
             friend Client;
 
@@ -69,6 +89,8 @@ namespace MQTT {
             MutexLock _mutexLock;
             uint16_t _packetId;
             RunFlags _runFlags;
+            // time of the last full verification, 0 = collect pass executed
+            uint32_t _manifestVerified;
         };
 
     }
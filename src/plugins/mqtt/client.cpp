@@ -12,6 +12,7 @@
 #include "mqtt_strings.h"
 #include "auto_discovery.h"
 #include "logger.h"
+#include "loop_budget.h"
 #include "templates.h"
 
 #if DEBUG_MQTT_CLIENT
@@ -81,6 +82,9 @@ namespace MQTT {
         _port(_config.getPort()),
         _lastWillTopic(formatTopic(MQTT_LAST_WILL_TOPIC)),
         _connState(ConnectionState::NONE),
+        _startTime(millis()),
+        _timeToConnect(0),
+        _zeroConfResolved(false),
         #if MQTT_AUTO_DISCOVERY
             #if IOT_REMOTE_CONTROL
                 _startAutoDiscovery(false),
@@ -108,7 +112,7 @@ namespace MQTT {
         if (config.hasZeroConf(_hostname)) {
             config.resolveZeroConf(Plugin::getPlugin().getFriendlyName(), _hostname, _port, [this](const String &hostname, const IPAddress &address, uint16_t port, const String &resolved, MDNSResolver::ResponseType type) {
                 this->_zeroConfCallback(hostname, address, port, type);
-            });
+            }, true);
         }
         else {
             _zeroConfCallback(_hostname, convertToIPAddress(_hostname), _port, MDNSResolver::ResponseType::NONE);
@@ -145,19 +149,33 @@ namespace MQTT {
             _autoDiscoveryQueue.reset();
             _autoDiscoveryRebroadcast.remove();
             _queue.clear();
+            LoopBudget::setDemand(LoopBudget::ConsumerType::MQTT, 0);
             _packetQueue.clear();
         }
     }
 
     void Client::_zeroConfCallback(const String &hostname, const IPAddress &address, uint16_t port, MDNSResolver::ResponseType type)
     {
+        // the cached address has changed
+        bool update = _zeroConfResolved;
+        _zeroConfResolved = true;
+
         _address = address;
         _hostname = hostname;
         _port = port;
-        __LDBG_printf("zeroconf address=%s hostname=%s port=%u type=%u", _address.toString().c_str(), _hostname.c_str(), _port, type);
+        __LDBG_printf("zeroconf address=%s hostname=%s port=%u type=%u update=%u", _address.toString().c_str(), _hostname.c_str(), _port, type, update);
+
+        if (update) {
+            Logger_notice(F("MQTT server address changed to %s:%u"), IPAddress_isValid(_address) ? _address.toString().c_str() : _hostname.c_str(), _port);
+            if (_connState == ConnectionState::CONNECTING || _connState == ConnectionState::CONNECTED) {
+                disconnect(true);
+            }
+        }
 
         _setupClient();
-        WiFiCallbacks::add(WiFiCallbacks::EventType::CONNECTION, MQTT::Client::handleWiFiEvents);
+        if (!update) {
+            WiFiCallbacks::add(WiFiCallbacks::EventType::CONNECTION, MQTT::Client::handleWiFiEvents);
+        }
 
         if (WiFi.isConnected()) {
             connect();
@@ -574,6 +592,9 @@ namespace MQTT {
     void MQTT::Client::onConnect(bool sessionPresent)
     {
         __LDBG_printf("session=%d conn=%s", sessionPresent, _connection());
+        if (!_timeToConnect) {
+            _timeToConnect = std::max<uint32_t>(1, millis() - _startTime);
+        }
         Logger_notice(F("Connected to MQTT server %s"), connectionDetailsString(false).c_str());
         _connState = ConnectionState::CONNECTED;
 
@@ -668,7 +689,7 @@ namespace MQTT {
 
     #if MQTT_AUTO_DISCOVERY
 
-        void MQTT::Client::updateAutoDiscoveryTimestamps(bool success)
+        void MQTT::Client::updateAutoDiscoveryTimestamps(bool success, uint32_t digest)
         {
             using namespace MQTT::Json;
 
@@ -685,10 +706,12 @@ namespace MQTT {
             else {
                 _autoDiscoveryLastFailure = now;
             }
+            _autoDiscoveryDigest = digest;
 
             auto json = UnnamedObject(
                 NamedUint32(F("last_success"), _autoDiscoveryLastSuccess),
-                NamedUint32(F("last_failure"), _autoDiscoveryLastFailure)
+                NamedUint32(F("last_failure"), _autoDiscoveryLastFailure),
+                NamedUint32(F("digest"), _autoDiscoveryDigest)
             ).toString();
             publish(_autoDiscoveryStatusTopic, true, json, QosType::AT_LEAST_ONCE);
         }
@@ -746,6 +769,11 @@ namespace MQTT {
                         _autoDiscoveryLastSuccess = time;
                     }
                 }
+                ptr = strstr_P(payload, PSTR("digest\":"));
+                if (ptr) {
+                    ptr += 8;
+                    _autoDiscoveryDigest = strtoul(ptr, nullptr, 10);
+                }
             }
         }
         else if (_lastWillTopic == topic) {
@@ -3,6 +3,8 @@
  */
 #include <Arduino_compat.h>
 #include "mqtt_client.h"
+#include "loop_budget.h"
+#include "metrics.h"
 
 #if DEBUG_MQTT_CLIENT
 #    include <debug_helper_enable.h>
@@ -10,6 +12,75 @@
 #    include <debug_helper_disable.h>
 #endif
 
+#if KFC_METRICS
+
+static int32_t getQueueSize()
+{
+    auto client = MQTT::Client::getClient();
+    return client ? client->getQueueSize() : 0;
+}
+
+METRICS_GAUGE_CALLBACK_DEF(mqttQueueSize, "kfc_mqtt_queue_size", "Messages waiting in the MQTT queue", getQueueSize);
+
+#endif
+
+MQTT::QueueVector::iterator MQTT::QueueVector::erase(iterator first, iterator last)
+{
+    for(auto iterator = first; iterator != last; ++iterator) {
+        _memoryUsage -= iterator->getMemoryUsage();
+    }
+    auto result = vector::erase(first, last);
+    if (empty()) {
+        removeTimer();
+        _memoryUsage = 0;
+    }
+    return result;
+}
+
+bool MQTT::QueueVector::add(ClientQueue &&queue, InternalIdVector &removedIds)
+{
+    auto priority = queue.getPriority();
+    #if MQTT_QUEUE_COALESCE
+        // last value wins, the older message has not been sent yet
+        auto iterator = std::find_if(begin(), end(), [&queue](const ClientQueue &item) {
+            return item.canCoalesce(queue);
+        });
+        if (iterator != end()) {
+            __LDBG_printf("coalesced topic=%s", queue.getTopic().c_str());
+            removedIds.push_back(iterator->getInternalPacketId());
+            erase(iterator, std::next(iterator));
+            _coalesced++;
+        }
+    #endif
+
+    // drop the oldest messages with the lowest priority until the new message fits
+    auto size = queue.getMemoryUsage();
+    while(_memoryUsage + size > MQTT_QUEUE_MAX_MEMORY) {
+        auto drop = end();
+        for(auto iterator = begin(); iterator != end(); ++iterator) {
+            if (iterator->getPriority() >= priority && (drop == end() || iterator->getPriority() > drop->getPriority())) {
+                drop = iterator;
+            }
+        }
+        _dropped++;
+        if (drop == end()) {
+            __LDBG_printf("dropped topic=%s size=%u memory=%u", queue.getTopic().c_str(), size, _memoryUsage);
+            return false;
+        }
+        __LDBG_printf("dropped topic=%s memory=%u", drop->getTopic().c_str(), _memoryUsage);
+        removedIds.push_back(drop->getInternalPacketId());
+        erase(drop, std::next(drop));
+    }
+
+    // keep the order within the same priority
+    auto position = std::find_if(begin(), end(), [priority](const ClientQueue &item) {
+        return item.getPriority() > priority;
+    });
+    _memoryUsage += size;
+    insert(position, std::move(queue));
+    return true;
+}
+
 uint16_t MQTT::Client::subscribe(ComponentPtr component, const String &topic, QosType qos)
 {
     MUTEX_LOCK_RECURSIVE_BLOCK(_lock) {
@@ -17,8 +88,8 @@ uint16_t MQTT::Client::subscribe(ComponentPtr component, const String &topic, Qo
         if (_queue.empty()) {
             queue = subscribeWithId(component, topic, qos);
         }
-        if (queue._addToLocalQueue()) {
-            _addQueue(QueueType::SUBSCRIBE, component, queue, topic, qos);
+        if (queue._addToLocalQueue() && !_addQueue(QueueType::SUBSCRIBE, component, queue, topic, qos)) {
+            return 0;
         }
         return queue.getInternalId();
     }
@@ -32,8 +103,8 @@ uint16_t MQTT::Client::unsubscribe(ComponentPtr component, const String &topic)
         if (_queue.empty()) {
             queue = unsubscribeWithId(component, topic);
         }
-        if (queue._addToLocalQueue()) {
-            _addQueue(QueueType::UNSUBSCRIBE, component, queue, topic, QosType::AT_LEAST_ONCE/*unsubscribe has not QoS but packets get acknowledged*/);
+        if (queue._addToLocalQueue() && !_addQueue(QueueType::UNSUBSCRIBE, component, queue, topic, QosType::AT_LEAST_ONCE/*unsubscribe has not QoS but packets get acknowledged*/)) {
+            return 0;
         }
         return queue.getInternalId();
     }
@@ -50,8 +121,8 @@ uint16_t MQTT::Client::publish(ComponentPtr component, const String &topic, bool
         if (_queue.empty()) {
             queue = publishWithId(component, topic, retain, payload, qos);
         }
-        if (queue._addToLocalQueue()) {
-            _addQueue(QueueType::PUBLISH, component, queue, topic, qos, retain, payload);
+        if (queue._addToLocalQueue() && !_addQueue(QueueType::PUBLISH, component, queue, topic, qos, retain, payload)) {
+            return 0;
         }
         return queue.getInternalId();
     }
@@ -158,20 +229,31 @@ uint16_t MQTT::Client::getNextInternalPacketId()
     return getClient()->_packetQueue.getNextPacketId();
 }
 
-void MQTT::Client::_addQueue(QueueType type, ComponentPtr component, PacketQueue &queue, const String &topic, QosType qos, bool retain, const String &payload, uint16_t timeout)
+bool MQTT::Client::_addQueue(QueueType type, ComponentPtr component, PacketQueue &queue, const String &topic, QosType qos, bool retain, const String &payload, uint16_t timeout)
 {
     __LDBG_printf("type=%u topic=%s", type, topic.c_str());
 
     if (MQTT::Client::_isMessageSizeExceeded(topic.length() + payload.length(), topic.c_str())) {
-        // queue = PacketQueue();
-        return;
+        _onErrorPacketAck(queue.getInternalId(), PacketAckType::TIMEOUT);
+        return false;
     }
 
     MUTEX_LOCK_RECURSIVE_BLOCK(_lock) {
-        _queue.emplace_back(type, component, queue.getInternalId(), topic, qos, retain, payload, millis(), timeout);
+        QueueVector::InternalIdVector removedIds;
+        auto result = _queue.add(ClientQueue(type, component, queue.getInternalId(), topic, qos, retain, payload, millis(), timeout), removedIds);
+        // report replaced and dropped messages as failed after the queue has been modified
+        for(auto internalId: removedIds) {
+            _onErrorPacketAck(internalId, PacketAckType::TIMEOUT);
+        }
+        if (!result) {
+            _onErrorPacketAck(queue.getInternalId(), PacketAckType::TIMEOUT);
+            return false;
+        }
+        LoopBudget::setDemand(LoopBudget::ConsumerType::MQTT, _queue.size());
         _packetQueue.setTimeout(queue.getInternalId(), kDefaultQueueTimeout + queue.getTimeout());
         _queueStartTimer();
     }
+    return true;
 }
 
 void MQTT::Client::_queueStartTimer()
@@ -217,7 +299,9 @@ void MQTT::Client::_packetQueueTimerCallback()
 
 void MQTT::Client::_queueTimerCallback()
 {
+    LoopBudget::Measure measure(LoopBudget::ConsumerType::MQTT);
     MUTEX_LOCK_RECURSIVE_BLOCK(_lock) {
+        LoopBudget::setDemand(LoopBudget::ConsumerType::MQTT, _queue.size());
         // process queue
         for(auto iterator = _queue.begin(); iterator != _queue.end(); ++iterator) {
             bool success;
@@ -264,6 +348,7 @@ void MQTT::Client::_queueTimerCallback()
         }
         __LDBG_print("delivery queue done");
         _queue.clear();
+        LoopBudget::setDemand(LoopBudget::ConsumerType::MQTT, 0);
     }
 }
 
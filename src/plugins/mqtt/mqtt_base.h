@@ -33,6 +33,13 @@ namespace MQTT {
         PUBLISH
     };
 
+    // messages in the local queue are sent ordered by priority
+    enum class QueuePriorityType : uint8_t {
+        CONTROL,        // subscribe and unsubscribe
+        STATE,          // retained states and command acknowledgements
+        TELEMETRY,      // events and periodic telemetry
+    };
+
     enum class PacketAckType : uint8_t {
         SUBSCRIBE,
         UNSUBSCRIBE,
@@ -33,15 +33,17 @@ namespace MQTT {
         void clear() {
             vector::clear();
             _Timer(_timer).remove();
+            _memoryUsage = 0;
         }
 
-        iterator erase(iterator first, iterator last) {
-            auto result = vector::erase(first, last);
-            if (empty()) {
-                removeTimer();
-            }
-            return result;
-        }
+        iterator erase(iterator first, iterator last);
+
+        using InternalIdVector = std::vector<uint16_t>;
+
+        // add message sorted by priority. a queued message with the same topic and retain flag is replaced
+        // the internal ids of replaced or dropped messages are appended to removedIds
+        // returns false if the message has been dropped due to the memory limit
+        bool add(ClientQueue &&queue, InternalIdVector &removedIds);
 
         // erase all elements before the iterator (begin - prev(after))
         void eraseBefore(iterator after) {
@@ -59,8 +61,24 @@ namespace MQTT {
             return _timer;
         }
 
+        size_t getMemoryUsage() const {
+            return _memoryUsage;
+        }
+
+        uint32_t getCoalescedCount() const {
+            return _coalesced;
+        }
+
+        uint32_t getDroppedCount() const {
+            return _dropped;
+        }
+
     private:
         Event::Timer _timer;
+        size_t _memoryUsage{0};
+        // statistics since boot
+        uint32_t _coalesced{0};
+        uint32_t _dropped{0};
     };
 
     class PacketQueueVector : public std::vector<PacketQueue>
@@ -172,6 +190,12 @@ namespace MQTT {
         void setInternalPacketId(uint16_t id);
         size_t getRequiredSize() const;
 
+        QueuePriorityType getPriority() const;
+        // memory used by the queued message
+        size_t getMemoryUsage() const;
+        // returns true if the message can be replaced by the newer one
+        bool canCoalesce(const ClientQueue &queue) const;
+
     private:
         ComponentPtr _component;
         String _topic;
@@ -204,6 +228,24 @@ namespace MQTT {
         return _topic.length() + _payload.length() + 64;
     }
 
+    inline QueuePriorityType ClientQueue::getPriority() const
+    {
+        if (_type != QueueType::PUBLISH) {
+            return QueuePriorityType::CONTROL;
+        }
+        return _retain ? QueuePriorityType::STATE : QueuePriorityType::TELEMETRY;
+    }
+
+    inline size_t ClientQueue::getMemoryUsage() const
+    {
+        return sizeof(ClientQueue) + _topic.length() + _payload.length();
+    }
+
+    inline bool ClientQueue::canCoalesce(const ClientQueue &queue) const
+    {
+        return _type == QueueType::PUBLISH && queue._type == QueueType::PUBLISH && _retain == queue._retain && _topic == queue._topic;
+    }
+
     inline QueueType ClientQueue::getType() const
     {
         return _type;
@@ -522,7 +564,8 @@ public:
             return formatTopic(F("/auto_discovery/state"));
         }
 
-        void updateAutoDiscoveryTimestamps(bool success);
+        // digest is the crc32b of the auto discovery manifest, 0 = unknown/invalid
+        void updateAutoDiscoveryTimestamps(bool success, uint32_t digest = 0);
 
         // once set, the time is not updated from MQTT anymore
         inline void _resetAutoDiscoveryInitialState() {
@@ -541,6 +584,8 @@ public:
         String  _autoDiscoveryStatusTopic;
         uint32_t _autoDiscoveryLastFailure{~0U};
         uint32_t _autoDiscoveryLastSuccess{~0U};
+        // digest of the last published auto discovery from the retained status topic
+        uint32_t _autoDiscoveryDigest{0};
 
 #endif
 
@@ -695,7 +740,7 @@ public:
 
         // if subscribe/unsubscribe/publish fails cause of the tcp client's buffer being full, the message is added to the local queue
         // messages are sent in order and discarded after a timeout
-        void _addQueue(QueueType type, ComponentPtr component, PacketQueue &queue, const String &topic, QosType qos, bool retain = false, const String &payload = String(), uint16_t timeout = kDefaultQueueTimeout);
+        bool _addQueue(QueueType type, ComponentPtr component, PacketQueue &queue, const String &topic, QosType qos, bool retain = false, const String &payload = String(), uint16_t timeout = kDefaultQueueTimeout);
         // start timer for the delivery queue
         void _queueStartTimer();
         // process delivery queue
@@ -733,6 +778,10 @@ public:
         TopicVector _topics;
         Buffer _buffer;
         ConnectionState _connState;
+        // time from creating the client until the first connection in milliseconds, 0 = not connected yet
+        uint32_t _startTime;
+        uint32_t _timeToConnect;
+        bool _zeroConfResolved;
         #if MQTT_AUTO_DISCOVERY
             AutoDiscovery::QueuePtr _autoDiscoveryQueue;
             Event::Timer _autoDiscoveryRebroadcast;
@@ -119,6 +119,20 @@
 #    define MQTT_QUEUE_TIMEOUT 7500
 #endif
 
+// max. memory used by messages in the local queue. if exceeded, messages with the lowest priority are dropped
+#ifndef MQTT_QUEUE_MAX_MEMORY
+#    if ESP8266
+#        define MQTT_QUEUE_MAX_MEMORY 4096
+#    else
+#        define MQTT_QUEUE_MAX_MEMORY 16384
+#    endif
+#endif
+
+// a message in the local queue is replaced by a newer message with the same topic and retain flag
+#ifndef MQTT_QUEUE_COALESCE
+#    define MQTT_QUEUE_COALESCE 1
+#endif
+
 // default timeout waiting for the acknowledgement packet
 #ifndef MQTT_DEFAULT_TIMEOUT
 #    define MQTT_DEFAULT_TIMEOUT 10000
@@ -176,3 +190,14 @@
 #ifndef MQTT_AUTO_DISCOVERY_ERROR_DELAY
 #    define MQTT_AUTO_DISCOVERY_ERROR_DELAY 5000
 #endif
+
+// store the CRCs of the published auto discovery in a local manifest. if the digest of the manifest matches
+// the one published to the retained status topic, collecting all retained auto discovery topics is skipped
+#ifndef MQTT_AUTO_DISCOVERY_MANIFEST
+#    define MQTT_AUTO_DISCOVERY_MANIFEST 1
+#endif
+
+// max. age of the manifest in seconds before a full verification with the broker is forced. 0 = no limit
+#ifndef MQTT_AUTO_DISCOVERY_MANIFEST_MAX_AGE
+#    define MQTT_AUTO_DISCOVERY_MANIFEST_MAX_AGE (86400 * 7)
+#endif
@@ -85,6 +85,15 @@ void Plugin::getStatus(Print &output)
             client->_components.size(),
             AutoDiscovery::List::size(client->_components)
         );
+        if (client->_timeToConnect) {
+            output.printf_P(PSTR("Connected %.3f seconds after start" HTML_S(br)), client->_timeToConnect / 1000.0);
+        }
+        const auto &queue = client->_queue;
+        if (queue.size() || queue.getCoalescedCount() || queue.getDroppedCount()) {
+            output.printf_P(PSTR("Queue %u messages, %u/%u bytes, %u coalesced, %u dropped" HTML_S(br)),
+                queue.size(), queue.getMemoryUsage(), MQTT_QUEUE_MAX_MEMORY, queue.getCoalescedCount(), queue.getDroppedCount()
+            );
+        }
     }
     else {
         output.print(FSPGM(Disabled));
@@ -113,7 +122,7 @@ PROGMEM_AT_MODE_HELP_COMMAND_DEF(MQTT, "MQTT", "<" COMMANDS ">", "Manage MQTT\n"
     "    dis[connect][,<true|false>]                 Disconnect from server and enable/disable auto reconnect\n"
     "    set,<enable,disable>                        Enable or disable MQTT\n"
     "    top[ics]                                    List subscribed topics\n"
-    "    auto[discovery][,restart][,force]           Publish auto discovery\n"
+    "    auto[discovery][,restart][,force][,verify]  Publish auto discovery. verify removes the local manifest\n"
     "    list[,<full|crc>]                           List auto discovery\n",
     "Display MQTT status"
 );
@@ -137,6 +146,11 @@ bool Plugin::atModeHandler(AtModeArgs &args)
         }
         else if (args.isQueryMode()) {
             args.printf_P(PSTR("status: %s"), clientPtr->connectionStatusString().c_str());
+            if (clientPtr->_timeToConnect) {
+                args.printf_P(PSTR("time to connect: %ums"), clientPtr->_timeToConnect);
+            }
+            const auto &queue = clientPtr->_queue;
+            args.printf_P(PSTR("queue: %u messages, %u/%u bytes, %u coalesced, %u dropped"), queue.size(), queue.getMemoryUsage(), MQTT_QUEUE_MAX_MEMORY, queue.getCoalescedCount(), queue.getDroppedCount());
         }
         else if (args.requireArgs(1, 3)) {
             auto &client = *clientPtr;
@@ -193,6 +207,9 @@ bool Plugin::atModeHandler(AtModeArgs &args)
                         if (args.has(F("now"))) {
                             flags |= MQTT::RunFlags::FORCE_NOW;
                         }
+                        if (args.has(F("verify"))) {
+                            MQTT::AutoDiscovery::Queue::removeManifest();
+                        }
 
                         if (!client.isConnected()) {
                             args.print(F("MQTT client not connected"));
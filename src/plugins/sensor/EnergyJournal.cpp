@@ -0,0 +1,155 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#if IOT_SENSOR_HAVE_HLW8012 || IOT_SENSOR_HAVE_HLW8032
+
+#include "Sensor_HLW80xx.h"
+
+#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT && IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+
+#if DEBUG_IOT_SENSOR
+#    include <debug_helper_enable.h>
+#else
+#    include <debug_helper_disable.h>
+#endif
+
+#if _MSC_VER
+    // defined in lib-mock/KFCBaseLibrary/src/Flash/eagle.flash.4m2m.ld.cpp
+    extern uint32_t &_ENERGY_start;
+    extern uint32_t &_ENERGY_end;
+#else
+    // weak symbols are nullptr if the linker script has no energy section, for example the 1M layout
+    extern "C" uint32_t _ENERGY_start __attribute__((weak));
+    extern "C" uint32_t _ENERGY_end __attribute__((weak));
+#endif
+
+EnergyJournal::EnergyJournal() :
+    _start(0),
+    _numSectors(0),
+    _sector(0),
+    _slot(kSlotsPerSector),
+    _sequence(0),
+    _last({}),
+    _valid(false),
+    _writes(0),
+    _erases(0),
+    _errors(0)
+{
+}
+
+bool EnergyJournal::begin()
+{
+    _valid = false;
+    _sequence = 0;
+    if (!&_ENERGY_start || !&_ENERGY_end) {
+        __LDBG_printf("no energy section in the linker script");
+        _numSectors = 0;
+        return false;
+    }
+    // _ENERGY_end is the start address of the last sector
+    _start = (uintptr_t)&_ENERGY_start - SECTION_FLASH_START_ADDRESS;
+    _numSectors = (((uintptr_t)&_ENERGY_end - (uintptr_t)&_ENERGY_start) / SPI_FLASH_SEC_SIZE) + 1;
+    if (_numSectors < 2) {
+        // the sector with the last record would be erased
+        __LDBG_printf("journal requires at least 2 sectors");
+        _numSectors = 0;
+        return false;
+    }
+
+    // the journal continues after the last valid record. if there is none, the first append erases sector 0
+    _sector = _numSectors - 1;
+    _slot = kSlotsPerSector;
+
+    auto start = micros();
+    Record record;
+    for(uint16_t sector = 0; sector < _numSectors; sector++) {
+        for(uint16_t slot = 0; slot < kSlotsPerSector; slot++) {
+            if (!_readRecord(_getAddress(sector, slot), record)) {
+                _errors++;
+                continue;
+            }
+            if (record.isBlank()) {
+                // records are written sequentially
+                break;
+            }
+            if (record.isValid() && (!_valid || static_cast<int32_t>(record.sequence - _sequence) > 0)) {
+                _valid = true;
+                _sequence = record.sequence;
+                _last = record.counters;
+                _sector = sector;
+                _slot = slot + 1;
+            }
+        }
+    }
+    __LDBG_printf("address=%08x sectors=%u valid=%u seq=%u sector=%u slot=%u time=%uus", _start, _numSectors, _valid, _sequence, _sector, _slot, micros() - start);
+    return _valid;
+}
+
+bool EnergyJournal::append(const Counters &counters)
+{
+    if (!_numSectors) {
+        return false;
+    }
+    for(uint8_t retries = 0; retries < 3; retries++) {
+        if (!_nextSlot()) {
+            return false;
+        }
+        Record record(_sequence + 1, counters);
+        auto address = _getAddress(_sector, _slot++);
+        Record verify;
+        if (ESP.flashWrite(address, reinterpret_cast<uint32_t *>(&record), sizeof(record)) && _readRecord(address, verify) && verify.isValid() && verify.sequence == record.sequence) {
+            _writes++;
+            _sequence = record.sequence;
+            _last = counters;
+            _valid = true;
+            return true;
+        }
+        // the slot is not blank anymore and will be skipped
+        _errors++;
+        __LDBG_printf("write error address=%08x", address);
+    }
+    return false;
+}
+
+bool EnergyJournal::_nextSlot()
+{
+    Record record;
+    while(_slot < kSlotsPerSector) {
+        // skip slots that have been written partially, for example during a power failure
+        if (_readRecord(_getAddress(_sector, _slot), record) && record.isBlank()) {
+            return true;
+        }
+        _slot++;
+    }
+    _sector = (_sector + 1) % _numSectors;
+    _slot = 0;
+    return _eraseSector(_sector);
+}
+
+bool EnergyJournal::_readRecord(uint32_t address, Record &record) const
+{
+    return ESP.flashRead(address, reinterpret_cast<uint32_t *>(&record), sizeof(record));
+}
+
+bool EnergyJournal::_eraseSector(uint16_t sector)
+{
+    _erases++;
+    if (!ESP.flashEraseSector((_start / SPI_FLASH_SEC_SIZE) + sector)) {
+        _errors++;
+        __LDBG_printf("erase error sector=%u", sector);
+        return false;
+    }
+    return true;
+}
+
+void EnergyJournal::dump(Print &output) const
+{
+    output.printf_P(PSTR("journal address=0x%08x sectors=%u sector=%u slot=%u/%u seq=%u writes=%u erases=%u errors=%u\n"),
+        _start, _numSectors, _sector, _slot, kSlotsPerSector, _sequence, _writes, _erases, _errors
+    );
+}
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <array>
+
+// Append only journal for the energy counters
+//
+// The records are written sequentially to a dedicated flash area (_ENERGY_start - _ENERGY_end). Once a sector
+// is full, the journal moves to the next sector and erases it. The sector with the last record is never erased.
+// After a reset, the last valid record is the one with the highest sequence number and a valid CRC
+//
+// 2 sectors with 32 byte records store 256 records until a sector is erased again. Saving every 30 seconds
+// erases each sector ~11 times a day, which is ~25 years for 100'000 erase cycles
+
+class EnergyJournal {
+public:
+    using Counters = std::array<uint64_t, IOT_SENSOR_HLW80xx_NUM_ENERGY_COUNTERS>;
+
+    static constexpr uint32_t kMagic = 0x4e454a31; // EJ1N
+    static constexpr uint32_t kBlank = ~0U;
+
+    struct Record {
+        uint32_t magic;
+        uint32_t sequence;
+        Counters counters;
+        uint32_t reserved;
+        uint32_t crc;
+
+        Record() = default;
+        Record(uint32_t _sequence, const Counters &_counters) :
+            magic(kMagic),
+            sequence(_sequence),
+            counters(_counters),
+            reserved(0),
+            crc(calcCrc())
+        {
+        }
+
+        uint32_t calcCrc() const {
+            return crc32(this, offsetof(Record, crc));
+        }
+
+        bool isValid() const {
+            return magic == kMagic && crc == calcCrc();
+        }
+
+        bool isBlank() const;
+    };
+
+    static_assert((sizeof(Record) % sizeof(uint32_t)) == 0, "flash access requires 32bit alignment");
+    static_assert(offsetof(Record, crc) + sizeof(uint32_t) == sizeof(Record), "crc must be the last member");
+
+public:
+    EnergyJournal();
+
+    // scan the journal for the last valid record
+    bool begin();
+    // false if the linker script does not provide the energy section
+    bool isAvailable() const;
+    // get the counters of the last valid record
+    bool read(Counters &counters) const;
+    // append a record. false if writing failed
+    bool append(const Counters &counters);
+
+    void dump(Print &output) const;
+
+private:
+    uint32_t _getAddress(uint16_t sector, uint16_t slot) const;
+    bool _readRecord(uint32_t address, Record &record) const;
+    bool _eraseSector(uint16_t sector);
+    // move to the next blank slot. the sector of the last record is not erased
+    bool _nextSlot();
+
+    static constexpr uint16_t kSlotsPerSector = SPI_FLASH_SEC_SIZE / sizeof(Record);
+
+private:
+    uint32_t _start;
+    uint16_t _numSectors;
+    uint16_t _sector;
+    uint16_t _slot;
+    uint32_t _sequence;
+    Counters _last;
+    bool _valid;
+    // statistics since boot
+    uint32_t _writes;
+    uint32_t _erases;
+    uint32_t _errors;
+};
+
+inline bool EnergyJournal::Record::isBlank() const
+{
+    auto ptr = reinterpret_cast<const uint32_t *>(this);
+    for(size_t i = 0; i < sizeof(*this) / sizeof(uint32_t); i++) {
+        if (ptr[i] != kBlank) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool EnergyJournal::isAvailable() const
+{
+    return _numSectors != 0;
+}
+
+inline bool EnergyJournal::read(Counters &counters) const
+{
+    if (_valid) {
+        counters = _last;
+    }
+    return _valid;
+}
+
+inline uint32_t EnergyJournal::_getAddress(uint16_t sector, uint16_t slot) const
+{
+    return _start + (sector * SPI_FLASH_SEC_SIZE) + (slot * sizeof(Record));
+}
@@ -0,0 +1,194 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <algorithm>
+#include "I2CScheduler.h"
+
+#if IOT_SENSOR_I2C_SCHEDULER
+
+#if DEBUG_IOT_SENSOR
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+// ------------------------------------------------------------------------
+// I2CScheduler::Client
+// ------------------------------------------------------------------------
+
+I2CScheduler::Client::Client(const __FlashStringHelper *name) :
+    _name(name),
+    _due(0),
+    _ready(0),
+    _interval(0),
+    _attached(false),
+    _converting(false)
+{
+}
+
+I2CScheduler::Client::~Client()
+{
+    detachScheduler();
+}
+
+void I2CScheduler::Client::attachScheduler(uint32_t intervalMillis)
+{
+    _interval = std::max<uint32_t>(1, intervalMillis);
+    _due = millis();
+    _converting = false;
+    if (!_attached) {
+        _attached = true;
+        getInstance()._add(this);
+    }
+    else {
+        getInstance()._updateTimer();
+    }
+}
+
+void I2CScheduler::Client::detachScheduler()
+{
+    if (_attached) {
+        _attached = false;
+        getInstance()._remove(this);
+    }
+}
+
+// ------------------------------------------------------------------------
+// I2CScheduler
+// ------------------------------------------------------------------------
+
+I2CScheduler::I2CScheduler() : _enabled(true), _maxBlocking(0), _ticks(0)
+{
+}
+
+I2CScheduler &I2CScheduler::getInstance()
+{
+    static I2CScheduler scheduler;
+    return scheduler;
+}
+
+void I2CScheduler::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+    for(auto client: _clients) {
+        client->_converting = false;
+        client->_due = millis();
+    }
+    _updateTimer();
+}
+
+void I2CScheduler::resetStats()
+{
+    for(auto client: _clients) {
+        client->_stats = Stats();
+    }
+    _maxBlocking = 0;
+    _ticks = 0;
+}
+
+void I2CScheduler::dump(Print &output) const
+{
+    output.printf_P(PSTR("I2C scheduler %s, clients=%u transactions=%u max. blocking=%uus\n"), _enabled ? PSTR("enabled") : PSTR("disabled"), _clients.size(), _ticks, _maxBlocking);
+    for(auto client: _clients) {
+        auto &stats = client->_stats;
+        output.printf_P(PSTR("%s: interval=%ums transactions=%u bus=%.0f/%uus blocking reads=%u time=%.0f/%uus errors=%u\n"),
+            client->_name, client->_interval,
+            stats.transactions, stats.transactions ? stats.busTime / static_cast<float>(stats.transactions) : 0.0f, stats.maxBusTime,
+            stats.reads, stats.reads ? stats.readTime / static_cast<float>(stats.reads) : 0.0f, stats.maxReadTime,
+            stats.errors
+        );
+    }
+}
+
+void I2CScheduler::_add(Client *client)
+{
+    __LDBG_printf("name=%s interval=%u", client->_name, client->_interval);
+    _clients.push_back(client);
+    _updateTimer();
+}
+
+void I2CScheduler::_remove(Client *client)
+{
+    _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end());
+    _updateTimer();
+}
+
+void I2CScheduler::_updateTimer()
+{
+    if (_clients.empty() || !_enabled) {
+        _Timer(_timer).remove();
+        return;
+    }
+    if (!_timer) {
+        _Timer(_timer).add(Event::milliseconds(1), true, [this](Event::CallbackTimerPtr timer) {
+            _timerCallback(timer);
+        });
+    }
+}
+
+void I2CScheduler::_timerCallback(Event::CallbackTimerPtr timer)
+{
+    uint32_t now = millis();
+    // conversions that are ready are collected first to keep the results fresh
+    Client *next = nullptr;
+    for(auto client: _clients) {
+        if (client->_converting && static_cast<int32_t>(now - client->_ready) >= 0) {
+            next = client;
+            break;
+        }
+    }
+    if (!next) {
+        for(auto client: _clients) {
+            if (!client->_converting && static_cast<int32_t>(now - client->_due) >= 0) {
+                next = client;
+                break;
+            }
+        }
+    }
+    if (next) {
+        _transaction(*next, now);
+    }
+
+    // sleep until the next transaction
+    now = millis();
+    int32_t delay = 0x7fffffff;
+    for(auto client: _clients) {
+        delay = std::min<int32_t>(delay, static_cast<int32_t>((client->_converting ? client->_ready : client->_due) - now));
+    }
+    timer->updateInterval(Event::milliseconds(std::max<int32_t>(1, delay)));
+}
+
+void I2CScheduler::_transaction(Client &client, uint32_t now)
+{
+    auto &stats = client._stats;
+    auto start = micros();
+    if (client._converting) {
+        client._converting = false;
+        client.collectConversion();
+    }
+    else {
+        // keep the phase if the transaction was delayed by other clients
+        client._due += client._interval;
+        if (static_cast<int32_t>(now - client._due) >= 0) {
+            client._due = now + client._interval;
+        }
+        auto conversionTime = client.beginConversion();
+        if (conversionTime == kFailed) {
+            stats.errors++;
+        }
+        else {
+            client._converting = true;
+            client._ready = now + conversionTime;
+        }
+    }
+    uint32_t time = micros() - start;
+    stats.transactions++;
+    stats.busTime += time;
+    stats.maxBusTime = std::max<uint32_t>(stats.maxBusTime, time);
+    _maxBlocking = std::max(_maxBlocking, time);
+    _ticks++;
+}
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+#include <EventScheduler.h>
+#include <vector>
+
+// I2C bus scheduler for sensors
+//
+// Sensors split the acquisition into starting the conversion and collecting the result after the conversion time. The
+// scheduler runs a single transaction per timer callback, so the conversions of all sensors on the shared bus
+// overlap and the main loop is never blocked while waiting for a conversion
+//
+// If the scheduler is disabled, the sensors fall back to blocking reads. The bus time and the time the main loop was
+// blocked are recorded for both modes
+
+#ifndef IOT_SENSOR_I2C_SCHEDULER
+#    define IOT_SENSOR_I2C_SCHEDULER 1
+#endif
+
+#if IOT_SENSOR_I2C_SCHEDULER
+
+class I2CScheduler {
+public:
+    // returned by beginConversion() if the sensor did not respond
+    static constexpr uint16_t kFailed = 0xffff;
+
+    struct Stats {
+        // split-phase transactions
+        uint32_t transactions;
+        uint32_t busTime;
+        uint32_t maxBusTime;
+        // blocking reads
+        uint32_t reads;
+        uint32_t readTime;
+        uint32_t maxReadTime;
+        uint16_t errors;
+
+        Stats() : transactions(0), busTime(0), maxBusTime(0), reads(0), readTime(0), maxReadTime(0), errors(0) {}
+    };
+
+    class Client {
+    public:
+        // measures the time of a blocking read
+        class BlockingRead {
+        public:
+            BlockingRead(Client &client) : _client(client), _start(micros()) {}
+            ~BlockingRead() {
+                _client._addBlockingRead(micros() - _start);
+            }
+
+        private:
+            Client &_client;
+            uint32_t _start;
+        };
+
+    public:
+        Client(const __FlashStringHelper *name);
+        virtual ~Client();
+
+        // start a conversion and return the conversion time in milliseconds, 0 to collect in the next transaction
+        // or kFailed
+        virtual uint16_t beginConversion() = 0;
+        // read the result of the conversion
+        virtual void collectConversion() = 0;
+
+        // add to the scheduler with an interval in milliseconds
+        void attachScheduler(uint32_t intervalMillis);
+        void detachScheduler();
+        // returns true if the values are collected by the scheduler, otherwise a blocking read must be used
+        bool isScheduled() const;
+
+        const Stats &getStats() const;
+
+    private:
+        friend I2CScheduler;
+
+        void _addBlockingRead(uint32_t time);
+
+        const __FlashStringHelper *_name;
+        uint32_t _due;
+        uint32_t _ready;
+        uint32_t _interval;
+        bool _attached;
+        bool _converting;
+        Stats _stats;
+    };
+
+public:
+    I2CScheduler();
+
+    static I2CScheduler &getInstance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void resetStats();
+    void dump(Print &output) const;
+
+private:
+    void _add(Client *client);
+    void _remove(Client *client);
+    void _updateTimer();
+    void _timerCallback(Event::CallbackTimerPtr timer);
+    void _transaction(Client &client, uint32_t now);
+
+    std::vector<Client *> _clients;
+    Event::Timer _timer;
+    bool _enabled;
+    // longest time of a single timer callback in microseconds
+    uint32_t _maxBlocking;
+    uint32_t _ticks;
+};
+
+inline const I2CScheduler::Stats &I2CScheduler::Client::getStats() const
+{
+    return _stats;
+}
+
+inline bool I2CScheduler::Client::isScheduled() const
+{
+    return _attached && getInstance().isEnabled();
+}
+
+inline void I2CScheduler::Client::_addBlockingRead(uint32_t time)
+{
+    _stats.reads++;
+    _stats.readTime += time;
+    _stats.maxReadTime = std::max(_stats.maxReadTime, time);
+}
+
+inline bool I2CScheduler::isEnabled() const
+{
+    return _enabled;
+}
+
+#endif
@@ -22,6 +22,7 @@ Sensor::Sensor(SensorType type) :
     _mqttUpdateRate(DEFAULT_MQTT_UPDATE_RATE),
     _nextUpdate(0),
     _nextMqttUpdate(0),
+    _timerDue(0),
     _orderId(_getNextOrderId()),
     _type(type)
 {
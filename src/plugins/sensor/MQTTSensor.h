@@ -47,6 +47,7 @@ class Sensor_DHTxx;
 class Sensor_DimmerMetrics;
 class Sensor_Motion;
 class Sensor_SystemMetrics;
+class SensorPlugin;
 
 namespace MQTT {
 
@@ -190,8 +191,12 @@ namespace MQTT {
         static int16_t _orderIdCounter;
 
     private:
+        friend SensorPlugin;
+
         uint32_t _nextUpdate;
         uint32_t _nextMqttUpdate;
+        // millis() when SensorPlugin calls timerEvent() next
+        uint32_t _timerDue;
         int16_t _orderId;
 
     protected:
@@ -24,6 +24,7 @@ Sensor_AmbientLight::Sensor_AmbientLight(const String &name, uint8_t id, TwoWire
     _wire(wire),
     _name(name),
     _handler(nullptr),
+    _adcConsumer(nullptr),
     _sensor({SensorType::NONE}),
     _config(Plugins::Sensor::getConfig().ambient),
     _value(-1),
@@ -188,7 +189,10 @@ void Sensor_AmbientLight::begin(AmbientLightSensorHandler *handler, const Sensor
                 #endif
             } break;
         case SensorType::INTERNAL_ADC:
-            ADCManager::getInstance().addAutoReadTimer(Event::seconds(1), Event::milliseconds(30), 24);
+            // average over 1 second
+            if (!_adcConsumer) {
+                _adcConsumer = ADCScheduler::getInstance().add(F("ambient_light"), 40, 25);
+            }
             break;
         default:
             break;
@@ -218,6 +222,10 @@ void Sensor_AmbientLight::end()
                 _wire.endTransmission();
             }
             break;
+        case SensorType::INTERNAL_ADC:
+            ADCScheduler::getInstance().remove(_adcConsumer);
+            _adcConsumer = nullptr;
+            break;
         default:
             break;
     }
@@ -235,7 +243,7 @@ void Sensor_AmbientLight::_timerCallback()
             _value = _readTinyPwmADC();
             break;
         case SensorType::INTERNAL_ADC:
-            _value = ADCManager::getInstance().readValue();
+            _value = _adcConsumer->size() ? _adcConsumer->getAverage() : ADCManager::getInstance().readValue();
             if (_sensor.adc.inverted) {
                 _value = ADCManager::kMaxADCValue - _value;
             }
@@ -10,6 +10,7 @@
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
+#include "adc_scheduler.h"
 
 #ifndef IOT_SENSOR_AMBIENT_LIGHT_RENDER_TYPE
 #define IOT_SENSOR_AMBIENT_LIGHT_RENDER_TYPE WebUINS::SensorRenderType::COLUMN
@@ -183,6 +184,7 @@ private:
     String _name;
     AmbientLightSensorHandler *_handler;
     Event::Timer _timer;
+    ADCScheduler::Consumer *_adcConsumer;
     SensorInputConfig _sensor;
     ConfigType _config;
     int32_t _value;
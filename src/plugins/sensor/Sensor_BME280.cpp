@@ -18,6 +18,9 @@
 
 Sensor_BME280::Sensor_BME280(const String &name, uint8_t address, TwoWire &wire) :
     MQTT::Sensor(MQTT::SensorType::BME280),
+    #if IOT_SENSOR_I2C_SCHEDULER
+        I2CScheduler::Client(F("BME280")),
+    #endif
     _name(name),
     _address(address),
     _wire(wire)
@@ -143,7 +146,32 @@ void Sensor_BME280::publishState()
     }
 }
 
+#if IOT_SENSOR_I2C_SCHEDULER
+
+    uint16_t Sensor_BME280::beginConversion()
+    {
+        return 0;
+    }
+
+    void Sensor_BME280::collectConversion()
+    {
+        _sensor = _readValues();
+    }
+
+#endif
+
 Sensor_BME280::SensorDataType Sensor_BME280::_readSensor()
+{
+    #if IOT_SENSOR_I2C_SCHEDULER
+        if (isScheduled()) {
+            return _sensor;
+        }
+        I2CScheduler::Client::BlockingRead measure(*this);
+    #endif
+    return _readValues();
+}
+
+Sensor_BME280::SensorDataType Sensor_BME280::_readValues()
 {
     auto sensor = SensorDataType(
         _bme280.readTemperature(),
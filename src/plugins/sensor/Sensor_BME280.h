@@ -11,6 +11,7 @@
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
+#include "I2CScheduler.h"
 #include <Adafruit_BME280.h>
 
 #ifndef IOT_SENSOR_BME280_HAVE_COMPENSATION_CALLBACK
@@ -29,14 +30,18 @@ class Sensor_CCS811;
 
 // using namespace KFCConfigurationClasses::Plugins;
 
-class Sensor_BME280 : public MQTT::Sensor {
+class Sensor_BME280 : public MQTT::Sensor
+    #if IOT_SENSOR_I2C_SCHEDULER
+        , public I2CScheduler::Client
+    #endif
+{
 public:
     struct SensorDataType {
         float temperature;  // °C
         float humidity;     // %
         float pressure;     // hPa
 
-        SensorDataType() {}
+        SensorDataType() : temperature(NAN), humidity(NAN), pressure(NAN) {}
         SensorDataType(float _temperature, float _humidity, float _pressure) : temperature(_temperature), humidity(_humidity), pressure(_pressure) {}
     };
 
@@ -64,6 +69,12 @@ public:
 
     SensorDataType readSensor();
 
+    #if IOT_SENSOR_I2C_SCHEDULER
+        // the sensor runs in normal mode and has the results of the last conversion ready
+        virtual uint16_t beginConversion() override;
+        virtual void collectConversion() override;
+    #endif
+
     #if IOT_SENSOR_BME280_HAVE_COMPENSATION_CALLBACK
         // temperature or offset to compensate temperature and humidity readings
         void setCompensationCallback(CompensationCallback callback);
@@ -77,6 +88,7 @@ private:
 
     String _getId(const __FlashStringHelper *type = nullptr);
     SensorDataType _readSensor();
+    SensorDataType _readValues();
     void _readConfig();
 
     String _name;
@@ -84,6 +96,9 @@ private:
     Adafruit_BME280 _bme280;
     TwoWire &_wire;
     SensorConfigType _cfg;
+    #if IOT_SENSOR_I2C_SCHEDULER
+        SensorDataType _sensor;
+    #endif
 };
 
 inline uint8_t Sensor_BME280::getAutoDiscoveryCount() const
@@ -114,6 +129,9 @@ inline void Sensor_BME280::setup()
 {
     _readConfig();
     _bme280.begin(_address, &_wire);
+    #if IOT_SENSOR_I2C_SCHEDULER
+        attachScheduler(_updateRate * 1000);
+    #endif
 }
 
 inline void Sensor_BME280::reconfigure(PGM_P source)
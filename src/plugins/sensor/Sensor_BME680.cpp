@@ -16,6 +16,9 @@
 
 Sensor_BME680::Sensor_BME680(const String &name, uint8_t address, TwoWire &wire) :
     MQTT::Sensor(MQTT::SensorType::BME680),
+    #if IOT_SENSOR_BME680_SPLIT_PHASE
+        I2CScheduler::Client(F("BME680")),
+    #endif
     _name(name),
     _address(address)
     #if HAVE_ADAFRUIT_BME680_LIB
@@ -181,11 +184,43 @@ void Sensor_BME680::publishState()
         _bme680.setPressureOversampling(BME680_OS_4X);
         _bme680.setIIRFilterSize(BME680_FILTER_SIZE_3);
         _bme680.setGasHeater(320, 150); // 320*C for 150 ms
+        #if IOT_SENSOR_BME680_SPLIT_PHASE
+            attachScheduler(BME680_UPDATE_RATE * 1000);
+        #endif
     }
 
+    #if IOT_SENSOR_BME680_SPLIT_PHASE
+
+        uint16_t Sensor_BME680::beginConversion()
+        {
+            auto endTime = _bme680.beginReading();
+            if (!endTime) {
+                __DBG_printf("begin reading failed");
+                return I2CScheduler::kFailed;
+            }
+            return std::max<int32_t>(0, endTime - millis());
+        }
+
+        void Sensor_BME680::collectConversion()
+        {
+            // the conversion has finished and endReading() does not wait
+            if (!_bme680.endReading()) {
+                __DBG_printf("end reading failed");
+                return;
+            }
+            _updateSensor();
+        }
+
+    #endif
 
     Sensor_BME680::SensorDataType &Sensor_BME680::_readSensor()
     {
+        #if IOT_SENSOR_BME680_SPLIT_PHASE
+            if (isScheduled()) {
+                return _sensor;
+            }
+            I2CScheduler::Client::BlockingRead measure(*this);
+        #endif
         auto endTime = _bme680.beginReading();
         if (!endTime) {
             __DBG_printf("begin reading failed");
@@ -196,7 +231,12 @@ void Sensor_BME680::publishState()
             __DBG_printf("end reading failed");
             return _sensor;
         }
+        _updateSensor();
+        return _sensor;
+    }
 
+    void Sensor_BME680::_updateSensor()
+    {
         // Air Quality Approximation
         float baselineResistance = 50000;  // Initial baseline gas resistance (Ohms)
         float baselineCO2 = 400;           // Start assuming fresh air at 400 ppm
@@ -226,8 +266,6 @@ void Sensor_BME680::publishState()
             (_bme680.pressure / 100.0) + _cfg.pressure_offset,
             estimatedCO2
         );
-
-        return _sensor;
     }
 
 #endif
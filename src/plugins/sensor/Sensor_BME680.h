@@ -12,6 +12,7 @@
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
+#include "I2CScheduler.h"
 #if HAVE_ADAFRUIT_BME680_LIB
 #    include <Adafruit_BME680.h>
 #endif
@@ -29,7 +30,17 @@
 
 class Sensor_CCS811;
 
-class Sensor_BME680 : public MQTT::Sensor {
+#if IOT_SENSOR_I2C_SCHEDULER && HAVE_ADAFRUIT_BME680_LIB
+#    define IOT_SENSOR_BME680_SPLIT_PHASE 1
+#else
+#    define IOT_SENSOR_BME680_SPLIT_PHASE 0
+#endif
+
+class Sensor_BME680 : public MQTT::Sensor
+    #if IOT_SENSOR_BME680_SPLIT_PHASE
+        , public I2CScheduler::Client
+    #endif
+{
 public:
     static constexpr uint32_t BME680_UPDATE_RATE = 30;
 
@@ -82,11 +93,19 @@ public:
 
     SensorDataType readSensor();
 
+    #if IOT_SENSOR_BME680_SPLIT_PHASE
+        virtual uint16_t beginConversion() override;
+        virtual void collectConversion() override;
+    #endif
+
 private:
     friend Sensor_CCS811;
 
     String _getId(const __FlashStringHelper *type = nullptr);
     SensorDataType &_readSensor();
+    #if HAVE_ADAFRUIT_BME680_LIB
+        void _updateSensor();
+    #endif
 
     void _readConfig();
 
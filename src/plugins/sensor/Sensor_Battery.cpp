@@ -34,13 +34,15 @@ uint8_t operator&(uint8_t a, SensorRecordType b) {
 Sensor_Battery::Sensor_Battery(const String &name) :
     MQTT::Sensor(MQTT::SensorType::BATTERY),
     _name(name),
+    _adcConsumer(nullptr),
     _adcValue(0)
 {
     REGISTER_SENSOR_CLIENT(this);
     reconfigure(nullptr);
 
     #if USE_ADC_MANAGER
-        ADCManager::getInstance().addAutoReadTimer(Event::milliseconds(kReadInterval / 2), Event::milliseconds(10), kReadInterval / 20);
+        // average of kADCNumReads samples over kReadInterval
+        _adcConsumer = ADCScheduler::getInstance().add(F("battery"), kReadInterval / kADCNumReads, kADCNumReads, ADCScheduler::PriorityType::LOW);
     #endif
 
     _Timer(_timer).add(Event::milliseconds(kReadInterval), true, [this](Event::CallbackTimerPtr) {
@@ -50,13 +52,16 @@ Sensor_Battery::Sensor_Battery(const String &name) :
 
 Sensor_Battery::~Sensor_Battery()
 {
+    #if USE_ADC_MANAGER
+        ADCScheduler::getInstance().remove(_adcConsumer);
+    #endif
     UNREGISTER_SENSOR_CLIENT(this);
 }
 
 void Sensor_Battery::_readADC(uint8_t num)
 {
     #if USE_ADC_MANAGER
-        auto value = ADCManager::getInstance().readValue();
+        uint16_t value = _adcConsumer->size() ? _adcConsumer->getAverage() : ADCManager::getInstance().readValue();
     #else
         uint32_t tmp = analogRead(A0);
         auto count = num;
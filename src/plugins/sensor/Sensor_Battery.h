@@ -12,6 +12,7 @@
 #endif
 #include <vector>
 #include <ReadADC.h>
+#include "adc_scheduler.h"
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
@@ -272,6 +273,7 @@ private:
     String _name;
     ConfigType _config;
     Event::Timer _timer;
+    ADCScheduler::Consumer *_adcConsumer;
     float _adcValue;
     Status _status;
 
@@ -21,6 +21,9 @@
 
 Sensor_CCS811::Sensor_CCS811(const String &name, uint8_t address) :
     MQTT::Sensor(MQTT::SensorType::CCS811),
+    #if IOT_SENSOR_I2C_SCHEDULER
+        I2CScheduler::Client(F("CCS811")),
+    #endif
     _name(name),
     _address(address),
     _state(_readStateFile())
@@ -34,6 +37,9 @@ Sensor_CCS811::Sensor_CCS811(const String &name, uint8_t address) :
         // save first state after 5min.
         _state = SensorFileEntry(_address, 0, time(nullptr) - IOT_SENSOR_CCS811_SAVE_STATE_INTERVAL + 60);
     }
+    #if IOT_SENSOR_I2C_SCHEDULER
+        attachScheduler(DEFAULT_UPDATE_RATE * 1000);
+    #endif
 }
 
 Sensor_CCS811::~Sensor_CCS811()
@@ -98,7 +104,35 @@ void Sensor_CCS811::publishState()
     }
 }
 
+#if IOT_SENSOR_I2C_SCHEDULER
+
+    uint16_t Sensor_CCS811::beginConversion()
+    {
+        _setEnvironmentalData();
+        return 0;
+    }
+
+    void Sensor_CCS811::collectConversion()
+    {
+        _readValues();
+    }
+
+#endif
+
 Sensor_CCS811::SensorData &Sensor_CCS811::_readSensor()
+{
+    #if IOT_SENSOR_I2C_SCHEDULER
+        if (isScheduled()) {
+            return _sensor;
+        }
+        I2CScheduler::Client::BlockingRead measure(*this);
+    #endif
+    _setEnvironmentalData();
+    _readValues();
+    return _sensor;
+}
+
+void Sensor_CCS811::_setEnvironmentalData()
 {
 // use temperature and humidity for compensation
 #if IOT_SENSOR_HAVE_LM75A || IOT_SENSOR_HAVE_BME280 || IOT_SENSOR_HAVE_BME680
@@ -127,7 +161,10 @@ Sensor_CCS811::SensorData &Sensor_CCS811::_readSensor()
 #else
     _ccs811.setEnvironmentalData(55, 25);
 #endif
+}
 
+void Sensor_CCS811::_readValues()
+{
     bool available = _ccs811.available();
     uint8_t error = available ? _ccs811.readData() : 0;
     if (!available || error) {
@@ -141,7 +178,7 @@ Sensor_CCS811::SensorData &Sensor_CCS811::_readSensor()
             }
         }
         __LDBG_printf("CCS811 0x%02x: available=%u error=%d/%d #%u", _address, available, _ccs811.checkError(), error, _sensor.errors);
-        return _sensor;
+        return;
     }
 
     _sensor.errors = 0;
@@ -156,8 +193,6 @@ Sensor_CCS811::SensorData &Sensor_CCS811::_readSensor()
     __LDBG_printf("CCS811 0x%02x: available=%d/%d eCO2 %u ppm TVOC %u ppb error=%d baseline=%u",
         _address, _sensor.available, available, _sensor.eCO2, _sensor.TVOC, _ccs811.checkError(), _state.baseline
     );
-
-    return _sensor;
 }
 
 String Sensor_CCS811::_getId(const __FlashStringHelper *type)
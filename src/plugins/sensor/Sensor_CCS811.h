@@ -12,6 +12,7 @@
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
+#include "I2CScheduler.h"
 #include <Adafruit_CCS811.h>
 
 #ifndef IOT_SENSOR_CCS811_RENDER_TYPE
@@ -27,7 +28,11 @@
 #define IOT_SENSOR_CCS811_SAVE_STATE_INTERVAL 900
 #endif
 
-class Sensor_CCS811 : public MQTT::Sensor {
+class Sensor_CCS811 : public MQTT::Sensor
+    #if IOT_SENSOR_I2C_SCHEDULER
+        , public I2CScheduler::Client
+    #endif
+{
 public:
     struct SensorData {
         int8_t available;   // -1 init, 0 N/A, 1 available
@@ -76,10 +81,18 @@ public:
         return _sensor;
     }
 
+    #if IOT_SENSOR_I2C_SCHEDULER
+        // the compensation data is written first and the results are read in the next transaction
+        virtual uint16_t beginConversion() override;
+        virtual void collectConversion() override;
+    #endif
+
 private:
     String _getId(const __FlashStringHelper *type = nullptr);
     String _getTopic(const __FlashStringHelper *type = nullptr);
     SensorData &_readSensor();
+    void _setEnvironmentalData();
+    void _readValues();
 
     SensorFileEntry _readStateFile() const;
     void _writeStateFile();
@@ -25,18 +25,18 @@ using Plugins = KFCConfigurationClasses::PluginsType;
 
 Sensor_HLW8012 *hlwSensor = nullptr;
 static volatile uint32_t energyCounter = 0;
-static Sensor_HLW8012::InterruptBuffer _interruptBufferCF;
-static Sensor_HLW8012::InterruptBuffer _interruptBufferCF1;
+static Sensor_HLW8012::PulseQueue _pulseQueueCF;
+static Sensor_HLW8012::PulseQueue _pulseQueueCF1;
 
 extern "C" void IRAM_ATTR Sensor_HLW8012_callbackCF()
 {
-    _interruptBufferCF.push_back(micros());
+    _pulseQueueCF.push(micros());
     energyCounter++;
 }
 
 extern "C" void IRAM_ATTR Sensor_HLW8012_callbackCF1()
 {
-    _interruptBufferCF1.push_back(micros());
+    _pulseQueueCF1.push(micros());
 }
 
 // ------------------------------------------------------------------------
@@ -99,7 +99,7 @@ Sensor_HLW8012::Sensor_HLW8012(const String &name, uint8_t pinSel, uint8_t pinCF
 void Sensor_HLW8012::_loop()
 {
     // power and energy
-    if (_processInterruptBuffer(_interruptBufferCF, _inputCF)) {
+    if (_processInterruptBuffer(_pulseQueueCF, _inputCF)) {
         if (_inputCF.pulseWidthIntegral && IOT_SENSOR_HLW80xx_NO_NOISE(_noiseLevel)) {
             _inputCF.setTarget(_inputCF.pulseWidthIntegral);
         }
@@ -132,11 +132,11 @@ void Sensor_HLW8012::_loop()
         if (millis() > _inputCF1->delayStart) {
             _inputCF1->delayStart = 0;
             _inputCF1->counter = 1;
-            InterruptLock lock;
-            _interruptBufferCF1.clear();
+            _inputCF1->hasLastEdge = false;
+            _pulseQueueCF1.clear();
         }
     }
-    else if (_processInterruptBuffer(_interruptBufferCF1, *_inputCF1)) {
+    else if (_processInterruptBuffer(_pulseQueueCF1, *_inputCF1)) {
         if (_inputCF1->pulseWidthIntegral) {
             if (_inputCF1 == &_inputCFI) {
                 if (IOT_SENSOR_HLW80xx_NO_NOISE(_noiseLevel)) {
@@ -158,16 +158,11 @@ void Sensor_HLW8012::_loop()
     }
 }
 
-bool Sensor_HLW8012::_processInterruptBuffer(InterruptBuffer &buffer, SensorInput &input)
+bool Sensor_HLW8012::_processInterruptBuffer(PulseQueue &queue, SensorInput &input)
 {
-    auto settings = input.getSettings();
-
-    size_t size;
-    {
-        InterruptLock lock;
-        size = buffer.size();
-    }
-    if (size >= 2) {
+    // process all pulses that have been queued since the last call
+    auto size = queue.size();
+    if (size) {
 
         #if IOT_SENSOR_HLW80xx_DATA_PLOT
             auto client = Http2Serial::getClientById(_webSocketClient);
@@ -188,100 +183,84 @@ bool Sensor_HLW8012::_processInterruptBuffer(InterruptBuffer &buffer, SensorInpu
         #endif
 
         // tested up to 5KHz
-        // jitter +-0.03Hz @ 500Hz
-        {
-            InterruptLock lock;
-            auto iterator = buffer.begin();
-            auto lastValue = *iterator;
-            while(++iterator != buffer.end()) {
-                auto value = *iterator;
-                lock.~InterruptLock();
-
-                auto diff = get_time_since(lastValue, value);
-                lastValue = value;
-
-                #if IOT_SENSOR_HLW80xx_NOISE_SUPPRESSION
-                    if (&input == &_inputCFI) {
-                        // calculate noise level of the HLW8012
-                        uint32_t noiseMin = ~0;
-                        uint32_t noiseMax = 0;
-                        uint32_t noiseSum = 0;
-                        _noiseBuffer.push_back(diff);
-                        if (_noiseBuffer.size() >= _noiseBuffer.capacity())  {
-                            float standardDeviation = 0.0;
-                            for(auto noiseDiff: _noiseBuffer) {
-                                noiseMin = min(noiseMin, noiseDiff);
-                                noiseMax = max(noiseMax, noiseDiff);
-                                noiseSum += noiseDiff;
-                            }
-                            float noiseMean = noiseSum / _noiseBuffer.size();
-                            for(auto noiseDiff: _noiseBuffer) {
-                                standardDeviation += pow(noiseMean, 2);
-                            }
-                            standardDeviation = sqrt(standardDeviation / _noiseBuffer.size());
-                            uint32_t noiseLevel = ((noiseMean - noiseMin) + (noiseMax - noiseMean)) * 50000.0 / noiseMean; // in %%
+        // the pulse width of a batch is fitted over all its edges, which is not affected by the jitter of single pulses
+        uint32_t batchStart = input.lastEdge;
+        uint32_t pulses = 0;
+        for(size_t i = 0; i < size; i++) {
+            auto value = queue.at(i);
+
+            if (!input.hasLastEdge || PulseQueue::isGap(value)) {
+                // first pulse or pulses have been dropped, start a new batch
+                if (pulses) {
+                    _integratePulses(input, get_time_since(batchStart, input.lastEdge), pulses);
+                    pulses = 0;
+                }
+                batchStart = value;
+                input.lastEdge = value;
+                input.hasLastEdge = true;
+                continue;
+            }
 
-                            // filter quick changes in current which looks like noise
-                            uint32_t multiplier = 500 * 2000 / diff;
-                            _noiseLevel = ((_noiseLevel * multiplier) + noiseLevel) / (multiplier + 1.0);
+            auto diff = get_time_since(input.lastEdge, value);
+            input.lastEdge = value;
+            pulses++;
+
+            #if IOT_SENSOR_HLW80xx_NOISE_SUPPRESSION
+                if (&input == &_inputCFI) {
+                    // calculate noise level of the HLW8012
+                    uint32_t noiseMin = ~0;
+                    uint32_t noiseMax = 0;
+                    uint32_t noiseSum = 0;
+                    _noiseBuffer.push_back(diff);
+                    if (_noiseBuffer.size() >= _noiseBuffer.capacity())  {
+                        float standardDeviation = 0.0;
+                        for(auto noiseDiff: _noiseBuffer) {
+                            noiseMin = min(noiseMin, noiseDiff);
+                            noiseMax = max(noiseMax, noiseDiff);
+                            noiseSum += noiseDiff;
+                        }
+                        float noiseMean = noiseSum / _noiseBuffer.size();
+                        for(auto noiseDiff: _noiseBuffer) {
+                            standardDeviation += pow(noiseMean, 2);
+                        }
+                        standardDeviation = sqrt(standardDeviation / _noiseBuffer.size());
+                        uint32_t noiseLevel = ((noiseMean - noiseMin) + (noiseMax - noiseMean)) * 50000.0 / noiseMean; // in %%
 
-                            //TODO check standardDeviation
-                            debug_printf_P(PSTR("sd %f lvl %f\n"), standardDeviation, _noiseLevel / 10);
+                        // filter quick changes in current which looks like noise
+                        uint32_t multiplier = 500 * 2000 / diff;
+                        _noiseLevel = ((_noiseLevel * multiplier) + noiseLevel) / (multiplier + 1.0);
 
-                            if (!IOT_SENSOR_HLW80xx_NOISE_SUPPRESSION(_noiseLevel)) { // set current and power to zero, values will be updated but not shown
-                                _power = 0;
-                                _current = 0;
-                            }
+                        //TODO check standardDeviation
+                        debug_printf_P(PSTR("sd %f lvl %f\n"), standardDeviation, _noiseLevel / 10);
+
+                        if (!IOT_SENSOR_HLW80xx_NOISE_SUPPRESSION(_noiseLevel)) { // set current and power to zero, values will be updated but not shown
+                            _power = 0;
+                            _current = 0;
                         }
                     }
-                #endif
-
-                if (input.counter == 0 || settings.avgValCount == 0) {
-                    input.average = diff;
-                }
-                else {
-                    // get an average of the last N values to filter spikes
-                    uint32_t multiplier = std::min((uint32_t)settings.avgValCount, input.counter);
-                    input.average = ((input.average * multiplier) + diff) / (multiplier + 1);
-                }
-                input.counter++;
-
-                // use average for the integration
-                auto diff2 = input.average;
-                if (input.pulseWidthIntegral) {
-                    uint32_t multiplier = 500 * settings.intTime / input.lastIntegration;
-                    input.pulseWidthIntegral = ((input.pulseWidthIntegral * multiplier) + diff2) / (multiplier + 1.0);
-                    input.lastIntegration = diff2;
-                }
-                else {
-                    input.pulseWidthIntegral = diff2;
-                    input.lastIntegration = diff2;
                 }
-
-                #if IOT_SENSOR_HLW80xx_DATA_PLOT
-                    if (dataType) {
-                        _plotData.push_back(value);
-                        if (convertUnits) {
-                            _plotData.push_back(input.convertPulse(diff));
-                            _plotData.push_back(input.convertPulse(input.average));
-                            _plotData.push_back(input.convertPulse(input.pulseWidthIntegral));
-                        }
-                        else {
-                            _plotData.push_back(diff);
-                            _plotData.push_back(input.average);
-                            _plotData.push_back(input.pulseWidthIntegral);
-                        }
+            #endif
+
+            #if IOT_SENSOR_HLW80xx_DATA_PLOT
+                if (dataType) {
+                    _plotData.push_back(value);
+                    if (convertUnits) {
+                        _plotData.push_back(input.convertPulse(diff));
+                        _plotData.push_back(input.convertPulse(input.average));
+                        _plotData.push_back(input.convertPulse(input.pulseWidthIntegral));
                     }
-                #endif
-
-            new(static_cast<void *>(&lock)) InterruptLock(); // recreate destroyed lock
+                    else {
+                        _plotData.push_back(diff);
+                        _plotData.push_back(input.average);
+                        _plotData.push_back(input.pulseWidthIntegral);
+                    }
+                }
+            #endif
         }
-
-        // copy last value and items that have not been processed
-        --iterator;
-        // buffer = std::move(buffer.slice(iterator, buffer.end()));           // takes ~20-30µs
-        buffer.shrink(iterator, buffer.end());                              // <1µs
-    }
+        if (pulses) {
+            _integratePulses(input, get_time_since(batchStart, input.lastEdge), pulses);
+        }
+        queue.consume(size);
 
     #if IOT_SENSOR_HLW80xx_DATA_PLOT
         // send every 100ms or 400 data points to keep the packets small
@@ -342,6 +321,35 @@ bool Sensor_HLW8012::_processInterruptBuffer(InterruptBuffer &buffer, SensorInpu
     return false;
 }
 
+void Sensor_HLW8012::_integratePulses(SensorInput &input, uint32_t time, uint32_t pulses)
+{
+    auto &settings = input.getSettings();
+    double pulseWidth = time / static_cast<double>(pulses);
+
+    // each pulse of the batch has the same weight to keep the timeframe of the integration
+    if (input.counter == 0 || settings.avgValCount == 0) {
+        input.average = pulseWidth;
+    }
+    else {
+        // get an average of the last N values to filter spikes
+        uint32_t multiplier = std::min((uint32_t)settings.avgValCount, input.counter);
+        input.average = ((input.average * static_cast<double>(multiplier)) + (pulseWidth * pulses)) / (multiplier + pulses);
+    }
+    input.counter += pulses;
+
+    // use average for the integration
+    auto diff2 = input.average;
+    if (input.pulseWidthIntegral && input.lastIntegration) {
+        uint32_t multiplier = 500 * settings.intTime / input.lastIntegration;
+        input.pulseWidthIntegral = ((input.pulseWidthIntegral * multiplier) + (diff2 * static_cast<double>(pulses))) / (multiplier + static_cast<double>(pulses));
+        input.lastIntegration = diff2;
+    }
+    else {
+        input.pulseWidthIntegral = diff2;
+        input.lastIntegration = diff2;
+    }
+}
+
 void Sensor_HLW8012::getStatus(Print &output)
 {
     output.printf_P(PSTR("Power Monitor HLW8012" HTML_S(br) "Calibration U=%f, I=%f, P=%f, Rs="), _calibrationU, _calibrationI, _calibrationP);
@@ -350,6 +358,7 @@ void Sensor_HLW8012::getStatus(Print &output)
 
     #if DEBUG_IOT_SENSOR
         output.printf_P(PSTR(HTML_S(br) "PINS: sel=%u cf=%u cf1=%u"), _pinSel, _pinCF, _pinCF1);
+        output.printf_P(PSTR(HTML_S(br) "Dropped pulses: cf=%u cf1=%u"), _pulseQueueCF.getOverflows(), _pulseQueueCF1.getOverflows());
     #endif
 }
 
@@ -397,14 +406,16 @@ void Sensor_HLW8012::_toggleOutputMode(int delay)
 
 void Sensor_HLW8012::dump(Print &output)
 {
-    output.printf_P(PSTR("Pi=% 8.3fms avg=% 8.3fms cnt=% 4u %ci=% 9.4fms avg=% 9.4f cnt=% 4u "),
+    output.printf_P(PSTR("Pi=% 8.3fms avg=% 8.3fms cnt=% 4u %ci=% 9.4fms avg=% 9.4f cnt=% 4u ovf=%u/%u "),
         _inputCF.pulseWidthIntegral / 1000.0,
         _inputCF.average / 1000.0,
         _inputCF.counter,
         _getOutputMode(_inputCF1),
         _inputCF1->pulseWidthIntegral / 1000.0,
         _inputCF1->average / 1000.0,
-        _inputCF1->counter
+        _inputCF1->counter,
+        _pulseQueueCF.getOverflows(),
+        _pulseQueueCF1.getOverflows()
     );
     Sensor_HLW80xx::dump(output);
 }
@@ -419,6 +430,7 @@ void Sensor_HLW8012::dump(Print &output)
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(HLWCAL, "HLWCAL", "<u=voltage/i=current/p=power>[,<repeat>]|[,<displayed value>,<real value>]", "Enter calibration mode or set values");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(HLWMODE, "HLWMODE", "<u=voltage/i=current/c=cycle>[,<delay in ms>", "Set voltage or current mode");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF(HLWCFG, "HLWCFG", "<params,params,...>", "Configure sensor inputs", "Display configuration");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(HLWREPLAY, "HLWREPLAY", "<u=voltage/i=current/p=power>,<filename>[,<pulses per loop>]", "Replay recorded pulse timestamps in microseconds, one per line");
 
 #if AT_MODE_HELP_SUPPORTED
 
@@ -428,6 +440,7 @@ ATModeCommandHelpArrayPtr Sensor_HLW8012::atModeCommandHelp(size_t &size) const
         PROGMEM_AT_MODE_HELP_COMMAND(HLWCAL),
         PROGMEM_AT_MODE_HELP_COMMAND(HLWMODE),
         PROGMEM_AT_MODE_HELP_COMMAND(HLWCFG),
+        PROGMEM_AT_MODE_HELP_COMMAND(HLWREPLAY),
     };
     size = sizeof(tmp) / sizeof(tmp[0]);
     return tmp;
@@ -592,6 +605,41 @@ bool Sensor_HLW8012::atModeHandler(AtModeArgs &args)
             }
             return true;
         }
+        else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(HLWREPLAY))) {
+            if (args.requireArgs(2, 3)) {
+                // the pulses are passed through a separate queue and a copy of the input, the sensor values are not modified
+                char ch = args.toLowerChar(0);
+                SensorInput input((ch == 'u') ? _inputCFU : ((ch == 'i') ? _inputCFI : _inputCF));
+                input.clear();
+                auto filename = args.get(1);
+                auto pulsesPerLoop = args.toIntMinMax<uint16_t>(2, 1, PulseQueue::capacity() * 4, 16);
+                auto file = KFCFS.open(filename, fs::FileOpenMode::read);
+                auto queue = std::unique_ptr<PulseQueue>(new PulseQueue());
+                if (!file || !queue) {
+                    args.printf_P(PSTR("cannot open %s"), filename);
+                    return true;
+                }
+                auto &serial = args.getStream();
+                uint32_t count = 0;
+                while(file.available()) {
+                    auto line = file.readStringUntil('\n');
+                    line.trim();
+                    if (line.length() == 0 || line.charAt(0) == '#') {
+                        continue;
+                    }
+                    queue->push(strtoul(line.c_str(), nullptr, 10));
+                    if ((++count % pulsesPerLoop) == 0 || !file.available()) {
+                        auto size = queue->size();
+                        if (_processInterruptBuffer(*queue, input)) {
+                            serial.printf_P(PSTR("+%s: pulses=%u avg=%uus integral=%.3fus value=%.4f\n"), PROGMEM_AT_MODE_HELP_COMMAND(HLWREPLAY), size, input.average, input.pulseWidthIntegral, input.convertPulse(input.pulseWidthIntegral));
+                        }
+                        delay(1);
+                    }
+                }
+                args.printf_P(PSTR("replayed %u pulses, counter=%u dropped=%u"), count, input.counter, queue->getOverflows());
+            }
+            return true;
+        }
     }
     return false;
 }
@@ -7,6 +7,7 @@
 #if IOT_SENSOR_HAVE_HLW8012
 
 #include <Arduino_compat.h>
+#include <atomic>
 #include <stl_ext/fixed_circular_buffer.h>
 #include "WebUIComponent.h"
 #include "plugins.h"
@@ -53,9 +54,88 @@
 #    define IOT_SENSOR_HLW8012_MEASURE_LEN_I 12000
 #endif
 
+// size of the pulse queues for CF and CF1. must be a power of 2
+// 128 entries can store ~25ms of pulses @ 5KHz (interrupts on both edges)
+#ifndef IOT_SENSOR_HLW8012_PULSE_QUEUE_SIZE
+#    define IOT_SENSOR_HLW8012_PULSE_QUEUE_SIZE 128
+#endif
+
+// lock-free single producer, single consumer queue for the pulse timestamps
+//
+// push() is called from the interrupt handler and is the only function writing _head, the main loop reads
+// the timestamps with at() and releases them with consume(), which is the only function writing _tail
+// if the queue is full, the pulse is dropped and the next stored timestamp is marked as gap to restart the
+// measurement. bit 0 is used as marker which reduces the resolution to 2µs
+template<size_t _Size>
+class HLW8012PulseQueue {
+public:
+    static_assert(_Size && (_Size & (_Size - 1)) == 0, "size must be a power of 2");
+
+    static constexpr uint32_t kGapFlag = 0x01;
+    static constexpr uint32_t kMask = _Size - 1;
+
+    HLW8012PulseQueue() : _head(0), _tail(0), _overflows(0), _gap(false) {}
+
+    // interrupt handler
+    inline __attribute__((__always_inline__))
+    void push(uint32_t time) {
+        uint32_t head = _head;
+        if (head - _tail >= _Size) {
+            _overflows++;
+            _gap = true;
+            return;
+        }
+        _buffer[head & kMask] = _gap ? (time | kGapFlag) : (time & ~kGapFlag);
+        _gap = false;
+        // the timestamp must be stored before the consumer can see the new head
+        std::atomic_signal_fence(std::memory_order_release);
+        _head = head + 1;
+    }
+
+    // main loop
+    size_t size() const {
+        size_t size = _head - _tail;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        return size;
+    }
+
+    uint32_t at(size_t index) const {
+        return _buffer[(_tail + index) & kMask];
+    }
+
+    void consume(size_t count) {
+        std::atomic_signal_fence(std::memory_order_release);
+        _tail = _tail + count;
+    }
+
+    void clear() {
+        consume(size());
+    }
+
+    // number of dropped pulses
+    uint32_t getOverflows() const {
+        return _overflows;
+    }
+
+    static constexpr size_t capacity() {
+        return _Size;
+    }
+
+    static bool isGap(uint32_t value) {
+        return value & kGapFlag;
+    }
+
+private:
+    uint32_t _buffer[_Size];
+    volatile uint32_t _head;
+    volatile uint32_t _tail;
+    volatile uint32_t _overflows;
+    volatile bool _gap;
+};
+
 class Sensor_HLW8012 : public Sensor_HLW80xx {
 public:
-    using InterruptBuffer = stdex::fixed_circular_buffer<uint32_t, 16>;
+    using PulseQueue = HLW8012PulseQueue<IOT_SENSOR_HLW8012_PULSE_QUEUE_SIZE>;
     using NoiseBuffer = stdex::fixed_circular_buffer<uint32_t, 5>;
 
     typedef enum {
@@ -84,6 +164,8 @@ public:
         void clear() {
             pulseWidthIntegral = 0;
             lastIntegration = 0;
+            lastEdge = 0;
+            hasLastEdge = false;
             delayStart = 0;
             toggleTimer = 0;
             counter = 0;
@@ -92,6 +174,9 @@ public:
 
         double pulseWidthIntegral;
         uint32_t lastIntegration;
+        // last edge of the previous batch
+        uint32_t lastEdge;
+        bool hasLastEdge;
         uint32_t delayStart;
         uint32_t toggleTimer;
         uint32_t counter;
@@ -152,7 +237,8 @@ private:
 
     void _loop();
     void _toggleOutputMode(int delay = -1);
-    bool _processInterruptBuffer(InterruptBuffer &buffer, SensorInput &input);
+    bool _processInterruptBuffer(PulseQueue &queue, SensorInput &input);
+    void _integratePulses(SensorInput &input, uint32_t time, uint32_t pulses);
 
     String _getId(const __FlashStringHelper *type) const;
     uint8_t _getCFPin() const;
@@ -23,6 +23,10 @@ using Plugins = KFCConfigurationClasses::PluginsType;
 #define STATE_FILENAME "/.pvt/hlw80xx.state"
 #define STATE_NVS_KEY "hlw80xx_state"
 
+#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT && IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+    static EnergyJournal _energyJournal;
+#endif
+
 Sensor_HLW80xx::Sensor_HLW80xx(const String &name, MQTT::SensorType type) :
     MQTT::Sensor(type),
     _name(name),
@@ -265,6 +269,35 @@ bool Sensor_HLW80xx::__loadEnergyCounterFromFile(EnergyCounterArray &energy)
     return true;
 }
 
+#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS || IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+
+void Sensor_HLW80xx::__saveEnergyCounterToNVS()
+{
+    auto err = config._nvs_open(true);
+    if (err == ESP_OK) {
+        err = config._nvs_set_blob(STATE_NVS_KEY, _energyCounter.data(), sizeof(_energyCounter));
+        config._nvs_close();
+    }
+    if (err != ESP_OK) {
+        __LDBG_printf("cannot write '%s' err=%x", PSTR(STATE_NVS_KEY), err);
+    }
+}
+
+bool Sensor_HLW80xx::__loadEnergyCounterFromNVS(EnergyCounterArray &energy)
+{
+    EnergyCounterArray tmp;
+    size_t length = sizeof(tmp);
+    auto err = config._nvs_get_blob_with_open(STATE_NVS_KEY, tmp.data(), &length);
+    if (err == ESP_OK && length == sizeof(tmp)) {
+        energy = tmp;
+        return true;
+    }
+    __LDBG_printf("failed to get '%s' len=%u size=%u err=%x", PSTR(STATE_NVS_KEY), length, sizeof(tmp), err);
+    return false;
+}
+
+#endif
+
 void Sensor_HLW80xx::_saveEnergyCounter(bool shutdown)
 {
     #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT
@@ -289,6 +322,35 @@ void Sensor_HLW80xx::_saveEnergyCounter(bool shutdown)
             __saveEnergyCounterToFile();
             _saveEnergyCounterTimer = ms;
 
+        #elif IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+
+            if (!_energyJournal.isAvailable()) {
+                // no energy section in the linker script, use NVS
+                __saveEnergyCounterToNVS();
+                #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
+                    if (shutdown || ++_saveEnergyCounterFSCounter >= IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS) {
+                        __saveEnergyCounterToFile();
+                        _saveEnergyCounterFSCounter = 0;
+                    }
+                #endif
+            }
+            else if (!_energyJournal.append(_energyCounter)) {
+                __LDBG_printf("cannot append to journal");
+                // keep a copy on the file system
+                __saveEnergyCounterToFile();
+                #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
+                    _saveEnergyCounterFSCounter = 0;
+                #endif
+            }
+            #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
+                // backup
+                else if (shutdown || ++_saveEnergyCounterFSCounter >= IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS) {
+                    __saveEnergyCounterToFile();
+                    _saveEnergyCounterFSCounter = 0;
+                }
+            #endif
+            _saveEnergyCounterTimer = ms;
+
         #elif IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS
 
             #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
@@ -297,14 +359,7 @@ void Sensor_HLW80xx::_saveEnergyCounter(bool shutdown)
                 __LDBG_printf("save");
             #endif
 
-            auto err = config._nvs_open(true);
-            if (err == ESP_OK) {
-                err = config._nvs_set_blob(STATE_NVS_KEY, _energyCounter.data(), sizeof(_energyCounter));
-                config._nvs_close();
-            }
-            if (err != ESP_OK) {
-                __LDBG_printf("cannot write '%s' err=%x", PSTR(STATE_NVS_KEY), err);
-            }
+            __saveEnergyCounterToNVS();
             _saveEnergyCounterTimer = ms;
 
             #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
@@ -330,17 +385,24 @@ bool Sensor_HLW80xx::__loadEnergyCounter(EnergyCounterArray &energy)
 
             return __loadEnergyCounterFromFile(energy);
 
-        #elif IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS
+        #elif IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
 
-            EnergyCounterArray tmp;
-            size_t length = sizeof(tmp);
-            auto err = config._nvs_get_blob_with_open(STATE_NVS_KEY, tmp.data(), &length);
-            if (err == ESP_OK && length == sizeof(tmp)) {
-                energy = tmp;
+            // the journal keeps a copy of the last record
+            if (_energyJournal.read(energy)) {
                 return true;
             }
-            else {
-                __LDBG_printf("failed to get '%s' len=%u size=%u err=%x", PSTR(STATE_NVS_KEY), length, sizeof(tmp), err);
+            // no records available after upgrading or without energy section. NVS has been saved more
+            // frequently than the file system backup
+            if (__loadEnergyCounterFromNVS(energy)) {
+                return true;
+            }
+            // restore data from the file system or config
+            return __loadEnergyCounterFromFile(energy);
+
+        #elif IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS
+
+            if (__loadEnergyCounterFromNVS(energy)) {
+                return true;
             }
             #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
                 return __loadEnergyCounterFromFile(energy);
@@ -353,7 +415,16 @@ bool Sensor_HLW80xx::__loadEnergyCounter(EnergyCounterArray &energy)
 
 void Sensor_HLW80xx::__loadEnergyCounter()
 {
-    __loadEnergyCounter(_energyCounter);
+    #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT && IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+        auto hasRecord = _energyJournal.begin();
+        __loadEnergyCounter(_energyCounter);
+        if (!hasRecord && _energyJournal.isAvailable()) {
+            // migrate the counters from NVS or the file system into the empty journal
+            _energyJournal.append(_energyCounter);
+        }
+    #else
+        __loadEnergyCounter(_energyCounter);
+    #endif
     #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT
         _saveEnergyCounterTimer = millis();
         #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
@@ -388,6 +459,9 @@ void Sensor_HLW80xx::dump(Print &output)
         (double)_energyCounter[0],
         _getPowerFactor()
     );
+    #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT && IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+        _energyJournal.dump(output);
+    #endif
 }
 
 #if AT_MODE_SUPPORTED
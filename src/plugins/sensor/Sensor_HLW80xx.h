@@ -128,17 +128,26 @@
 #    define IOT_SENSOR_HLW80xx_F_OSC 3.579000
 #endif
 
-// interval in milliseconds to save energy counter, 0 to disable
-#ifndef IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT
-#    define IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT (5 * 60 * 1000)
-#endif
-
 #define IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_FS      1 // save to file system
 #define IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS     2 // save to config nvs, fallback is the file system
+#define IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL 3 // append to the energy journal, requires _ENERGY_start/_ENERGY_end in the linker script
 
 // select storage type
 #ifndef IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE
-#   define IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS
+#   if ESP8266
+#       define IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+#   else
+#       define IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS
+#   endif
+#endif
+
+// interval in milliseconds to save energy counter, 0 to disable
+#ifndef IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT
+#   if IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+#       define IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT (30 * 1000)
+#   else
+#       define IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT (5 * 60 * 1000)
+#   endif
 #endif
 
 // save backup to file system every IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT writes (hourly unless the data does not change)
@@ -146,12 +155,17 @@
 #    define IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS ((60 * 60 * 1000) / IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT)
 #endif
 
-#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE != IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS
+// the file system backup is available for NVS and the journal
+#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_FS
 #    undef IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS
 #    define IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT_FS 0
 #endif
 
-#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT != 0 && IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT < 60000
+#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+#    if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT != 0 && IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT < 5000
+#        error IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT must be greater or equal 5000
+#    endif
+#elif IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT != 0 && IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT < 60000
 #    error IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT must be greater or equal 60000
 #endif
 
@@ -164,6 +178,10 @@
 #    define IOT_SENSOR_HLW80xx_NUM_ENERGY_COUNTERS 2
 #endif
 
+#if IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT && IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+#    include "EnergyJournal.h"
+#endif
+
 namespace HLW80xx {
 
     static constexpr uint32_t kSaveEnergyIntervalMillis = IOT_SENSOR_HLW80xx_SAVE_ENERGY_CNT;
@@ -263,6 +281,12 @@ protected:
     void __saveEnergyCounterToFile();
     // load energy counters from FS into 'energy' and report result
     bool __loadEnergyCounterFromFile(EnergyCounterArray &energy);
+    #if IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_NVS || IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE == IOT_SENSOR_HLW80xx_SAVE_ENERGY_TYPE_JOURNAL
+        // store energy counters in the config NVS
+        void __saveEnergyCounterToNVS();
+        // load energy counters from the config NVS into 'energy' and report result
+        bool __loadEnergyCounterFromNVS(EnergyCounterArray &energy);
+    #endif
     // load energy counters into 'energy' and report result
     bool __loadEnergyCounter(EnergyCounterArray &energy);
 
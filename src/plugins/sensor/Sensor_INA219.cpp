@@ -19,16 +19,21 @@
 
 Sensor_INA219::Sensor_INA219(const String &name, uint8_t address, TwoWire &wire) :
     MQTT::Sensor(MQTT::SensorType::INA219),
+    #if IOT_SENSOR_I2C_SCHEDULER
+        I2CScheduler::Client(F("INA219")),
+    #endif
     _name(name),
     _address(address),
     _config(_readConfig()),
     _updateTimer(0),
     _holdPeakTimer(0),
-    _data(500),
-    _avgData(_config.averaging_period * 1000),
-    _mqttData(_mqttUpdateRate * 1000 / 2),
+    _windowStart(millis()),
+    _avgU(NAN),
+    _avgI(NAN),
     _peakCurrent(NAN),
     _peakPower(NAN),
+    _lastCurrent(0),
+    _wire(wire),
     _ina219(address)
 {
     REGISTER_SENSOR_CLIENT(this);
@@ -38,6 +43,9 @@ Sensor_INA219::Sensor_INA219(const String &name, uint8_t address, TwoWire &wire)
     __LDBG_printf("address=%x voltage_range=%x gain=%x shunt_ADC_res=%x", _address, IOT_SENSOR_INA219_BUS_URANGE, IOT_SENSOR_INA219_GAIN, IOT_SENSOR_INA219_SHUNT_ADC_RES);
 
     setUpdateRate(_config.webui_update_rate);
+    #if IOT_SENSOR_I2C_SCHEDULER
+        attachScheduler(IOT_SENSOR_INA219_READ_INTERVAL);
+    #endif
     LOOP_FUNCTION_ADD_ARG([this]() {
         this->_loop();
     }, this);
@@ -107,8 +115,8 @@ void Sensor_INA219::getValues(WebUINS::Events &array, bool timer)
         array.append(WebUINS::Values(_getId(SensorInputType::POWER), WebUINS::TrimmedFloat(_convertPower(_data.P()), _config.webui_power_precision)));
     }
     if (_config.webui_average) {
-        array.append(WebUINS::Values(_getId(SensorInputType::AVG_CURRENT), WebUINS::TrimmedFloat(_convertCurrent(_avgData.I()), _config.webui_current_precision)));
-        array.append(WebUINS::Values(_getId(SensorInputType::AVG_POWER), WebUINS::TrimmedFloat(_convertPower(_avgData.P()), _config.webui_power_precision)));
+        array.append(WebUINS::Values(_getId(SensorInputType::AVG_CURRENT), WebUINS::TrimmedFloat(_convertCurrent(_avgI), _config.webui_current_precision)));
+        array.append(WebUINS::Values(_getId(SensorInputType::AVG_POWER), WebUINS::TrimmedFloat(_convertPower(_avgU * _avgI), _config.webui_power_precision)));
     }
     if (_config.webui_peak) {
         array.append(WebUINS::Values(_getId(SensorInputType::PEAK_CURRENT), WebUINS::TrimmedFloat(_convertCurrent(_peakCurrent), _config.webui_current_precision)));
@@ -143,12 +151,18 @@ void Sensor_INA219::publishState()
         publish(MQTT::Client::formatTopic(_getId(SensorInputType::POWER)), true, String(_convertPower(_mqttData.P()), _getPowerPrecision()));
         publish(MQTT::Client::formatTopic(_getId(SensorInputType::PEAK_CURRENT)), true, String(_convertCurrent(_peakCurrent), _getCurrentPrecision()));
         publish(MQTT::Client::formatTopic(_getId(SensorInputType::PEAK_POWER)), true, String(_convertPower(_peakPower), _getPowerPrecision()));
+        _mqttData.clear();
     }
 }
 
 void Sensor_INA219::getStatus(Print &output)
 {
     output.printf_P(PSTR("INA219 @ I2C address 0x%02x, shunt %.3fm\xE2\x84\xA6" HTML_S(br)), _address, IOT_SENSOR_INA219_R_SHUNT * 1000.0);
+    if (_data.current.count()) {
+        output.printf_P(PSTR("%u samples/%ums, current min. %.1fmA max. %.1fmA RMS %.1fmA" HTML_S(br)), _data.current.count(), kWindowMillis,
+            _data.current.min() / static_cast<float>(kCurrentScale), _data.current.max() / static_cast<float>(kCurrentScale), _data.current.rms() / kCurrentScale
+        );
+    }
 }
 
 String Sensor_INA219::_getId(SensorInputType type) const
@@ -156,25 +170,209 @@ String Sensor_INA219::_getId(SensorInputType type) const
     return PrintString(F("ina219_0x%02x_%c"), _address, type);
 }
 
+#if IOT_SENSOR_I2C_SCHEDULER
+
+    uint16_t Sensor_INA219::beginConversion()
+    {
+        return 0;
+    }
+
+    void Sensor_INA219::collectConversion()
+    {
+        _readValues();
+    }
+
+#endif
+
 void Sensor_INA219::_loop()
 {
+    #if IOT_SENSOR_I2C_SCHEDULER
+        if (isScheduled()) {
+            return;
+        }
+    #endif
     uint32_t now = millis();
-    if (get_time_since(_updateTimer, now) < IOT_SENSOR_INA219_READ_INTERVAL) {
+    if (!isBurstActive() && get_time_since(_updateTimer, now) < IOT_SENSOR_INA219_READ_INTERVAL) {
         return;
     }
     _updateTimer = now;
-    auto microsTime = micros();
-    float U = _ina219.getBusVoltage_V();
-    float I = _ina219.getCurrent_mA();
-    float P = U * I;
-    if (I > _peakCurrent || P > _peakPower || get_time_since(_holdPeakTimer, now) >= _config.getHoldPeakTimeMillis()) {
-        _peakCurrent = I;
-        _peakPower = P;
+    #if IOT_SENSOR_I2C_SCHEDULER
+        I2CScheduler::Client::BlockingRead measure(*this);
+    #endif
+    _readValues();
+}
+
+void Sensor_INA219::_readValues()
+{
+    uint32_t now = millis();
+    if (isBurstActive() && get_time_since(_burst->start, now) >= _burst->duration) {
+        _endBurst();
+    }
+    if (get_time_since(_windowStart, now) >= kWindowMillis) {
+        _endWindow(now);
+    }
+    // bus voltage register, bit 1 is set when a new conversion is available
+    uint16_t busVoltage;
+    if (!_readRegister(kRegBusVoltage, busVoltage) || !(busVoltage & _BV(1))) {
+        return;
+    }
+    int32_t U = (busVoltage >> 3) * 4;
+    int32_t I = _ina219.getCurrent_mA() * kCurrentScale;
+    // reading the power register clears the conversion ready flag
+    uint16_t power;
+    _readRegister(kRegPower, power);
+    _addSample(U, I);
+}
+
+bool Sensor_INA219::_readRegister(uint8_t reg, uint16_t &value)
+{
+    _wire.beginTransmission(_address);
+    _wire.write(reg);
+    if (_wire.endTransmission() != 0 || _wire.requestFrom(_address, static_cast<uint8_t>(2)) != 2) {
+        return false;
+    }
+    value = _wire.read() << 8;
+    value |= _wire.read();
+    return true;
+}
+
+void Sensor_INA219::Window::add(int32_t U, int32_t I)
+{
+    voltage.add(U);
+    current.add(I);
+    float P = (U / 1000.0f) * (I / static_cast<float>(kCurrentScale));
+    if (isnan(maxPower) || P > maxPower) {
+        maxPower = P;
+    }
+}
+
+void Sensor_INA219::Window::merge(const Window &window)
+{
+    voltage.merge(window.voltage);
+    current.merge(window.current);
+    if (isnan(maxPower) || window.maxPower > maxPower) {
+        maxPower = window.maxPower;
+    }
+}
+
+void Sensor_INA219::Statistics::merge(const Statistics &stats)
+{
+    if (!stats._count) {
+        return;
+    }
+    if (!_count) {
+        *this = stats;
+        return;
+    }
+    // parallel algorithm by Chan et al.
+    uint32_t count = _count + stats._count;
+    double delta = static_cast<double>(stats._mean - _mean);
+    _mean += static_cast<int64_t>(delta * stats._count / count);
+    _m2 += stats._m2 + static_cast<int64_t>((delta * delta / (1 << kShift)) * (static_cast<double>(_count) * stats._count / count));
+    _count = count;
+    _min = std::min(_min, stats._min);
+    _max = std::max(_max, stats._max);
+}
+
+void Sensor_INA219::_addSample(int32_t U, int32_t I)
+{
+    _window.add(U, I);
+    if (_burst && _burst->end == 0) {
+        if (_burst->count < IOT_SENSOR_INA219_BURST_SAMPLES) {
+            _burst->samples[_burst->count++] = I;
+        }
+        _burst->window.add(U, I);
+        if (_burst->count >= IOT_SENSOR_INA219_BURST_SAMPLES) {
+            _endBurst();
+        }
+    }
+    #if IOT_SENSOR_INA219_BURST_TRIGGER
+        else if (I - _lastCurrent > IOT_SENSOR_INA219_BURST_TRIGGER * kCurrentScale) {
+            startBurst(IOT_SENSOR_INA219_BURST_DURATION);
+        }
+    #endif
+    _lastCurrent = I;
+}
+
+void Sensor_INA219::_endWindow(uint32_t now)
+{
+    _windowStart = now;
+    if (!_window.current.count()) {
+        return;
+    }
+    // all other values are derived from the completed window
+    _data = _window;
+    _window.clear();
+    _mqttData.merge(_data);
+
+    float U = _data.U();
+    float I = _data.I();
+    if (isnan(_avgU)) {
+        _avgU = U;
+        _avgI = I;
+    }
+    else {
+        float multiplier = (_config.averaging_period * 1000.0f) / kWindowMillis;
+        _avgU = ((_avgU * multiplier) + U) / (multiplier + 1);
+        _avgI = ((_avgI * multiplier) + I) / (multiplier + 1);
+    }
+
+    float peakCurrent = _data.current.max() / static_cast<float>(kCurrentScale);
+    if (isnan(_peakCurrent) || peakCurrent > _peakCurrent || _data.maxPower > _peakPower || get_time_since(_holdPeakTimer, now) >= _config.getHoldPeakTimeMillis()) {
+        _peakCurrent = peakCurrent;
+        _peakPower = _data.maxPower;
         _holdPeakTimer = now;
     }
-    _data.add(U, I, microsTime);
-    _avgData.add(U, I, microsTime);
-    _mqttData.add(U, I, microsTime);
+}
+
+void Sensor_INA219::startBurst(uint16_t durationMillis)
+{
+    if (!_burst) {
+        _burst.reset(new Burst());
+        if (!_burst) {
+            return;
+        }
+    }
+    __LDBG_printf("burst duration=%u", durationMillis);
+    _burst->start = millis();
+    _burst->end = 0;
+    _burst->duration = durationMillis;
+    _burst->count = 0;
+    _burst->window.clear();
+    _ina219.setCalibration(IOT_SENSOR_INA219_BUS_URANGE, IOT_SENSOR_INA219_GAIN, IOT_SENSOR_INA219_BURST_ADC_RES, IOT_SENSOR_INA219_R_SHUNT * _config.calibration, _config.offset);
+    #if IOT_SENSOR_I2C_SCHEDULER
+        attachScheduler(1);
+    #endif
+}
+
+void Sensor_INA219::_endBurst()
+{
+    _burst->end = millis();
+    _ina219.setCalibration(IOT_SENSOR_INA219_BUS_URANGE, IOT_SENSOR_INA219_GAIN, IOT_SENSOR_INA219_SHUNT_ADC_RES, IOT_SENSOR_INA219_R_SHUNT * _config.calibration, _config.offset);
+    #if IOT_SENSOR_I2C_SCHEDULER
+        attachScheduler(IOT_SENSOR_INA219_READ_INTERVAL);
+    #endif
+    __LDBG_printf("burst samples=%u", _burst->count);
+}
+
+void Sensor_INA219::printBurst(Print &output) const
+{
+    if (!_burst) {
+        output.print(F("No burst captured\n"));
+        return;
+    }
+    if (_burst->end == 0) {
+        output.print(F("Burst active\n"));
+        return;
+    }
+    auto &current = _burst->window.current;
+    output.printf_P(PSTR("Burst samples=%u time=%ums current min=%.2fmA max=%.2fmA avg=%.2fmA RMS=%.2fmA peak power=%.1fmW\n"),
+        _burst->count, _burst->end - _burst->start, current.min() / static_cast<float>(kCurrentScale), current.max() / static_cast<float>(kCurrentScale),
+        current.mean() / kCurrentScale, current.rms() / kCurrentScale, _burst->window.maxPower
+    );
+    for(uint16_t i = 0; i < _burst->count; i++) {
+        output.printf_P(PSTR("%u,%.2f\n"), i, _burst->samples[i] / static_cast<float>(kCurrentScale));
+    }
 }
 
 Sensor_INA219::ConfigType Sensor_INA219::_readConfig() const
@@ -276,8 +474,10 @@ void Sensor_INA219::reconfigure(PGM_P source)
     _holdPeakTimer = 0;
     _peakCurrent = NAN;
     _peakPower = NAN;
+    _window.clear();
     _data.clear();
-    _avgData = SensorData(_config.averaging_period * 500);
+    _avgU = NAN;
+    _avgI = NAN;
     _mqttData.clear();
 }
 
@@ -286,7 +486,7 @@ void Sensor_INA219::reconfigure(PGM_P source)
 
 #include "at_mode.h"
 
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(SENSORINA219, "SENSORINA219", "<interval in ms>", "Print INA219 sensor data");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(SENSORINA219, "SENSORINA219", "<interval in ms>|burst[,<duration in ms>]|stats", "Print INA219 sensor data, capture a burst or print the statistics of the last window and burst");
 
 #if AT_MODE_HELP_SUPPORTED
 
@@ -305,6 +505,37 @@ bool Sensor_INA219::atModeHandler(AtModeArgs &args)
 {
     if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(SENSORINA219))) {
 
+        if (args.equalsIgnoreCase(0, F("burst")) || args.equalsIgnoreCase(0, F("stats"))) {
+            auto burst = args.equalsIgnoreCase(0, F("burst"));
+            auto duration = args.toIntMinMax<uint16_t>(1, 10, 5000, IOT_SENSOR_INA219_BURST_DURATION);
+            auto &serial = args.getStream();
+            auto count = std::count_if(SensorPlugin::begin(), SensorPlugin::end(), [&](SensorPtr sensorPtr) {
+                if (sensorPtr->getType() == SensorType::INA219) {
+                    auto &sensor = *reinterpret_cast<Sensor_INA219 *>(sensorPtr);
+                    if (burst) {
+                        sensor.startBurst(duration);
+                        args.printf_P(PSTR("Burst started for %ums"), duration);
+                    }
+                    else {
+                        auto &data = sensor._data;
+                        args.printf_P(PSTR("window=%ums samples=%u U=%.3fV min=%.3fV max=%.3fV I=%.2fmA min=%.2fmA max=%.2fmA stddev=%.2fmA RMS=%.2fmA Pmax=%.1fmW"),
+                            kWindowMillis, data.current.count(),
+                            data.U(), data.voltage.min() / 1000.0, data.voltage.max() / 1000.0,
+                            data.I(), data.current.min() / static_cast<float>(kCurrentScale), data.current.max() / static_cast<float>(kCurrentScale),
+                            sqrtf(data.current.variance()) / kCurrentScale, data.current.rms() / kCurrentScale, data.maxPower
+                        );
+                        sensor.printBurst(serial);
+                    }
+                    return true;
+                }
+                return false;
+            });
+            if (!count) {
+                args.print(F("No sensor found"));
+            }
+            return true;
+        }
+
         static Event::Timer *_timer;
         if (_timer) {
             delete _timer;
@@ -9,9 +9,12 @@
 #include <Arduino_compat.h>
 #include <Adafruit_INA219.h>
 #include <Wire.h>
+#include <limits>
+#include <memory>
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
+#include "I2CScheduler.h"
 
 using Plugins = KFCConfigurationClasses::PluginsType;
 
@@ -43,14 +46,39 @@ using Plugins = KFCConfigurationClasses::PluginsType;
 #endif
 
 #ifndef IOT_SENSOR_INA219_READ_INTERVAL
-// should close to the sample/averaging rate
-#    define IOT_SENSOR_INA219_READ_INTERVAL 68
+// poll interval in milliseconds. the values are read only if the conversion ready flag is set, the interval should
+// be about half of the conversion time
+#    define IOT_SENSOR_INA219_READ_INTERVAL 34
+#endif
+
+#ifndef IOT_SENSOR_INA219_BURST_ADC_RES
+// ADC resolution during bursts, a single 12bit conversion takes 532us. the I2C scheduler collects a sample about every 2ms
+#    define IOT_SENSOR_INA219_BURST_ADC_RES INA219_CONFIG_SADCRES_12BIT_1S_532US
+#endif
+
+#ifndef IOT_SENSOR_INA219_BURST_SAMPLES
+// max. number of samples stored during a burst
+#    define IOT_SENSOR_INA219_BURST_SAMPLES 256
+#endif
+
+#ifndef IOT_SENSOR_INA219_BURST_TRIGGER
+// start a burst automatically if the current rises by more than this value in mA between two samples. 0 = disabled
+#    define IOT_SENSOR_INA219_BURST_TRIGGER 0
+#endif
+
+#ifndef IOT_SENSOR_INA219_BURST_DURATION
+// duration of bursts in milliseconds
+#    define IOT_SENSOR_INA219_BURST_DURATION 250
 #endif
 
 #pragma push_macro("_U")
 #undef _U
 
-class Sensor_INA219 : public MQTT::Sensor {
+class Sensor_INA219 : public MQTT::Sensor
+    #if IOT_SENSOR_I2C_SCHEDULER
+        , public I2CScheduler::Client
+    #endif
+{
 public:
     enum class SensorInputType : char {
         VOLTAGE =       'u',
@@ -101,27 +129,84 @@ public:
 
     void resetPeak();
 
+    #if IOT_SENSOR_I2C_SCHEDULER
+        // the sensor runs in continuous mode and the registers are read in a single transaction
+        virtual uint16_t beginConversion() override;
+        virtual void collectConversion() override;
+    #endif
+
+    // high rate capture with IOT_SENSOR_INA219_BURST_ADC_RES
+    void startBurst(uint16_t durationMillis);
+    bool isBurstActive() const;
+    void printBurst(Print &output) const;
+
 private:
-    class SensorData {
+    // Welford's online algorithm with fixed point values
+    class Statistics {
     public:
-        SensorData(uint32_t period);
+        static constexpr uint8_t kShift = 8;
 
-        float U() const;
-        float I() const;
-        float P() const;
+        Statistics();
 
-        void add(float U, float I, uint32_t micros);
-        void set(float U, float I, uint32_t micros);
+        void add(int32_t value);
+        void merge(const Statistics &stats);
         void clear();
 
+        uint32_t count() const;
+        int32_t min() const;
+        int32_t max() const;
+        float mean() const;
+        float variance() const;
+        float rms() const;
+
     private:
-        float _U;
-        float _I;
-        uint32_t _micros;
-        uint32_t _period;
+        uint32_t _count;
+        int32_t _min;
+        int32_t _max;
+        // mean and sum of squared differences << kShift
+        int64_t _mean;
+        int64_t _m2;
+    };
+
+    // voltage in mV, current in 10uA
+    struct Window {
+        Statistics voltage;
+        Statistics current;
+        // max. power of a single sample in mW
+        float maxPower;
+
+        Window() : maxPower(NAN) {}
+
+        void add(int32_t U, int32_t I);
+        void merge(const Window &window);
+        void clear();
+
+        float U() const;
+        float I() const;
+        float P() const;
+    };
+
+    struct Burst {
+        uint32_t start;
+        // 0 while the burst is active
+        uint32_t end;
+        uint16_t duration;
+        uint16_t count;
+        int32_t samples[IOT_SENSOR_INA219_BURST_SAMPLES];
+        Window window;
     };
 
+    static constexpr uint8_t kRegBusVoltage = 0x02;
+    static constexpr uint8_t kRegPower = 0x03;
+    static constexpr uint16_t kWindowMillis = 500;
+    static constexpr int32_t kCurrentScale = 100;
+
     void _loop();
+    void _readValues();
+    bool _readRegister(uint8_t reg, uint16_t &value);
+    void _addSample(int32_t U, int32_t I);
+    void _endWindow(uint32_t now);
+    void _endBurst();
     String _getId(SensorInputType type) const;
     ConfigType _readConfig() const;
     const __FlashStringHelper *_getCurrentUnit() const;
@@ -137,60 +222,101 @@ private:
 
     uint32_t _updateTimer;
     uint32_t _holdPeakTimer;
-    SensorData _data;
-    SensorData _avgData;
-    SensorData _mqttData;
+    uint32_t _windowStart;
+    // all samples of the current window
+    Window _window;
+    // last completed window
+    Window _data;
+    // exponential moving average of the windows over the averaging period
+    float _avgU;
+    float _avgI;
+    // all windows since the last MQTT update
+    Window _mqttData;
     float _peakCurrent;
     float _peakPower;
+    int32_t _lastCurrent;
+    std::unique_ptr<Burst> _burst;
 
+    TwoWire &_wire;
     Adafruit_INA219 _ina219;
 };
 
-inline Sensor_INA219::SensorData::SensorData(uint32_t period) : _U(NAN), _I(NAN), _period(period)
+inline Sensor_INA219::Statistics::Statistics()
+{
+    clear();
+}
+
+inline void Sensor_INA219::Statistics::add(int32_t value)
+{
+    _count++;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+    int64_t x = static_cast<int64_t>(value) << kShift;
+    int64_t delta = x - _mean;
+    _mean += delta / static_cast<int32_t>(_count);
+    _m2 += (delta * (x - _mean)) >> kShift;
+}
+
+inline void Sensor_INA219::Statistics::clear()
+{
+    _count = 0;
+    _min = std::numeric_limits<int32_t>::max();
+    _max = std::numeric_limits<int32_t>::min();
+    _mean = 0;
+    _m2 = 0;
+}
+
+inline uint32_t Sensor_INA219::Statistics::count() const
 {
+    return _count;
 }
 
-float inline Sensor_INA219::SensorData::U() const
+inline int32_t Sensor_INA219::Statistics::min() const
 {
-    return _U;
+    return _min;
 }
 
-inline float Sensor_INA219::SensorData::I() const
+inline int32_t Sensor_INA219::Statistics::max() const
 {
-    return _I;
+    return _max;
 }
 
-inline float Sensor_INA219::SensorData::P() const
+inline float Sensor_INA219::Statistics::mean() const
 {
-    return isnan(_U) || isnan(_I) ? NAN : (_U * _I);
+    return _count ? _mean / static_cast<float>(1 << kShift) : NAN;
 }
 
-inline void Sensor_INA219::SensorData::add(float U, float I, uint32_t micros)
+inline float Sensor_INA219::Statistics::variance() const
 {
-    if (isnan(_U) || isnan(_I)) {
-        _U = U;
-        _I = I;
-    } else {
-        float multiplier = _period / (get_time_since(_micros, micros) / 1000.0);
-        float divider = multiplier + 1.0;
-        _U = ((_U * multiplier) + U) / divider;
-        _I = ((_I * multiplier) + I) / divider;
-        // __DBG_printf("U=%f I=%f U=%f I=%f m=%f d=%f", U, I, _U, _I, multiplier, divider);
-    }
-    _micros = micros;
+    return _count ? _m2 / static_cast<float>((1 << kShift) * _count) : NAN;
 }
 
-inline void Sensor_INA219::SensorData::set(float U, float I, uint32_t micros)
+inline float Sensor_INA219::Statistics::rms() const
 {
-    _U = U;
-    _I = I;
-    _micros = micros;
+    auto avg = mean();
+    return sqrtf(variance() + avg * avg);
 }
 
-inline void Sensor_INA219::SensorData::clear()
+inline void Sensor_INA219::Window::clear()
 {
-    _U = NAN;
-    _I = NAN;
+    voltage.clear();
+    current.clear();
+    maxPower = NAN;
+}
+
+inline float Sensor_INA219::Window::U() const
+{
+    return voltage.mean() / 1000.0f;
+}
+
+inline float Sensor_INA219::Window::I() const
+{
+    return current.mean() / kCurrentScale;
+}
+
+inline float Sensor_INA219::Window::P() const
+{
+    return U() * I();
 }
 
 inline Adafruit_INA219 &Sensor_INA219::getSensor()
@@ -214,6 +340,11 @@ inline float Sensor_INA219::getPower() const
     return _data.P();
 }
 
+inline bool Sensor_INA219::isBurstActive() const
+{
+    return _burst && _burst->end == 0;
+}
+
 inline float Sensor_INA219::getPeakCurrent() const
 {
     return _peakCurrent;
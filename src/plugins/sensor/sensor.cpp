@@ -44,7 +44,10 @@ PROGMEM_DEFINE_PLUGIN_OPTIONS(
 );
 
 
-SensorPlugin::SensorPlugin() : PluginComponent(PROGMEM_GET_PLUGIN_OPTIONS(SensorPlugin))
+SensorPlugin::SensorPlugin() :
+    PluginComponent(PROGMEM_GET_PLUGIN_OPTIONS(SensorPlugin)),
+    _updatesPerTimer(IOT_SENSOR_UPDATES_PER_TIMER),
+    _staggered(true)
 {
     REGISTER_PLUGIN(this, "SensorPlugin");
 }
@@ -171,35 +174,87 @@ void SensorPlugin::setup(SetupModeType mode, const PluginComponents::Dependencie
     #endif
 
     _sortSensors();
-    _Timer(_timer).add(Event::milliseconds(1000), true, SensorPlugin::timerEvent);
+    _updatePhases();
+    _Timer(_timer).add(Event::milliseconds(kTimerInterval), true, SensorPlugin::timerEvent);
     for(const auto sensor: _sensors) {
         sensor->setup();
     }
 
 }
 
+void SensorPlugin::setStaggered(bool staggered)
+{
+    _staggered = staggered;
+    _timerStats = TimerStats();
+    _updatePhases();
+}
+
+void SensorPlugin::dumpTimerStats(Print &output) const
+{
+    output.printf_P(PSTR("Sensor timer %s, interval=%ums sensors=%u updates/callback=%u callbacks=%u updates=%u time=%.0f/%uus\n"),
+        _staggered ? PSTR("staggered") : PSTR("burst"), kTimerInterval, _sensors.size(), _updatesPerTimer,
+        _timerStats.calls, _timerStats.updates, _timerStats.calls ? _timerStats.totalTime / static_cast<float>(_timerStats.calls) : 0.0f, _timerStats.maxTime
+    );
+}
+
+void SensorPlugin::_updatePhases()
+{
+    // enough updates per callback to update each sensor once per second
+    constexpr uint16_t kCallbacks = kUpdateInterval / kTimerInterval;
+    _updatesPerTimer = std::max<uint16_t>(IOT_SENSOR_UPDATES_PER_TIMER, (_sensors.size() + kCallbacks - 1) / kCallbacks);
+    uint32_t now = millis();
+    uint16_t index = 0;
+    for(const auto sensor: _sensors) {
+        sensor->_timerDue = _staggered ? now + (index++ * kUpdateInterval) / _sensors.size() : now;
+    }
+}
+
 // low priority timer executed in main loop()
 void SensorPlugin::_timerEvent()
 {
+    auto start = micros();
+    auto now = millis();
+    if (std::none_of(_sensors.begin(), _sensors.end(), [now](const MQTT::SensorPtr sensor) {
+        return static_cast<int32_t>(now - sensor->_timerDue) >= 0;
+    })) {
+        return;
+    }
+    uint8_t updates = 0;
+    uint8_t maxUpdates = _staggered ? _updatesPerTimer : 0xff;
     auto mqttIsConnected = MQTT::Client::safeIsConnected();
+    auto hasClients = WebUISocket::hasAuthenticatedClients();
+    WebUINS::Events events;
 
-    if (WebUISocket::hasAuthenticatedClients()) {
-        WebUINS::Events events;
-        {
-            for(const auto sensor: _sensors) {
-                __DBG_validatePointerCheck(sensor, VP_HS);
-                sensor->timerEvent(&events, mqttIsConnected);
-            }
+    for(const auto sensor: _sensors) {
+        if (static_cast<int32_t>(now - sensor->_timerDue) < 0) {
+            continue;
         }
-        if (events.hasAny()) {
-            WebUISocket::broadcast(WebUISocket::getSender(), WebUINS::UpdateEvents(events));
+        // keep the phase of the sensor, sensors delayed by the limit per callback are updated in the next one
+        sensor->_timerDue += kUpdateInterval;
+        if (static_cast<int32_t>(now - sensor->_timerDue) >= 0) {
+            sensor->_timerDue = now + kUpdateInterval;
         }
-    }
-    else if (mqttIsConnected) {
-        for(const auto sensor: _sensors) {
-            __DBG_validatePointerCheck(sensor, VP_HS);
+        __DBG_validatePointerCheck(sensor, VP_HS);
+        if (hasClients) {
+            sensor->timerEvent(&events, mqttIsConnected);
+        }
+        else if (mqttIsConnected) {
             sensor->timerEvent(nullptr, true);
         }
+        if (++updates >= maxUpdates) {
+            break;
+        }
+    }
+    if (events.hasAny()) {
+        WebUISocket::broadcast(WebUISocket::getSender(), WebUINS::UpdateEvents(events));
+    }
+
+    if (updates) {
+        uint32_t time = micros() - start;
+        _timerStats.calls++;
+        _timerStats.updates += updates;
+        _timerStats.totalTime += time;
+        _timerStats.maxTime = std::max(_timerStats.maxTime, time);
     }
 }
 
@@ -278,6 +333,10 @@ void SensorPlugin::getStatus(Print &output)
         for(auto sensor: _sensors) {
             sensor->getStatus(str);
         }
+        #if IOT_SENSOR_I2C_SCHEDULER
+            str.print(F("I2C scheduler "));
+            str.print(I2CScheduler::getInstance().isEnabled() ? FSPGM(enabled) : FSPGM(disabled));
+        #endif
         output.print(str);
     }
 }
@@ -286,10 +345,20 @@ void SensorPlugin::getStatus(Print &output)
 
     #include "at_mode.h"
 
+    PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(SENSORT, "SENSORT", "<on|off|reset>", "Update the sensors staggered or all at once every second or reset the statistics. Without arguments, display the duration of the timer callbacks");
+
+    #if IOT_SENSOR_I2C_SCHEDULER
+        PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(I2CS, "I2CS", "<on|off|reset>", "Enable or disable the I2C sensor scheduler or reset the statistics. Without arguments, display bus time and blocking time per sensor");
+    #endif
+
     #if AT_MODE_HELP_SUPPORTED
 
         void SensorPlugin::atModeHelpGenerator()
         {
+            at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(SENSORT), getName_P());
+            #if IOT_SENSOR_I2C_SCHEDULER
+                at_mode_add_help(PROGMEM_AT_MODE_HELP_COMMAND(I2CS), getName_P());
+            #endif
             if (isEnabled() && !_sensors.empty()) {
                 for(const auto sensor: _sensors) {
                     size_t size;
@@ -307,6 +376,29 @@ void SensorPlugin::getStatus(Print &output)
 
     bool SensorPlugin::atModeHandler(AtModeArgs &args)
     {
+        if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(SENSORT))) {
+            if (args.equalsIgnoreCase(0, F("reset"))) {
+                _timerStats = TimerStats();
+            }
+            else if (args.size() >= 1) {
+                setStaggered(args.isTrue(0));
+            }
+            dumpTimerStats(args.getStream());
+            return true;
+        }
+        #if IOT_SENSOR_I2C_SCHEDULER
+            if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(I2CS))) {
+                auto &scheduler = I2CScheduler::getInstance();
+                if (args.equalsIgnoreCase(0, F("reset"))) {
+                    scheduler.resetStats();
+                }
+                else if (args.size() >= 1) {
+                    scheduler.setEnabled(args.isTrue(0));
+                }
+                scheduler.dump(args.getStream());
+                return true;
+            }
+        #endif
         for(const auto sensor: _sensors) {
             if (sensor->atModeHandler(args)) {
                 return true;
@@ -11,6 +11,7 @@
 #include "WebUIComponent.h"
 #include "plugins.h"
 #include "MQTTSensor.h"
+#include "I2CScheduler.h"
 #include "Sensor_SystemMetrics.h"
 #include "Sensor_LM75A.h"
 #include "Sensor_BME280.h"
@@ -109,6 +110,18 @@
 #    endif
 #endif
 
+// interval of the sensor timer in milliseconds. each sensor has its own phase within the second, so the updates are
+// spread over all timer callbacks
+#ifndef IOT_SENSOR_TIMER_INTERVAL
+#    define IOT_SENSOR_TIMER_INTERVAL 50
+#endif
+
+// min. number of sensors updated per timer callback. it is increased if there are not enough callbacks per second to
+// update all sensors
+#ifndef IOT_SENSOR_UPDATES_PER_TIMER
+#    define IOT_SENSOR_UPDATES_PER_TIMER 1
+#endif
+
 class SensorPlugin : public PluginComponent {
 public:
     using Plugins = KFCConfigurationClasses::PluginsType;
@@ -119,6 +132,19 @@ public:
     using SensorVector = std::vector<MQTT::SensorPtr>;
     using AddCustomSensorCallback = std::function<void(WebUINS::Root &webUI, SensorType nextType)>;
 
+    static constexpr uint16_t kTimerInterval = IOT_SENSOR_TIMER_INTERVAL;
+    static constexpr uint16_t kUpdateInterval = 1000;
+
+    // duration of the timer callbacks in microseconds
+    struct TimerStats {
+        uint32_t calls;
+        uint32_t updates;
+        uint32_t totalTime;
+        uint32_t maxTime;
+
+        TimerStats() : calls(0), updates(0), totalTime(0), maxTime(0) {}
+    };
+
 // WebUI
 public:
     virtual void createWebUI(WebUINS::Root &webUI) override;
@@ -169,6 +195,10 @@ public:
     // to add a group in setAddCustomSensorsCallback()
     static void addGroup(WebUINS::Root &webUI, const __FlashStringHelper *title);
 
+    // false updates all sensors at once every second
+    void setStaggered(bool staggered);
+    void dumpTimerStats(Print &output) const;
+
     #if AT_MODE_SUPPORTED
         #if AT_MODE_HELP_SUPPORTED
             virtual void atModeHelpGenerator() override;
@@ -194,10 +224,14 @@ private:
     void _timerEvent();
     size_t _count() const;
     void _sortSensors();
+    void _updatePhases();
 
     SensorVector _sensors;
     Event::Timer _timer;
     AddCustomSensorCallback _addCustomSensors;
+    uint8_t _updatesPerTimer;
+    bool _staggered;
+    TimerStats _timerStats;
 };
 
 extern "C" SensorPlugin sensorPlugin;
@@ -304,6 +338,7 @@ inline void SensorPlugin::shutdown()
 inline void SensorPlugin::reconfigure(const String &source)
 {
     _sortSensors();
+    _updatePhases();
     for(const auto sensor: _sensors) {
         sensor->reconfigure(source.c_str());
     }
@@ -28,6 +28,7 @@ const char Command_SYNC[] PROGMEM = { STK500v1Programmer::Cmnd_STK_GET_SYNC, STK
 PROGMEM_STRING_DEF(stk500v1_log_file, "/stk500v1/debug.log");
 PROGMEM_STRING_DEF(stk500v1_sig_file, "/stk500v1/atmega.csv");
 PROGMEM_STRING_DEF(stk500v1_tmp_file, "/stk500v1/firmware_tmp.hex");
+PROGMEM_STRING_DEF(stk500v1_img_file, "/stk500v1/firmware.img");
 
 STK500v1Programmer::STK500v1Programmer(Stream &serial) :
     _serial(serial),
@@ -52,9 +53,8 @@ void STK500v1Programmer::begin(Callback_t cleanup)
 {
     _callbackCleanup = cleanup;
 
-    _pageAddress = 0;
-    _pagePosition = 0;
     _clearPageBuffer();
+    _stats = {};
 
     if (&_serial == &Serial0) {
         _logPrintf_P(PSTR("Disabling serial handler"));
@@ -91,6 +91,10 @@ void STK500v1Programmer::end()
         _response.clear();
         _expectedResponse.clear();
         _file.close();
+        _image.close();
+        _pages.clear();
+        _pages.shrink_to_fit();
+        KFCFS.remove(FSPGM(stk500v1_img_file));
 
         _status(F("Done\n"));
 
@@ -138,99 +142,178 @@ void STK500v1Programmer::_loopFunction()
     }
 }
 
-void STK500v1Programmer::_writePage(uint16_t address, uint16_t length, Callback_t success, Callback_t failure)
+bool STK500v1Programmer::_createImage()
 {
-    BUILTIN_LED_SET(address % 2 == 0 ? BlinkLEDTimer::BlinkType::OFF : BlinkLEDTimer::BlinkType::SOLID);
-    _sendCommandLoadAddress(address);
+    auto start = millis();
+    _file.reset();
+    _pages.clear();
+    _image = KFCFS.open(FSPGM(stk500v1_img_file), fs::FileOpenMode::write);
+    if (!_image) {
+        _logPrintf_P(PSTR("Cannot create image file %s"), SPGM(stk500v1_img_file));
+        return false;
+    }
+
+    PageInfo page = { 0, 0, 0 };
+    bool hasPage = false;
+    auto storePage = [this, &page]() {
+        page.crc = crc32(_pageBuffer, page.length);
+        _pages.push_back(page);
+        return _image.write(_pageBuffer, _pageSize) == _pageSize;
+    };
+
+    _clearPageBuffer();
+    for(;;) {
+        char buffer[16];
+        uint16_t address;
+        if (hasPage && page.length >= _pageSize) { // page is full, continue with the next page
+            if (!storePage()) {
+                _logPrintf_P(PSTR("Failed to write image file"));
+                return false;
+            }
+            hasPage = false;
+        }
+        uint16_t read = sizeof(buffer);
+        if (hasPage && read > _pageSize - page.length) { // limit length to space left in page buffer
+            read = _pageSize - page.length;
+        }
+        auto length = _file.readBytes(buffer, read, address);
+        if (length == -1) {
+            _logPrintf_P(PSTR("Read error occurred: %s"), _file.getErrorMessage());
+            return false;
+        }
+        uint16_t pageAddress = (address / _pageSize);
+        if (hasPage && (length == 0 || page.address != pageAddress)) {
+            if (!storePage()) {
+                _logPrintf_P(PSTR("Failed to write image file"));
+                return false;
+            }
+            hasPage = false;
+        }
+        if (length == 0) {
+            break;
+        }
+        if (!hasPage) {
+            _clearPageBuffer();
+            page = { pageAddress, 0, 0 };
+            hasPage = true;
+        }
+        uint16_t pageOffset = address - (pageAddress * _pageSize);
+        if (pageOffset + length > _pageSize) {
+            _logPrintf_P(PSTR("Record at address %u exceeds page %u"), address, pageAddress);
+            return false;
+        }
+        memmove_P(_pageBuffer + pageOffset, buffer, length);
+        page.length = pageOffset + length;
+    }
+
+    // reopen for reading the pages
+    _image.close();
+    _image = KFCFS.open(FSPGM(stk500v1_img_file), fs::FileOpenMode::read);
+    _stats.imageTime = millis() - start;
+    _logPrintf_P(PSTR("Image created pages=%u time=%ums"), _pages.size(), _stats.imageTime);
+    return !!_image;
+}
+
+bool STK500v1Programmer::_loadPage(uint16_t index)
+{
+    auto &page = _pages[index];
+    _clearPageBuffer();
+    return _image.seek(index * _pageSize, SeekSet) && _image.read(_pageBuffer, page.length) == page.length;
+}
 
-    _updatePosition();
+void STK500v1Programmer::_comparePage(uint16_t index, bool loadPage, std::function<void(bool equal)> callback, Callback_t failure)
+{
+    auto &page = _pages[index];
+    _sendCommandLoadAddress(page.address);
 
-    uint8_t *tmp = new uint8_t[length]; // copy current page buffer
-    memmove_P(tmp, _pageBuffer, length);
+    _readResponse([this, index, loadPage, callback, failure]() {
 
-    _readResponse([this, address, length, success, failure, tmp]() {
+        auto &page = _pages[index];
+        _sendCommandReadPage(page.length);
 
-        _sendCommandProgPage(tmp, length);
-        delete[] tmp;
+        // the target is busy sending the page. load the data from the image meanwhile
+        if (loadPage && !_loadPage(index)) {
+            _logPrintf_P(PSTR("Failed to read page %u from image"), page.address);
+            failure();
+            return;
+        }
 
-        _readResponse(success, [this, address, length, failure]() {
-            _logPrintf_P(PSTR("Write page %u length %u failed"), address, length);
+        _readResponse([this, index, callback]() {
+            auto &page = _pages[index];
+            // skip Resp_STK_INSYNC
+            callback(crc32(_response.begin() + 1, page.length) == page.crc);
+        }, [this, failure, index]() {
+            _logPrintf_P(PSTR("Read page %u length %u failed"), _pages[index].address, _pages[index].length);
             failure();
         });
 
     }, failure);
 }
 
-void STK500v1Programmer::_verifyPage(uint16_t address, uint16_t length, Callback_t success, Callback_t failure)
+void STK500v1Programmer::_writePage(uint16_t index, Callback_t success, Callback_t failure)
 {
-    BUILTIN_LED_SET(address % 2 == 0 ? BlinkLEDTimer::BlinkType::OFF : BlinkLEDTimer::BlinkType::SOLID);
-    _sendCommandLoadAddress(address);
-
-    _updatePosition();
-
-    uint8_t *tmp = new uint8_t[length]; // copy current page buffer
-    memmove_P(tmp, _pageBuffer, length);
+    auto &page = _pages[index];
+    _sendCommandLoadAddress(page.address);
 
-    _readResponse([this, address, length, success, failure, tmp]() {
+    _readResponse([this, index, success, failure]() {
 
-        _sendCommandReadPage(tmp, length);
-        delete[] tmp;
+        _sendCommandProgPage(_pageBuffer, _pages[index].length);
 
-        _readResponse([this, success, length]() {
-            _verified += length;
-            success();
-        }, [this, failure, address, length]() {
-            _logPrintf_P(PSTR("Verify page %u length %u failed"), address, length);
+        _readResponse(success, [this, index, failure]() {
+            _logPrintf_P(PSTR("Write page %u length %u failed"), _pages[index].address, _pages[index].length);
             failure();
         });
 
     }, failure);
 }
 
-void STK500v1Programmer::_readFile(PageCallback_t callback, Callback_t success, Callback_t failure)
+void STK500v1Programmer::_processPage(uint16_t index, Callback_t success, Callback_t failure)
 {
-    bool exit = false;
-    do {
-        char buffer[16];
-        uint16_t address;
-        uint16_t read = sizeof(buffer);
-        if (_pagePosition != _pageSize && read > _pageSize - _pagePosition) { // limit length to space left in page buffer
-            read = _pageSize - _pagePosition;
-        }
-        auto length = _file.readBytes(buffer, read, address);
-        if (length == -1) {
-            _endPosition(F("FILE READ ERROR"), true);
-            _logPrintf_P(PSTR("Read error occurred: %s"), _file.getErrorMessage());
-            failure();
+    if (index >= _pages.size()) {
+        success();
+        return;
+    }
+    BUILTIN_LED_SET(index % 2 == 0 ? BlinkLEDTimer::BlinkType::OFF : BlinkLEDTimer::BlinkType::SOLID);
+    _updatePosition(index);
+
+    auto compareStart = millis();
+    _comparePage(index, true, [this, index, success, failure, compareStart](bool equal) {
+        _stats.compareTime += millis() - compareStart;
+        if (equal) {
+            // the target has this page already
+            _stats.skipped++;
+            _verified += _pages[index].length;
+            _processPage(index + 1, success, failure);
             return;
         }
 
-        uint16_t pageAddress = (address / _pageSize);
-        if (_pageAddress != pageAddress || length == 0) {  // new page, page buffer is filled already
-            if (length == 0) {
-                // write last page
-                callback(_pageAddress, _pagePosition, success, failure);
-            }
-            else {
-                // write page buffer and continue reading
-                callback(_pageAddress, _pagePosition, [this, callback, success, failure]() {
-                    _readFile(callback, success, failure);
-                }, failure);
-            }
+        auto writeStart = millis();
+        _writePage(index, [this, index, success, failure, writeStart]() {
+            _stats.written++;
+            _stats.writeTime += millis() - writeStart;
+
+            auto verifyStart = millis();
+            _comparePage(index, false, [this, index, success, failure, verifyStart](bool equal) {
+                _stats.verifyTime += millis() - verifyStart;
+                if (!equal) {
+                    _logPrintf_P(PSTR("Verify page %u length %u failed"), _pages[index].address, _pages[index].length);
+                    failure();
+                    return;
+                }
+                _verified += _pages[index].length;
+                _processPage(index + 1, success, failure);
+            }, failure);
 
-            // clear page buffer
-            _clearPageBuffer();
-            _pageAddress = pageAddress;
-            _pagePosition = 0;
+        }, failure);
 
-            // leave loop after storing data in buffer
-            exit = true;
-        }
-        uint16_t pageOffset = address - (_pageAddress * _pageSize);
-        memmove_P(_pageBuffer + pageOffset, buffer, length);
-        _pagePosition = pageOffset + length;
+    }, failure);
+}
 
-    } while (!exit);
+void STK500v1Programmer::_printStats()
+{
+    auto total = millis() - _flashStartTime;
+    _log(F("Pages %u, written %u, skipped %u, %u bytes verified"), _pages.size(), _stats.written, _stats.skipped, _verified);
+    _log(F("Time image %ums, compare %ums, write %ums, verify %ums, total %ums"), _stats.imageTime, _stats.compareTime, _stats.writeTime, _stats.verifyTime, total);
 }
 
 void STK500v1Programmer::_serialWrite(uint8_t byte)
@@ -283,7 +366,12 @@ void STK500v1Programmer::_flash()
         end();
         return;
     }
-    _log(F("Input file validated. %u bytes to write..."), _file.getEndAddress());
+    if (!_createImage()) {
+        _log(F("Failed to convert the input file: %s"), _file.getErrorMessage());
+        end();
+        return;
+    }
+    _log(F("Input file validated. %u bytes in %u pages to write..."), _file.getEndAddress(), _pages.size());
 
     _delay(250, [this]() {
 
@@ -324,57 +412,27 @@ void STK500v1Programmer::_flash()
 
                         _readResponse([this]() {
 
-                            _file.reset();
                             _startPosition(F("\nWriting"));
                             _logPrintf_P(PSTR("Entered programming mode"));
                             _printResponse();
 
-                            _readFile(
-                                [this](uint16_t address, uint16_t length, Callback_t success, Callback_t failure) {
-                                    _writePage(address, length, success, failure);
-                                },
+                            _verified = 0;
+                            _processPage(0,
                                 [this]() {
 
                                     _endPosition(F("Complete"), false);
-                                    _logPrintf_P(PSTR("Programming completed"));
-
-                                    // reset file and page buffer
-                                    _file.reset();
-                                    _pageAddress = 0;
-                                    _pagePosition = 0;
-                                    _verified = 0;
-                                    _clearPageBuffer();
-
-                                    _startPosition(F("Reading"));
-
-                                    _readFile(
-                                        [this](uint16_t address, uint16_t length, Callback_t success, Callback_t failure) {
-                                            _verifyPage(address, length, success, failure);
-                                        },
-                                        [this]() {
-
-                                            _endPosition(F("Complete"), false);
-                                            _log(F("%u bytes verified"), _verified);
-                                            _logPrintf_P(PSTR("Verification completed"));
-                                            _sendCommandLeaveProgMode();
-
-                                            _readResponse([this]() {
-                                                _logPrintf_P(PSTR("Left programming mode"));
-                                                _done(true);
-
-                                            }, [this]() {
-                                                _logPrintf_P(PSTR("Failed to leave programming mode"));
-                                                _printResponse();
-                                                _done(false);
-                                            });
-
-                                        },
-                                        [this]() {
-                                            _endPosition(F("READ ERROR"), true);
-                                            _logPrintf_P(PSTR("Verifying failed"));
-                                            _done(false);
-                                        }
-                                    );
+                                    _logPrintf_P(PSTR("Programming and verification completed"));
+                                    _sendCommandLeaveProgMode();
+
+                                    _readResponse([this]() {
+                                        _logPrintf_P(PSTR("Left programming mode"));
+                                        _done(true);
+
+                                    }, [this]() {
+                                        _logPrintf_P(PSTR("Failed to leave programming mode"));
+                                        _printResponse();
+                                        _done(false);
+                                    });
 
                                 },
                                 [this]() {
@@ -539,11 +597,14 @@ void STK500v1Programmer::_sendCommandProgPage(const uint8_t *data, uint16_t leng
     _setResponseTimeout(_defaultTimeout);
 }
 
-void STK500v1Programmer::_sendCommandReadPage(const uint8_t *data, uint16_t length)
+void STK500v1Programmer::_sendCommandReadPage(uint16_t length)
 {
+    // the content is compared by the caller
     _expectedResponse.clear();
     _expectedResponse.write(Resp_STK_INSYNC);
-    _expectedResponse.write(data, length);
+    for(uint16_t i = 0; i < length; i++) {
+        _expectedResponse.write(Resp_STK_ANY);
+    }
     _expectedResponse.write(Resp_STK_OK);
 
     _serialWrite(Cmnd_STK_READ_PAGE);
@@ -574,6 +635,7 @@ void STK500v1Programmer::_sendCommand(PGM_P command, uint8_t length)
 
 void STK500v1Programmer::_done(bool success)
 {
+    _printStats();
     _log(F("Programming %s (%u seconds)"), success ? PSTR("successful") : PSTR("failed"), (millis() - _flashStartTime) / 1000);
     _success = success;
 
@@ -812,10 +874,10 @@ void STK500v1Programmer::_startPosition(const String &message)
     _status(F("%s: | "), message.c_str());
 }
 
-void STK500v1Programmer::_updatePosition()
+void STK500v1Programmer::_updatePosition(uint16_t index)
 {
     String str;
-    _position = _file.getCurAddress() * (kProgressBarWidth - 1) / _file.getEndAddress();
+    _position = index * (kProgressBarWidth - 1) / _pages.size();
     if (_positionOld < _position) {
         while(_positionOld++ < _position) {
             str += '#';
@@ -7,6 +7,7 @@
 #include <Buffer.h>
 #include <IntelHexFormat.h>
 #include <PrintString.h>
+#include <vector>
 
 #if DEBUG_STK500V1
 #    include <debug_helper_enable.h>
@@ -17,6 +18,7 @@
 PROGMEM_STRING_DECL(stk500v1_log_file);
 PROGMEM_STRING_DECL(stk500v1_sig_file);
 PROGMEM_STRING_DECL(stk500v1_tmp_file);
+PROGMEM_STRING_DECL(stk500v1_img_file);
 
 class STK500v1Programmer {
 public:
@@ -112,7 +114,23 @@ public:
     };
 
     typedef std::function<void ()> Callback_t;
-    typedef std::function<void (uint16_t address, uint16_t length, Callback_t success, Callback_t failure)> PageCallback_t;
+
+    // page of the binary image created from the HEX file. the data is stored at index * _pageSize in the image file
+    struct PageInfo {
+        uint16_t address;
+        uint16_t length;
+        uint32_t crc;
+    };
+    using PageVector = std::vector<PageInfo>;
+
+    struct Stats {
+        uint32_t imageTime;
+        uint32_t compareTime;
+        uint32_t writeTime;
+        uint32_t verifyTime;
+        uint16_t skipped;
+        uint16_t written;
+    };
 
     static const int kProgressBarWidth = 100;
     static const int kDefaultTimeout = 5000;
@@ -168,7 +186,7 @@ private:
     void _sendCommandSetOptions(const Options_t &options);
     void _sendCommandLoadAddress(uint16_t address);
     void _sendCommandProgPage(const uint8_t *data, uint16_t length);
-    void _sendCommandReadPage(const uint8_t *data, uint16_t length);
+    void _sendCommandReadPage(uint16_t length);
     #if STK500_HAVE_FUSES
         void _sendCommandReadFuseExt();
         void _sendCommandProgFuseExt(uint8_t fuseLow, uint8_t fuseHigh, uint8_t fuseExt);
@@ -193,10 +211,18 @@ private:
     void _clearResponse(uint16_t delay, Callback_t callback);
     void _clearPageBuffer();
     void _uploadCallback();
-    void _readFile(PageCallback_t callback, Callback_t success, Callback_t failure);
     void _leaveProgrammingMode();
-    void _writePage(uint16_t address, uint16_t length, Callback_t success, Callback_t failure);
-    void _verifyPage(uint16_t address, uint16_t length, Callback_t success, Callback_t failure);
+
+    // convert the HEX file into a binary page image with a CRC for each page
+    bool _createImage();
+    bool _loadPage(uint16_t index);
+    // read the page from the target and compare the CRC. loadPage reads the page from the image into the page
+    // buffer while the target is sending the data
+    void _comparePage(uint16_t index, bool loadPage, std::function<void(bool equal)> callback, Callback_t failure);
+    // skip the page if it is identical, otherwise write and verify it
+    void _processPage(uint16_t index, Callback_t success, Callback_t failure);
+    void _writePage(uint16_t index, Callback_t success, Callback_t failure);
+    void _printStats();
 
     // handle delay and responses
     void _loopFunction();
@@ -224,11 +250,12 @@ private:
         char _fuseBytes[3];
     #endif
     IntelHexFormat _file;
+    File _image;
+    PageVector _pages;
     uint8_t *_pageBuffer;
     static constexpr uint8_t _pageSize = 128;
-    uint16_t _pageAddress;
-    uint16_t _pagePosition;
     uint16_t _verified;
+    Stats _stats;
 
 private:
     void _status(const String &message);
@@ -247,7 +274,7 @@ private:
 
 private:
     void _startPosition(const String &message);
-    void _updatePosition();
+    void _updatePosition(uint16_t index);
     void _endPosition(const String &message, bool error);
 
 private:
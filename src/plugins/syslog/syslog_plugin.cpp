@@ -106,7 +106,7 @@ void SyslogPlugin::_begin()
                 auto syslog = _syslog; // pass a copy of the pointer in case _syslog gets destroyed before the callback
                 config.resolveZeroConf(getFriendlyName(), hostname, port, [syslog](const String &hostname, const IPAddress &address, uint16_t port, const String &resolved, MDNSResolver::ResponseType type) {
                     getInstance()._zeroConfCallback(syslog, hostname, address, port, type);
-                });
+                }, true);
             }
 
         }
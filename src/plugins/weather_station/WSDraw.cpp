@@ -7,6 +7,7 @@
 #include <stl_ext/memory.h>
 #include <GFXCanvasConfig.h>
 #include <locale.h>
+#include <algorithm>
 #if DEBUG_GFXCANVAS_STATS
 #include <GFXCanvasStats.h>
 #endif
@@ -98,6 +99,10 @@ namespace WSDraw {
         _location(F("Unknown")),
         _textFont(nullptr),
         _lastTime(0),
+        #if HAVE_WEATHER_STATION_ANALOG_CLOCK
+            _analogClockHands{-1, -1, -1},
+            _analogClockBottom(0xff),
+        #endif
         _scrollPosition(0),
         _currentScreen(ScreenType::MAIN),
         _redrawFlag(false),
@@ -130,19 +135,19 @@ namespace WSDraw {
         _canvas->drawTextAligned(X_POSITION_MOON_PHASE_DAYS, Y_POSITION_MOON_PHASE_PCT, PrintString(F("%.1f%%"), moon.moonPhaseIlluminationPct()), H_POSITION_MOON_PHASE_NAME);
 
 
-        auto &info = _weatherApi.getInfo();
-        if (info.hasData()) {
+        if (_snapshot.hasData()) {
+            auto &info = _snapshot.get();
             _canvas->setTextColor(COLORS_SUN_RISE_SET);
             _canvas->drawBitmap(X_POSITION_SUN_RISE_ICON, Y_POSITION_SUN_RISE_ICON, icon_sunrise, 7, 9, COLORS_BACKGROUND, COLORS_SUN_RISE_SET);
             _canvas->drawBitmap(X_POSITION_SUN_SET_ICON, Y_POSITION_SUN_SET_ICON, icon_sunset, 7, 9, COLORS_BACKGROUND, COLORS_SUN_RISE_SET);
 
             char buf[8];
             auto timeFormat = PSTR("%H:%M");
-            time_t time = info.getSunRiseAsGMT();
+            time_t time = info.sunrise;
             struct tm *tm = gmtime(&time);
             strftime_P(buf, sizeof(buf), timeFormat, tm);
             _canvas->drawTextAligned(X_POSITION_SUN_SET, Y_POSITION_SUN_RISE, buf, H_POSITION_SUN_RISE);
-            time = info.getSunSetAsGMT();
+            time = info.sunset;
             tm = gmtime(&time);
             strftime_P(buf, sizeof(buf), timeFormat, tm);
             _canvas->drawTextAligned(X_POSITION_SUN_SET, Y_POSITION_SUN_SET, buf, H_POSITION_SUN_SET);
@@ -180,11 +185,11 @@ namespace WSDraw {
     void Base::_drawLocalWeather()
     {
         constexpr int16_t _offsetY = Y_START_POSITION_WEATHER;
-        auto &info = _weatherApi.getInfo();
-        if (info.hasData()) {
+        if (_snapshot.hasData()) {
+            auto &info = _snapshot.get();
 
             // --- weather icon
-            _canvas->drawBitmap(X_POSITION_WEATHER_ICON, Y_POSITION_WEATHER_ICON, getMiniIconFromProgmem(info.current.icon), palette);
+            _canvas->drawBitmap(X_POSITION_WEATHER_ICON, Y_POSITION_WEATHER_ICON, getMiniIconFromProgmem(info.icon), palette);
 
             // --- location
             // create kind of shadow effect in case the text is drawn over the icon
@@ -204,7 +209,7 @@ namespace WSDraw {
 
             _canvas->setFont(FONTS_TEMPERATURE);
             _canvas->setTextColor(COLORS_TEMPERATURE);
-            _canvas->drawTextAligned(X_POSITION_TEMPERATURE, Y_POSITION_TEMPERATURE, _getTemperature(info.current.temperature), H_POSITION_TEMPERATURE);
+            _canvas->drawTextAligned(X_POSITION_TEMPERATURE, Y_POSITION_TEMPERATURE, _getTemperature(WeatherSnapshot::toFloat(info.temperature)), H_POSITION_TEMPERATURE);
 
             // --- weather description
 
@@ -212,7 +217,7 @@ namespace WSDraw {
             _canvas->setTextColor(COLORS_WEATHER_DESCR);
 
             AdafruitGFXExtension::Position_t pos;
-            String tmp = info.current.descr;
+            String tmp = info.descr;
             if (tmp.length() > 10) {
                 auto idx = tmp.indexOf(' ', 7); // wrap after first word thats longer than 7 characters and align to the right
                 if (idx != -1) {
@@ -298,16 +303,13 @@ namespace WSDraw {
     void Base::_drawForecast()
     {
         constexpr int16_t _offsetY = Y_START_POSITION_FORECAST;
-        auto &info = _weatherApi.getInfo();
-        if (info.hasData()) {
+        if (_snapshot.hasData()) {
+            auto &info = _snapshot.get();
             int xStart = 0;
             constexpr int width = (TFT_WIDTH / MAX_FORECAST_DAYS) + 1;
-            int num = 0;
 
-            for(auto const &item: info.daily) {
-                if (num++ >= MAX_FORECAST_DAYS) {
-                    break;
-                }
+            for(uint8_t num = 0; num < info.numDays && num < MAX_FORECAST_DAYS; num++) {
+                auto &item = info.daily[num];
 
                 // icon
                 _canvas->drawBitmap(xStart, Y_POSITION_FORECAST_ICON, getMiniIconFromProgmem(item.icon), palette);
@@ -316,7 +318,8 @@ namespace WSDraw {
                 _canvas->setFont(FONTS_FORECAST_DAY);
                 _canvas->setTextColor(COLORS_FORECAST_DAY);
                 PrintString day;
-                auto tm = gmtime(&item.dt);
+                auto dt = item.getTime();
+                auto tm = gmtime(&dt);
                 day.strftime_P(PSTR("%a"), tm);
                 _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_DAY, day, AdafruitGFXExtension::CENTER);
 
@@ -324,12 +327,12 @@ namespace WSDraw {
                 _canvas->setFont(FONTS_FORECAST_DESCR);
                 _canvas->setTextColor(COLORS_FORECAST_TEMP);
                 AdafruitGFXExtension::Position_t pos;
-                _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_TEMP, _getTemperature(item.temperature_max), AdafruitGFXExtension::CENTER, AdafruitGFXExtension::TOP, &pos);
-                _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_TEMP + pos.h + 2, _getTemperature(item.temperature_min), AdafruitGFXExtension::CENTER, AdafruitGFXExtension::TOP);
+                _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_TEMP, _getTemperature(WeatherSnapshot::toFloat(item.temperatureMax)), AdafruitGFXExtension::CENTER, AdafruitGFXExtension::TOP, &pos);
+                _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_TEMP + pos.h + 2, _getTemperature(WeatherSnapshot::toFloat(item.temperatureMin)), AdafruitGFXExtension::CENTER, AdafruitGFXExtension::TOP);
 
                 // temperature
                 _canvas->setTextColor(COLORS_FORECAST_RAIN);
-                _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_RAIN + ((pos.h + 2) * 2), _getTemperature(item.temperature), AdafruitGFXExtension::CENTER, AdafruitGFXExtension::TOP);
+                _canvas->drawTextAligned(xStart + (width / 2), Y_POSITION_FORECAST_RAIN + ((pos.h + 2) * 2), _getTemperature(WeatherSnapshot::toFloat(item.temperature)), AdafruitGFXExtension::CENTER, AdafruitGFXExtension::TOP);
 
                 xStart += width;
 
@@ -421,95 +424,249 @@ namespace WSDraw {
 
         #define USE_HOUR_CIRCLE_MARKERS 0
 
-        void Base::_drawAnalogClockMarkers(int16_t centerX, int16_t centerY, int16_t angle, int16_t radius, int16_t length, uint16_t color)
-        {
-            // const float rAngle = angle * DEG_TO_RAD;
-            const float rAngle = angle / RAD_TO_DEG;
+        namespace AnalogClock {
 
-            int16_t x1 = centerX + (sin(rAngle) * radius);
-            int16_t y1 = centerY - (cos(rAngle) * radius);
-            int16_t x2, y2;
-            #if USE_HOUR_CIRCLE_MARKERS
-                if (length < 0) {
-                    _canvas->fillCircle(x1, y1, -length, color);
-                    return;
-                }
-            #endif
-            if (length) {
-                x2 = centerX + (sin(rAngle) * (radius - length));
-                y2 = centerY - (cos(rAngle) * (radius - length));
-            }
-            else {
-                x2 = centerX;
-                y2 = centerY;
-            }
-            _canvas->drawLine(x1, y1, x2, y2, color);
-        }
+            #define FILL_INNER_CLOCK_CIRCLE 0 // filled circles are really slow
 
-        void Base::_drawAnalogClock()
-        {
             constexpr uint8_t kSpacing = 13; // spacing on both sides
             constexpr int16_t kMaxSize = std::min(TFT_WIDTH, TFT_HEIGHT) - (kSpacing * 2); // max size of the circle
             constexpr int16_t kOuterCircleRadius = kMaxSize / 2;
             constexpr uint8_t kInnerCircleRadius = 4;
-            constexpr int16_t offsetX = (TFT_WIDTH - kMaxSize) / 2; // center of the screen
-            constexpr int16_t offsetY = 1;
+            constexpr int16_t kOffsetX = (TFT_WIDTH - kMaxSize) / 2; // center of the screen
+            constexpr int16_t kOffsetY = 1;
+            constexpr int16_t kCenterX = kOffsetX + kOuterCircleRadius;
+            constexpr int16_t kCenterY = kOffsetY + kOuterCircleRadius;
+            constexpr int16_t kSecondsLineLength = kOuterCircleRadius - 5;
+            constexpr int16_t kMinuteLineLength = kOuterCircleRadius * 0.65;
+            constexpr int16_t kHourLineLength = kOuterCircleRadius * 0.5;
+            constexpr uint8_t kHourMarkerLineLength = 8;
+            constexpr uint8_t kSecondMarkerLineLength = 3;
+            #if FILL_INNER_CLOCK_CIRCLE
+                constexpr uint16_t kBackgroundColor = COLORS_ANALOG_CLOCK_BACKGROUND;
+            #else
+                constexpr uint16_t kBackgroundColor = COLORS_BACKGROUND;
+            #endif
 
-            _lastTime = time(nullptr);
-            auto tm = localtime(&_lastTime);
+            // sin(0-90°) * 16384
+            static const uint16_t kSineTable[91] PROGMEM = {
+                0, 286, 572, 857, 1143, 1428, 1713, 1997, 2280, 2563,
+                2845, 3126, 3406, 3686, 3964, 4240, 4516, 4790, 5063, 5334,
+                5604, 5872, 6138, 6402, 6664, 6924, 7182, 7438, 7692, 7943,
+                8192, 8438, 8682, 8923, 9162, 9397, 9630, 9860, 10087, 10311,
+                10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+                12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+                14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+                15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+                16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+                16384
+            };
 
-            if ((tm->tm_sec / 5) % 2 == 0) {
-                _drawIndoorClimateBottom();
+            inline int32_t isin(int16_t angle)
+            {
+                angle %= 360;
+                if (angle < 0) {
+                    angle += 360;
+                }
+                if (angle <= 90) {
+                    return pgm_read_word(&kSineTable[angle]);
+                }
+                if (angle <= 180) {
+                    return pgm_read_word(&kSineTable[180 - angle]);
+                }
+                if (angle <= 270) {
+                    return -static_cast<int32_t>(pgm_read_word(&kSineTable[angle - 180]));
+                }
+                return -static_cast<int32_t>(pgm_read_word(&kSineTable[360 - angle]));
             }
-            else {
-                _drawDateBottom(tm);
+
+            inline int16_t getX(int16_t angle, int16_t radius)
+            {
+                return kCenterX + ((isin(angle) * radius + 8192) >> 14);
             }
-            constexpr int16_t kCenterX = offsetX + kOuterCircleRadius;
-            constexpr int16_t kCenterY = offsetY + kOuterCircleRadius;
 
-            #define FILL_INNER_CLOCK_CIRCLE 0 // filled circles are really slow
+            inline int16_t getY(int16_t angle, int16_t radius)
+            {
+                return kCenterY - ((isin(angle + 90) * radius + 8192) >> 14);
+            }
+
+            // the outer circles are only touched by areas that reach the edge of the face
+            inline bool isCircleDirty(const Base::AnalogClockBox &box)
+            {
+                constexpr int32_t kMinDistance = (kOuterCircleRadius - 1) * (kOuterCircleRadius - 1);
+                int32_t dx = std::max(std::abs(box.x1 - kCenterX), std::abs(box.x2 - kCenterX));
+                int32_t dy = std::max(std::abs(box.y1 - kCenterY), std::abs(box.y2 - kCenterY));
+                return box.isValid() && (dx * dx) + (dy * dy) >= kMinDistance;
+            }
+
+        }
+
+        Base::AnalogClockBox Base::_drawAnalogClockMarker(int16_t angle, int16_t radius, int16_t length, uint16_t color, const AnalogClockBox *dirty, uint8_t numDirty)
+        {
+            using namespace AnalogClock;
+
+            int16_t x1 = getX(angle, radius);
+            int16_t y1 = getY(angle, radius);
+            int16_t x2 = kCenterX;
+            int16_t y2 = kCenterY;
+            if (length > 0) {
+                x2 = getX(angle, radius - length);
+                y2 = getY(angle, radius - length);
+            }
+            AnalogClockBox box(x1, y1, x2, y2);
+            #if USE_HOUR_CIRCLE_MARKERS
+                if (length < 0) {
+                    box = AnalogClockBox(x1 + length, y1 + length, x1 - length, y1 - length);
+                }
+            #endif
+            if (dirty) {
+                auto end = dirty + numDirty;
+                if (std::find_if(dirty, end, [&box](const AnalogClockBox &item) { return item.intersects(box); }) == end) {
+                    return box;
+                }
+            }
+            #if USE_HOUR_CIRCLE_MARKERS
+                if (length < 0) {
+                    _canvas->fillCircle(x1, y1, -length, color);
+                    return box;
+                }
+            #endif
+            _canvas->drawLine(x1, y1, x2, y2, color);
+            return box;
+        }
+
+        void Base::_drawAnalogClockFace(const AnalogClockBox *dirty, uint8_t numDirty)
+        {
+            using namespace AnalogClock;
 
             #if FILL_INNER_CLOCK_CIRCLE
-                _canvas->fillCircle(kCenterX, kCenterY, kOuterCircleRadius, COLORS_WHITE);
-                _canvas->fillCircle(kCenterX, kCenterY, kOuterCircleRadius - 2, COLORS_ANALOG_CLOCK_BACKGROUND);
+                if (!dirty) {
+                    _canvas->fillCircle(kCenterX, kCenterY, kOuterCircleRadius, COLORS_WHITE);
+                    _canvas->fillCircle(kCenterX, kCenterY, kOuterCircleRadius - 2, COLORS_ANALOG_CLOCK_BACKGROUND);
+                }
             #endif
 
             // hour markers
             for(int16_t i = 0; i < 360; i += (360 / 12)) {
                 #if USE_HOUR_CIRCLE_MARKERS
                     // circles
-                    _drawAnalogClockMarkers(kCenterX, kCenterY, i, kOuterCircleRadius - 3, -3, COLORS_RED);
+                    _drawAnalogClockMarker(i, kOuterCircleRadius - 3, -3, COLORS_RED, dirty, numDirty);
                 #else
                     // lines
-                    constexpr uint8_t kHourMarkerLineLength = 8;
-                    _drawAnalogClockMarkers(kCenterX, kCenterY, i, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED);
-                    _drawAnalogClockMarkers(kCenterX, kCenterY, i + 1, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED);
-                    _drawAnalogClockMarkers(kCenterX, kCenterY, i - 1, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED);
+                    _drawAnalogClockMarker(i, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED, dirty, numDirty);
+                    _drawAnalogClockMarker(i + 1, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED, dirty, numDirty);
+                    _drawAnalogClockMarker(i - 1, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED, dirty, numDirty);
                 #endif
             }
 
             // second markers
             for(int16_t i = 0; i < 360; i += (360 / 60)) {
-                constexpr uint8_t kHourMarkerLineLength = 3;
-                _drawAnalogClockMarkers(kCenterX, kCenterY, i, kOuterCircleRadius - 2, kHourMarkerLineLength, COLORS_RED);
+                _drawAnalogClockMarker(i, kOuterCircleRadius - 2, kSecondMarkerLineLength, COLORS_RED, dirty, numDirty);
             }
 
             // outer and inner circle
             #if !FILL_INNER_CLOCK_CIRCLE
-                _canvas->drawCircle(kCenterX, kCenterY, kOuterCircleRadius, COLORS_WHITE);
-                _canvas->drawCircle(kCenterX, kCenterY, kOuterCircleRadius - 1, COLORS_WHITE);
+                if (!dirty || std::any_of(dirty, dirty + numDirty, isCircleDirty)) {
+                    _canvas->drawCircle(kCenterX, kCenterY, kOuterCircleRadius, COLORS_WHITE);
+                    _canvas->drawCircle(kCenterX, kCenterY, kOuterCircleRadius - 1, COLORS_WHITE);
+                }
             #endif
+            // the hands always touch the center
             _canvas->fillCircle(kCenterX, kCenterY, kInnerCircleRadius, COLORS_WHITE);
+        }
+
+        void Base::_drawAnalogClockBottom(struct tm *tm)
+        {
+            _analogClockBottom = (tm->tm_sec / 5) % 2;
+            if (_analogClockBottom == 0) {
+                _drawIndoorClimateBottom();
+            }
+            else {
+                _drawDateBottom(tm);
+            }
+        }
+
+        void Base::_drawAnalogClock()
+        {
+            using namespace AnalogClock;
+
+            _lastTime = time(nullptr);
+            auto tm = localtime(&_lastTime);
+
+            _drawAnalogClockBottom(tm);
+            _drawAnalogClockFace();
 
             // hands
-            constexpr int16_t kSecondsLineLength = kOuterCircleRadius - 5;
-            _drawAnalogClockMarkers(kCenterX, kCenterY, (tm->tm_sec * 6), kSecondsLineLength, 0, COLORS_YELLOW);
+            _analogClockHands[0] = tm->tm_sec * 6;
+            _analogClockHands[1] = tm->tm_min * 6;
+            _analogClockHands[2] = (tm->tm_hour * 30) + (tm->tm_min / 2);
+            _drawAnalogClockMarker(_analogClockHands[0], kSecondsLineLength, 0, COLORS_YELLOW);
+            _drawAnalogClockMarker(_analogClockHands[1], kMinuteLineLength, 0, COLORS_YELLOW);
+            _drawAnalogClockMarker(_analogClockHands[2], kHourLineLength, 0, COLORS_YELLOW);
+        }
 
-            constexpr int16_t kMinuteLineLength = kOuterCircleRadius * 0.65;
-            _drawAnalogClockMarkers(kCenterX, kCenterY, (tm->tm_min * 6) /* + (tm->tm_sec / 10)*/, kMinuteLineLength, 0, COLORS_YELLOW);
+        void Base::_updateAnalogClock()
+        {
+            using namespace AnalogClock;
 
-            constexpr int16_t kHourLineLength = kOuterCircleRadius * 0.5;
-            _drawAnalogClockMarkers(kCenterX, kCenterY, (tm->tm_hour * 30) + (tm->tm_min / 2), kHourLineLength, 0, COLORS_YELLOW);
+            _lastTime = time(nullptr);
+            auto tm = localtime(&_lastTime);
+
+            const int16_t hands[3] = { static_cast<int16_t>(tm->tm_sec * 6), static_cast<int16_t>(tm->tm_min * 6), static_cast<int16_t>((tm->tm_hour * 30) + (tm->tm_min / 2)) };
+            const int16_t lengths[3] = { kSecondsLineLength, kMinuteLineLength, kHourLineLength };
+
+            AnalogClockBox dirty[kAnalogClockMaxDirty];
+            uint8_t numDirty = 0;
+
+            // erase hands that have been moved
+            for(uint8_t i = 0; i < 3; i++) {
+                if (_analogClockHands[i] != hands[i]) {
+                    auto &box = dirty[numDirty++];
+                    if (_analogClockHands[i] != -1) {
+                        box = _drawAnalogClockMarker(_analogClockHands[i], lengths[i], 0, kBackgroundColor);
+                    }
+                    box.add(AnalogClockBox(getX(hands[i], lengths[i]), getY(hands[i], lengths[i]), kCenterX, kCenterY));
+                    _analogClockHands[i] = hands[i];
+                }
+            }
+
+            // the bottom line is drawn below the face and must be redrawn if it has been changed or erased by a hand
+            AnalogClockBox bottom(0, Y_START_POSITION_INDOOR_BOTTOM, TFT_WIDTH - 1, Y_END_POSITION_INDOOR_BOTTOM - 1);
+            if (_analogClockBottom != (tm->tm_sec / 5) % 2 || std::any_of(dirty, dirty + numDirty, [&bottom](const AnalogClockBox &box) { return box.intersects(bottom); })) {
+                _clearPartially(Y_START_POSITION_INDOOR_BOTTOM, Y_END_POSITION_INDOOR_BOTTOM, COLORS_BACKGROUND);
+                _drawAnalogClockBottom(tm);
+                dirty[numDirty++] = bottom;
+            }
+
+            if (!numDirty) {
+                return;
+            }
+
+            // restore the face and draw all hands since they might overlap
+            _drawAnalogClockFace(dirty, numDirty);
+            for(uint8_t i = 0; i < 3; i++) {
+                _drawAnalogClockMarker(hands[i], lengths[i], 0, COLORS_YELLOW);
+            }
+
+            // merge overlapping areas to transfer each pixel once
+            for(uint8_t i = 0; i < numDirty; i++) {
+                for(uint8_t j = i + 1; j < numDirty; j++) {
+                    if (dirty[i].intersects(dirty[j])) {
+                        dirty[i].add(dirty[j]);
+                        dirty[j] = dirty[--numDirty];
+                        // start over with the merged area
+                        j = i;
+                    }
+                }
+            }
+
+            for(uint8_t i = 0; i < numDirty; i++) {
+                auto &box = dirty[i];
+                int16_t x1 = std::max<int16_t>(0, box.x1);
+                int16_t y1 = std::max<int16_t>(0, box.y1);
+                int16_t x2 = std::min<int16_t>(TFT_WIDTH - 1, box.x2);
+                int16_t y2 = std::min<int16_t>(TFT_HEIGHT - 1, box.y2);
+                _displayScreen(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+            }
         }
 
     #endif
@@ -621,9 +778,7 @@ namespace WSDraw {
 
         void Base::_updateScreenAnalogClock()
         {
-            CLEAR_AND_DISPLAY(Y_START_POSITION_ANALOG_CLOCK, Y_END_POSITION_INDOOR_BOTTOM) {
-                _drawAnalogClock();
-            }
+            _updateAnalogClock();
         }
 
     #endif
@@ -22,6 +22,7 @@
 #include <stl_ext/memory.h>
 #include "fonts/fonts.h"
 #include "moon_phase.h"
+#include "WeatherSnapshot.h"
 #include <vector>
 
 #ifndef _MSC_VER
@@ -218,9 +219,42 @@ namespace WSDraw {
         void _drawWorldClock();
 
         #if HAVE_WEATHER_STATION_ANALOG_CLOCK
+            // area of the analog clock that has been changed
+            struct AnalogClockBox {
+                int16_t x1;
+                int16_t y1;
+                int16_t x2;
+                int16_t y2;
+
+                AnalogClockBox() : x1(0), y1(0), x2(-1), y2(-1) {}
+                AnalogClockBox(int16_t ax, int16_t ay, int16_t bx, int16_t by) : x1(std::min(ax, bx)), y1(std::min(ay, by)), x2(std::max(ax, bx)), y2(std::max(ay, by)) {}
+
+                bool isValid() const {
+                    return x2 >= x1 && y2 >= y1;
+                }
+                bool intersects(const AnalogClockBox &box) const {
+                    return isValid() && box.isValid() && x1 <= box.x2 && box.x1 <= x2 && y1 <= box.y2 && box.y1 <= y2;
+                }
+                void add(const AnalogClockBox &box) {
+                    if (!isValid()) {
+                        *this = box;
+                    }
+                    else if (box.isValid()) {
+                        *this = AnalogClockBox(std::min(x1, box.x1), std::min(y1, box.y1), std::max(x2, box.x2), std::max(y2, box.y2));
+                    }
+                }
+            };
+
+            static constexpr uint8_t kAnalogClockMaxDirty = 4;
+
             // draw analog clock
-            void _drawAnalogClockMarkers(int16_t centerX, int16_t centerY, int16_t angle, int16_t radius, int16_t length, uint16_t color);
+            AnalogClockBox _drawAnalogClockMarker(int16_t angle, int16_t radius, int16_t length, uint16_t color, const AnalogClockBox *dirty = nullptr, uint8_t numDirty = 0);
+            // draw the static parts of the face that intersect with the dirty areas or all if dirty is nullptr
+            void _drawAnalogClockFace(const AnalogClockBox *dirty = nullptr, uint8_t numDirty = 0);
+            void _drawAnalogClockBottom(struct tm *tm);
             void _drawAnalogClock();
+            // erase and redraw the hands that have been changed and display the changed areas only
+            void _updateAnalogClock();
         #endif
 
         #if HAVE_WEATHER_STATION_INFO_SCREEN
@@ -421,6 +455,8 @@ namespace WSDraw {
         #endif
         ScrollCanvas *_scrollCanvas;
         OpenWeatherMapAPI _weatherApi;
+        // the weather is displayed from the snapshot of the last response
+        WeatherSnapshot _snapshot;
         String _location;
         ConfigType _config;
         Event::Timer _displayMessageTimer;
@@ -428,6 +464,11 @@ namespace WSDraw {
         const GFXfont *_textFont;
         SemaphoreMutex _lock;
         time_t _lastTime;
+        #if HAVE_WEATHER_STATION_ANALOG_CLOCK
+            // angles of the second, minute and hour hands, -1 if not drawn
+            int16_t _analogClockHands[3];
+            uint8_t _analogClockBottom;
+        #endif
         uint8_t _scrollPosition;
         ScreenType _currentScreen;
         volatile bool _redrawFlag;
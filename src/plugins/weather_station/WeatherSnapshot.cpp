@@ -0,0 +1,107 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <PrintString.h>
+#include <kfc_fw_config.h>
+#include "RTCMemoryManager.h"
+#include "WeatherSnapshot.h"
+
+#if DEBUG_IOT_WEATHER_STATION
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+#define WEATHER_SNAPSHOT_FILE "/.pvt/weather.snapshot"
+
+using namespace WSDraw;
+
+WeatherSnapshot::WeatherSnapshot() : _data(), _location(0), _hasData(false)
+{
+}
+
+bool WeatherSnapshot::begin(float latitude, float longitude)
+{
+    PrintString location(F("%.4f,%.4f"), latitude, longitude);
+    _location = crc32(location.c_str(), location.length());
+    _hasData = false;
+
+    // RTC memory is the most recent copy
+    if (RTCMemoryManager::read(RTCMemoryManager::RTCMemoryId::WEATHER_STATION, &_data, sizeof(_data)) && _data.isValid()) {
+        __LDBG_printf("loaded from RTC memory time=%u", _data.time);
+    }
+    else {
+        auto file = KFCFS.open(F(WEATHER_SNAPSHOT_FILE), fs::FileOpenMode::read);
+        if (!file || file.read(reinterpret_cast<uint8_t *>(&_data), sizeof(_data)) != sizeof(_data) || !_data.isValid()) {
+            _data = Data();
+            return false;
+        }
+        __LDBG_printf("loaded from file time=%u", _data.time);
+        RTCMemoryManager::write(RTCMemoryManager::RTCMemoryId::WEATHER_STATION, &_data, sizeof(_data));
+    }
+    if (_data.location != _location) {
+        __LDBG_printf("location changed");
+        _data = Data();
+        return false;
+    }
+    _hasData = true;
+    return true;
+}
+
+void WeatherSnapshot::clear()
+{
+    _data = Data();
+    _hasData = false;
+    RTCMemoryManager::remove(RTCMemoryManager::RTCMemoryId::WEATHER_STATION);
+    String filename = F(WEATHER_SNAPSHOT_FILE);
+    if (KFCFS.exists(filename)) {
+        KFCFS.remove(filename);
+    }
+}
+
+int32_t WeatherSnapshot::getAge() const
+{
+    auto now = time(nullptr);
+    if (!_hasData || !_data.time || !isTimeValid(now)) {
+        return -1;
+    }
+    return std::max<int32_t>(0, now - _data.time);
+}
+
+void WeatherSnapshot::dump(Print &output) const
+{
+    if (!_hasData) {
+        output.print(F("No weather snapshot\n"));
+        return;
+    }
+    output.printf_P(PSTR("Weather snapshot age=%d file_time=%u size=%u temperature=%.1f icon=%s descr=%s days=%u\n"),
+        getAge(), _data.fileTime, sizeof(_data), toFloat(_data.temperature), _data.icon, _data.descr, _data.numDays
+    );
+}
+
+void WeatherSnapshot::_save()
+{
+    // avoid writing the file for each update
+    bool writeFile = !_data.fileTime || (_data.time - _data.fileTime) >= IOT_WEATHER_STATION_SNAPSHOT_WRITE_INTERVAL;
+    if (writeFile) {
+        _data.fileTime = _data.time;
+    }
+    _data.crc = _data.calcCrc();
+    RTCMemoryManager::write(RTCMemoryManager::RTCMemoryId::WEATHER_STATION, &_data, sizeof(_data));
+    if (writeFile) {
+        auto file = KFCFS.open(F(WEATHER_SNAPSHOT_FILE), fs::FileOpenMode::write);
+        if (file) {
+            file.write(reinterpret_cast<const uint8_t *>(&_data), sizeof(_data));
+            file.close();
+        }
+    }
+    __LDBG_printf("time=%u write_file=%u", _data.time, writeFile);
+}
+
+void WeatherSnapshot::_copy(char *dst, const String &src, size_t size)
+{
+    strncpy(dst, src.c_str(), size - 1);
+    dst[size - 1] = 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino_compat.h>
+
+// Last known weather
+//
+// The values displayed from the OpenWeather response are stored as a compact binary snapshot in RTC memory and in a
+// file. The snapshot is displayed immediately after booting and the API is not polled before the snapshot is older
+// than the poll interval
+
+// minimum time between writing the snapshot to the file system. time in seconds
+#ifndef IOT_WEATHER_STATION_SNAPSHOT_WRITE_INTERVAL
+#    define IOT_WEATHER_STATION_SNAPSHOT_WRITE_INTERVAL 3600
+#endif
+
+namespace WSDraw {
+
+    class WeatherSnapshot {
+    public:
+        static constexpr uint32_t kMagic = 0x53573157; // W1WS
+        static constexpr uint8_t kMaxDays = 5;
+        static constexpr uint8_t kIconSize = 4;
+        static constexpr uint8_t kDescrSize = 32;
+
+        struct Day {
+            uint32_t dt;
+            // temperatures in 1/10 °C
+            int16_t temperature;
+            int16_t temperatureMin;
+            int16_t temperatureMax;
+            char icon[kIconSize];
+            uint16_t reserved;
+
+            time_t getTime() const {
+                return dt;
+            }
+        };
+
+        struct Data {
+            uint32_t magic;
+            // crc32 of latitude and longitude
+            uint32_t location;
+            // time of the API response, 0 = unknown
+            uint32_t time;
+            // time when the snapshot was written to the file
+            uint32_t fileTime;
+            uint32_t sunrise;
+            uint32_t sunset;
+            int16_t temperature;
+            char icon[kIconSize];
+            char descr[kDescrSize];
+            uint8_t numDays;
+            uint8_t reserved;
+            Day daily[kMaxDays];
+            uint32_t crc;
+
+            uint32_t calcCrc() const {
+                return crc32(this, offsetof(Data, crc));
+            }
+
+            bool isValid() const {
+                return magic == kMagic && crc == calcCrc();
+            }
+        };
+
+        static_assert((sizeof(Data) % sizeof(uint32_t)) == 0, "RTC memory requires 32bit alignment");
+
+    public:
+        WeatherSnapshot();
+
+        // load the snapshot from RTC memory or the file. the snapshot is discarded if the location does not match
+        bool begin(float latitude, float longitude);
+        // store the current and daily values of the API response
+        template<typename _Ta>
+        void update(const _Ta &info);
+        void clear();
+
+        bool hasData() const;
+        const Data &get() const;
+        // age in seconds, -1 if the time is not valid
+        int32_t getAge() const;
+
+        static float toFloat(int16_t value);
+        static int16_t fromFloat(float value);
+
+        void dump(Print &output) const;
+
+    private:
+        void _save();
+        static void _copy(char *dst, const String &src, size_t size);
+
+        Data _data;
+        uint32_t _location;
+        bool _hasData;
+    };
+
+    template<typename _Ta>
+    void WeatherSnapshot::update(const _Ta &info)
+    {
+        auto now = time(nullptr);
+        _data.magic = kMagic;
+        _data.location = _location;
+        _data.time = isTimeValid(now) ? now : 0;
+        _data.sunrise = info.getSunRiseAsGMT();
+        _data.sunset = info.getSunSetAsGMT();
+        _data.temperature = fromFloat(info.current.temperature);
+        _copy(_data.icon, info.current.icon, sizeof(_data.icon));
+        _copy(_data.descr, info.current.descr, sizeof(_data.descr));
+        _data.numDays = 0;
+        for(const auto &item: info.daily) {
+            if (_data.numDays >= kMaxDays) {
+                break;
+            }
+            auto &day = _data.daily[_data.numDays++];
+            day = Day();
+            day.dt = item.dt;
+            day.temperature = fromFloat(item.temperature);
+            day.temperatureMin = fromFloat(item.temperature_min);
+            day.temperatureMax = fromFloat(item.temperature_max);
+            _copy(day.icon, item.icon, sizeof(day.icon));
+        }
+        _hasData = true;
+        _save();
+    }
+
+    inline bool WeatherSnapshot::hasData() const
+    {
+        return _hasData;
+    }
+
+    inline const WeatherSnapshot::Data &WeatherSnapshot::get() const
+    {
+        return _data;
+    }
+
+    inline float WeatherSnapshot::toFloat(int16_t value)
+    {
+        return value / 10.0f;
+    }
+
+    inline int16_t WeatherSnapshot::fromFloat(float value)
+    {
+        return static_cast<int16_t>(lroundf(value * 10.0f));
+    }
+
+}
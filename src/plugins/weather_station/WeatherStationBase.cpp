@@ -17,6 +17,7 @@
 
 WeatherStationBase::WeatherStationBase() :
     _pollDataRetries(0),
+    _pollDataWaitForTime(0),
     _backlightLevel(1023),
     _updateCounter(0),
     _toggleScreenTimer(0),
@@ -27,15 +28,48 @@ WeatherStationBase::WeatherStationBase() :
 
 void WeatherStationBase::_pollDataTimerCallback(Event::CallbackTimerPtr timer)
 {
-    __LDBG_printf("api_key=%u", ws_plugin._weatherApi.hasApiKey());
-    if (ws_plugin._weatherApi.hasApiKey()) {
-        ws_plugin._getWeatherInfo([](int16_t code, KFCRestAPI::HttpRequest &request) {
+    auto delay = ws_plugin._getPollDataDelay();
+    if (delay) {
+        __LDBG_printf("snapshot age=%d next=%u", ws_plugin._snapshot.getAge(), delay);
+        _Timer(ws_plugin._pollDataTimer).add(Event::milliseconds(delay), false, _pollDataTimerCallback);
+        return;
+    }
+    ws_plugin._pollData();
+}
+
+void WeatherStationBase::_pollData()
+{
+    __LDBG_printf("api_key=%u", _weatherApi.hasApiKey());
+    if (_weatherApi.hasApiKey()) {
+        _getWeatherInfo([](int16_t code, KFCRestAPI::HttpRequest &request) {
             __LDBG_printf("response=%u", code);
             ws_plugin._openWeatherAPICallback(code, request);
         });
     }
 }
 
+uint32_t WeatherStationBase::_getPollDataDelay()
+{
+    uint32_t interval = _config.getPollIntervalMillis();
+    if (!interval || !_snapshot.hasData() || _pollDataRetries) {
+        return 0;
+    }
+    auto age = _snapshot.getAge();
+    if (age == -1) {
+        if (_pollDataWaitForTime < kPollDataWaitForTimeRetries) {
+            _pollDataWaitForTime++;
+            return kPollDataWaitForTimeDelay;
+        }
+        return 0;
+    }
+    // compare in seconds, the age in milliseconds overflows after 49.7 days
+    uint32_t ageSeconds = age;
+    if (ageSeconds >= interval / 1000U) {
+        return 0;
+    }
+    return std::max(kMinPollDataInterval, interval - (ageSeconds * 1000U));
+}
+
 void WeatherStationBase::_openWeatherAPICallback(int16_t code, KFCRestAPI::HttpRequest &request)
 {
     __LDBG_printf("code=%d message=%s url=%s", code, __S(request.getMessage()), __S(request.getUrl()));
@@ -52,6 +86,7 @@ void WeatherStationBase::_openWeatherAPICallback(int16_t code, KFCRestAPI::HttpR
         _pollDataUpdateLastTime(false);
     }
     else {
+        _snapshot.update(_weatherApi.getInfo());
         _pollDataUpdateLastTime(true);
     }
     redraw();
@@ -75,7 +110,8 @@ void WeatherStationBase::_wifiCallback(WiFiCallbacks::EventType event, void *pay
         #if IOT_WEATHER_STATION_WS2812_NUM
             _rainbowStatusLED();
         #endif
-        if (!_pollDataTimer) { // poll weather data if the timer is not active
+        _pollDataWaitForTime = 0;
+        if (!_pollDataTimer) { // poll weather data if the timer is not active, a fresh snapshot delays the request
             constexpr auto next = 1000;
             __LDBG_printf("poll weather next=%u", next);
             _Timer(_pollDataTimer).add(Event::milliseconds(next), false, _pollDataTimerCallback);
@@ -89,22 +125,22 @@ void WeatherStationBase::_wifiCallback(WiFiCallbacks::EventType event, void *pay
 
 void WeatherStationBase::_pollDataUpdateLastTime(bool success)
 {
-    auto next = _config.getPollIntervalMillis(); // default reload time
-    // reset retries on success
+    uint32_t next = _config.getPollIntervalMillis(); // default reload time, 0 = polling disabled
     if (success) {
         _pollDataRetries = 0;
+        if (next) {
+            next = std::max(kMinPollDataInterval, next);
+        }
+    }
+    else if (next) {
+        // exponential backoff with jitter
+        next = std::min<uint32_t>(kPollDataErrorDelay << std::min<uint16_t>(_pollDataRetries, 6), kPollDataMaxErrorDelay);
+        next = next - (next / 5) + random(next * 2 / 5);
+        _pollDataRetries++;
     }
     // add timer for next request
     if (next) {
-        if (_pollDataRetries > kPollDataRetries) {
-            // max retries reached, wait one hour...
-            next = 3600UL * 1000UL;
-        }
-        else {
-            // increase retry time after each failure
-            next *= (++_pollDataRetries / static_cast<float>(kPollDataRetries));
-        }
-        _Timer(_pollDataTimer).add(std::max(kMinPollDataInterval, next), false, _pollDataTimerCallback);
+        _Timer(_pollDataTimer).add(Event::milliseconds(next), false, _pollDataTimerCallback);
     }
     __LDBG_printf("success=%u retries=%u next=%u", success, _pollDataRetries, next);
 }
@@ -80,17 +80,20 @@ class WeatherStationBase : public WSDraw::Base
 {
 public:
     // in words:
-    // poll weather information 60 seconds after booting and continue with configured interval
-    // if an error occurs, retry after 60 seconds for 10 times, then retry every 15min.
+    // poll weather information after connecting to WiFi and continue with the configured interval. if the snapshot of
+    // the last response is younger than the interval, the request is delayed until it expires
+    // if an error occurs, retry after 60 seconds and double the delay after each failure up to one hour. the delay
+    // varies by +-20% to avoid that devices retry at the same time
 
-    // delay after boot or if any error occurred
+    // delay after the first error
     static constexpr auto kPollDataErrorDelay = static_cast<uint32_t>(Event::seconds(60).count());
-    // retries before pausing
-    static constexpr uint16_t kPollDataRetries = 10;
-    // pause for some time after too many errors
-    static constexpr auto kPollDataErrorPauseDelay = static_cast<uint32_t>(Event::minutes(15).count());
-    // min. delay between updates in case the configuration is invalid
+    // max. delay after errors
+    static constexpr auto kPollDataMaxErrorDelay = static_cast<uint32_t>(Event::minutes(60).count());
+    // min. delay between successful updates in case the configuration is invalid
     static constexpr auto kMinPollDataInterval = static_cast<uint32_t>(Event::minutes(2).count());
+    // if the time is not valid, the age of the snapshot is unknown. wait for the time being set before polling
+    static constexpr auto kPollDataWaitForTimeDelay = static_cast<uint32_t>(Event::seconds(5).count());
+    static constexpr uint8_t kPollDataWaitForTimeRetries = 6;
 
     static constexpr auto kNumScreens = WSDraw::kNumScreens;
     static constexpr auto kSkipScreen = WSDraw::kSkipScreen;
@@ -115,6 +118,9 @@ public:
     static void _pollDataTimerCallback(Event::CallbackTimerPtr timer);
     void _wifiCallback(WiFiCallbacks::EventType event, void *payload);
     void _pollDataUpdateLastTime(bool success);
+    // returns the time until the snapshot expires in milliseconds or 0 to poll now
+    uint32_t _getPollDataDelay();
+    void _pollData();
 
     void _httpRequest(const String &url, int timeout, JsonBaseReader *jsonReader, HttpRequestCallback callback);
     void _getWeatherInfo(HttpRequestCallback callback);
@@ -135,6 +141,7 @@ protected:
 protected:
     Event::Timer _pollDataTimer;
     uint16_t _pollDataRetries;
+    uint8_t _pollDataWaitForTime;
 
     uint16_t _backlightLevel;
     uint32_t _updateCounter;
@@ -336,6 +336,8 @@ void WeatherStationPlugin::_readConfig()
     _weatherApi.setGetDailyDescr(false);
     _weatherApi.setDailyLimit(MAX_FORECAST_DAYS);
     _weatherApi.clear();
+    // display the last known weather until the first response has been received
+    _snapshot.begin(_config.latitude, _config.longitude);
     _location = WSDraw::WSConfigType::getLocation();
     auto pos = _location.indexOf(',');
     if (pos > 0) {
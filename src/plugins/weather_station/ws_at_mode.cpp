@@ -19,7 +19,7 @@
 
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(WSSET, "WSSET", "<touchpad|timeformat24h|metric|tft|scroll|stats|lock|unlock|screen|screens>,<on|off|options>", "Enable/disable function");
 PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(WSBL, "WSBL", "<level=0-1023>", "Set backlight level");
-PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(WSU, "WSU", "<i|f>", "Update weather info/forecast");
+PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(WSU, "WSU", "[<snapshot|clear>]", "Update weather info/forecast, display or remove the last known weather");
 #if DEBUG_MOON_PHASE
     PROGMEM_AT_MODE_HELP_COMMAND_DEF_PPPN(WSM, "WSM", "<date YYYY-MM-DD>[,<days>]", "Show Moon Phase for given Date");
 #endif
@@ -161,8 +161,21 @@ bool WeatherStationPlugin::atModeHandler(AtModeArgs &args)
         return true;
     }
     else if (args.isCommand(PROGMEM_AT_MODE_HELP_COMMAND(WSU))) {
-        args.print(F("Updating weather info..."));
-        _Timer(_pollDataTimer).add(Event::milliseconds(100), false, _pollDataTimerCallback);
+        if (args.equalsIgnoreCase(0, F("snapshot"))) {
+            _snapshot.dump(args.getStream());
+            args.print(F("poll retries=%u"), _pollDataRetries);
+        }
+        else if (args.equalsIgnoreCase(0, F("clear"))) {
+            _snapshot.clear();
+            args.print(F("snapshot removed"));
+        }
+        else {
+            // the request is sent even if the snapshot is fresh
+            args.print(F("Updating weather info..."));
+            _Timer(_pollDataTimer).add(Event::milliseconds(100), false, [this](Event::CallbackTimerPtr) {
+                _pollData();
+            });
+        }
         return true;
     }
     #if DEBUG_MOON_PHASE
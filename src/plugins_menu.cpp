@@ -0,0 +1,389 @@
+/**
+  Author: sascha_lammers@gmx.de
+*/
+
+#include <Arduino_compat.h>
+#include "PluginComponent.h"
+#include "plugins_menu.h"
+#include "kfc_fw_config.h"
+#include "misc.h"
+
+#if DEBUG_PLUGINS
+#    include "debug_helper_enable.h"
+#else
+#    include "debug_helper_disable.h"
+#endif
+
+// --------------------------------------------------------------------
+// static menu stored in PROGMEM
+// --------------------------------------------------------------------
+
+static const char _menu_label_manage_wifi[] PROGMEM = "Manage WiFi";
+static const char _menu_label_configure_network[] PROGMEM = "Configure Network";
+static const char _menu_label_about[] PROGMEM = "About";
+static const char _menu_label_remote_access[] PROGMEM = "Remote Access";
+static const char _menu_label_factory_defaults[] PROGMEM = "Restore Factory Defaults";
+static const char _menu_label_export_settings[] PROGMEM = "Export Settings";
+static const char _menu_label_utilities[] PROGMEM = "Utilities";
+static const char _menu_uri_about[] PROGMEM = "about.html";
+static const char _menu_uri_export_settings[] PROGMEM = "export-settings";
+#if WEBSERVER_KFC_OTA
+static const char _menu_label_update_firmware[] PROGMEM = "Update Firmware";
+#endif
+#if ENABLE_ARDUINO_OTA && !ENABLE_ARDUINO_OTA_AUTOSTART
+static const char _menu_label_enable_arduino_ota[] PROGMEM = "Enable ArduinoOTA";
+static const char _menu_uri_start_arduino_ota[] PROGMEM = "start-arduino-ota";
+#endif
+#if WEBSERVER_SPEED_TEST
+static const char _menu_label_speed_test[] PROGMEM = "Speed Test";
+static const char _menu_uri_speed_test[] PROGMEM = "speed-test.html";
+#endif
+
+// order must match WebMenu::MenuType
+static const WebMenu::StaticMenu_t _staticMenus[] PROGMEM = {
+    { SPGM(Home), SPGM(index_html) }, // since "home" has an URI, the items are only displayed on the index page
+    { SPGM(Status), SPGM(status_html) },
+    { SPGM(Configuration), nullptr },
+    { SPGM(Device), nullptr },
+    { SPGM(Admin), nullptr },
+    { _menu_label_utilities, nullptr }
+};
+
+static_assert(sizeof(_staticMenus) / sizeof(_staticMenus[0]) == WebMenu::getId(WebMenu::MenuType::MAX), "size does not match");
+
+static const WebMenu::StaticItem_t _staticItems[] PROGMEM = {
+    { SPGM(Home), SPGM(index_html), WebMenu::MenuType::HOME },
+    { SPGM(Status), SPGM(status_html), WebMenu::MenuType::HOME },
+    { _menu_label_manage_wifi, SPGM(wifi_html), WebMenu::MenuType::HOME },
+    { _menu_label_configure_network, SPGM(network_html), WebMenu::MenuType::HOME },
+    { SPGM(Change_Password), SPGM(password_html), WebMenu::MenuType::HOME },
+    { SPGM(Reboot_Device), SPGM(reboot_html), WebMenu::MenuType::HOME },
+    { _menu_label_about, _menu_uri_about, WebMenu::MenuType::HOME },
+
+    { SPGM(WiFi), SPGM(wifi_html), WebMenu::MenuType::CONFIG },
+    { SPGM(Network), SPGM(network_html), WebMenu::MenuType::CONFIG },
+    { SPGM(Device), SPGM(device_html), WebMenu::MenuType::CONFIG },
+    { _menu_label_remote_access, SPGM(remote_html), WebMenu::MenuType::CONFIG },
+
+    { SPGM(Change_Password), SPGM(password_html), WebMenu::MenuType::ADMIN },
+    { SPGM(Reboot_Device), SPGM(reboot_html), WebMenu::MenuType::ADMIN },
+    { _menu_label_factory_defaults, SPGM(factory_html), WebMenu::MenuType::ADMIN },
+    { _menu_label_export_settings, _menu_uri_export_settings, WebMenu::MenuType::ADMIN },
+    #if WEBSERVER_KFC_OTA
+        { _menu_label_update_firmware, SPGM(update_fw_html), WebMenu::MenuType::ADMIN },
+    #endif
+    #if ENABLE_ARDUINO_OTA && !ENABLE_ARDUINO_OTA_AUTOSTART
+        { _menu_label_enable_arduino_ota, _menu_uri_start_arduino_ota, WebMenu::MenuType::ADMIN },
+    #endif
+
+    #if WEBSERVER_SPEED_TEST
+        { _menu_label_speed_test, _menu_uri_speed_test, WebMenu::MenuType::UTIL },
+    #endif
+};
+
+static constexpr WebMenu::menu_item_id_t kStaticItemsCount = sizeof(_staticItems) / sizeof(_staticItems[0]);
+static constexpr WebMenu::menu_item_id_t kStaticItemsBegin = WebMenu::getId(WebMenu::MenuType::MAX);
+static constexpr WebMenu::menu_item_id_t kStaticItemsEnd = kStaticItemsBegin + kStaticItemsCount;
+
+inline static WebMenu::StaticItem_t _getStaticItem(WebMenu::menu_item_id_t index)
+{
+    WebMenu::StaticItem_t item;
+    memcpy_P(&item, &_staticItems[index], sizeof(item));
+    return item;
+}
+
+inline static WebMenu::StaticMenu_t _getStaticMenu(WebMenu::menu_item_id_t index)
+{
+    WebMenu::StaticMenu_t menu;
+    memcpy_P(&menu, &_staticMenus[index], sizeof(menu));
+    return menu;
+}
+
+// --------------------------------------------------------------------
+// WebMenu
+// --------------------------------------------------------------------
+
+bool WebMenu::MenuString::equals(const char *str, bool ignoreCase) const
+{
+    if (_allocated) {
+        return (ignoreCase ? strcasecmp(str, c_str()) : strcmp(str, c_str())) == 0;
+    }
+    return (ignoreCase ? strcasecmp_P(str, c_str()) : strcmp_P(str, c_str())) == 0;
+}
+
+WebMenu::WebMenu() :
+    _nextId(kStaticItemsEnd)
+{
+}
+
+bool WebMenu::isStaticId(menu_item_id_t id)
+{
+    return id >= kStaticItemsBegin && id < kStaticItemsEnd;
+}
+
+bool WebMenu::isValid(menu_item_id_t id) const
+{
+    if (id == kInvalidId) {
+        return false;
+    }
+    if (isMenuId(id) || isStaticId(id)) {
+        return true;
+    }
+    return std::find_if(_items.begin(), _items.end(), [id](const Item &item) {
+        return item._id == id;
+    }) != _items.end();
+}
+
+WebMenu::menu_item_id_t WebMenu::_add(ItemType type, MenuString &&label, MenuString &&uri, menu_item_id_t parentId, menu_item_id_t insertAfterId)
+{
+    if (!isValid(parentId)) {
+        __DBG_printf_E("invalid parent id=%u", parentId);
+        return kInvalidId;
+    }
+    auto id = _nextId++;
+    __LDBG_printf("id=%u type=%u label=%s parent=%u insert_after=%u", id, type, __S(label.c_str()), parentId, insertAfterId);
+
+    if (insertAfterId != kInvalidId && !isMenuId(insertAfterId) && !isStaticId(insertAfterId)) {
+        // insert after another dynamic item using the same anchor
+        auto iterator = std::find_if(_items.begin(), _items.end(), [insertAfterId](const Item &item) {
+            return item._id == insertAfterId;
+        });
+        if (iterator != _items.end()) {
+            auto anchorId = iterator->_anchorId;
+            _items.emplace(iterator + 1, id, parentId, anchorId, type, std::move(label), std::move(uri));
+            return id;
+        }
+        insertAfterId = kInvalidId;
+    }
+    _items.emplace_back(id, parentId, insertAfterId, type, std::move(label), std::move(uri));
+    return id;
+}
+
+bool WebMenu::remove(menu_item_id_t id)
+{
+    auto size = _items.size();
+    _items.erase(std::remove_if(_items.begin(), _items.end(), [id](const Item &item) {
+        return item._id == id || item._parentId == id;
+    }), _items.end());
+    __LDBG_printf("id=%u removed=%u", id, size - _items.size());
+    return size != _items.size();
+}
+
+WebMenu::menu_item_id_t WebMenu::_findStatic(const char *str, bool byLabel, menu_item_id_t parentId) const
+{
+    if (parentId == kInvalidId) {
+        for(menu_item_id_t i = 0; i < getId(MenuType::MAX); i++) {
+            auto menu = _getStaticMenu(i);
+            if (byLabel ? (strcasecmp_P(str, menu.label) == 0) : (menu.uri && strcmp_P(str, menu.uri) == 0)) {
+                return i;
+            }
+        }
+    }
+    for(menu_item_id_t i = 0; i < kStaticItemsCount; i++) {
+        auto item = _getStaticItem(i);
+        if (parentId != kInvalidId && getId(item.menu) != parentId) {
+            continue;
+        }
+        if (byLabel ? (strcasecmp_P(str, item.label) == 0) : (strcmp_P(str, item.uri) == 0)) {
+            return kStaticItemsBegin + i;
+        }
+    }
+    return kInvalidId;
+}
+
+WebMenu::menu_item_id_t WebMenu::_findDynamic(const char *str, bool byLabel, menu_item_id_t parentId) const
+{
+    for(const auto &item: _items) {
+        if (parentId != kInvalidId && item._parentId != parentId) {
+            continue;
+        }
+        if (item._type == ItemType::DIVIDER || (item._type == ItemType::PLUGIN_FORMS && !byLabel)) {
+            continue;
+        }
+        if (byLabel ? item._label.equals(str, true) : item._uri.equals(str, false)) {
+            return item._id;
+        }
+    }
+    return kInvalidId;
+}
+
+void WebMenu::_invokeCallback(const Item &item, ItemCallback callback)
+{
+    if (item._type == ItemType::PLUGIN_FORMS) {
+        _forEachPluginForm(item, callback);
+        return;
+    }
+    callback(ItemView({ item._type, item._id, item._label.c_str(), item._label.isProgmem(), item._uri.c_str(), item._uri.isProgmem(), nullptr }));
+}
+
+void WebMenu::_forEachDynamic(menu_item_id_t parentId, menu_item_id_t anchorId, ItemCallback callback)
+{
+    for(const auto &item: _items) {
+        if (item._parentId == parentId && item._anchorId == anchorId) {
+            _invokeCallback(item, callback);
+        }
+    }
+}
+
+void WebMenu::_forEachPluginForm(const Item &item, ItemCallback callback)
+{
+    // the list of forms is read from PROGMEM
+    char form[32];
+    size_t len = 0;
+    auto ptr = item._uri.c_str();
+    for(;;) {
+        auto ch = static_cast<char>(pgm_read_byte(ptr++));
+        if (ch == ',' || ch == 0) {
+            if (len) {
+                form[len] = 0;
+                callback(ItemView({ ItemType::ITEM, item._id, item._label.c_str(), true, form, false, SPGM(_html) }));
+                len = 0;
+            }
+            if (ch == 0) {
+                break;
+            }
+        }
+        else if (!isspace(ch) && len < sizeof(form) - 1) {
+            form[len++] = ch;
+        }
+    }
+}
+
+void WebMenu::_forEach(menu_item_id_t parentId, ItemCallback callback)
+{
+    if (!isMenuId(parentId)) {
+        // dynamic sub menu
+        for(const auto &item: _items) {
+            if (item._parentId == parentId) {
+                _invokeCallback(item, callback);
+            }
+        }
+        return;
+    }
+    // items inserted at the top
+    _forEachDynamic(parentId, parentId, callback);
+    for(menu_item_id_t i = 0; i < kStaticItemsCount; i++) {
+        auto item = _getStaticItem(i);
+        if (getId(item.menu) == parentId) {
+            auto id = kStaticItemsBegin + i;
+            callback(ItemView({ ItemType::ITEM, static_cast<menu_item_id_t>(id), item.label, true, item.uri, true, nullptr }));
+            _forEachDynamic(parentId, id, callback);
+        }
+    }
+    _forEachDynamic(parentId, kInvalidId, callback);
+}
+
+bool WebMenu::_hasItems(menu_item_id_t menuId)
+{
+    bool result = false;
+    _forEach(menuId, [&result](const ItemView &) {
+        result = true;
+    });
+    return result;
+}
+
+void WebMenu::_printString(Print &output, const char *str, bool isProgmem)
+{
+    if (isProgmem) {
+        output.print(FPSTR(str));
+    }
+    else {
+        output.print(str);
+    }
+}
+
+void WebMenu::_printItem(Print &output, const ItemView &item, bool listGroup)
+{
+    switch(item.type) {
+        case ItemType::DIVIDER:
+            if (!listGroup) {
+                output.print(F("<div class=\"dropdown-divider\"></div>"));
+            }
+            break;
+        case ItemType::SUB_MENU:
+            output.print(listGroup ? F("<span class=\"list-group-item disabled\">") : F("<h6 class=\"dropdown-header\">"));
+            _printString(output, item.label, item.labelIsProgmem);
+            output.print(listGroup ? F("</span>") : F("</h6>"));
+            _forEach(item.id, [this, &output, listGroup](const ItemView &subItem) {
+                _printItem(output, subItem, listGroup);
+            });
+            break;
+        case ItemType::ITEM:
+        default:
+            output.print(listGroup ? F("<a class=\"list-group-item list-group-item-action\" href=\"/") : F("<a class=\"dropdown-item\" href=\"/"));
+            _printString(output, item.uri, item.uriIsProgmem);
+            if (item.uriSuffix) {
+                output.print(FPSTR(item.uriSuffix));
+            }
+            output.print(F("\">"));
+            _printString(output, item.label, item.labelIsProgmem);
+            output.print(F("</a>"));
+            break;
+    }
+}
+
+void WebMenu::html(Print &output)
+{
+    for(menu_item_id_t i = 0; i < getId(MenuType::MAX); i++) {
+        html(output, i);
+    }
+}
+
+void WebMenu::html(Print &output, menu_item_id_t menuId)
+{
+    for(uint16_t part = 0; html(output, menuId, part, false); part++) {
+    }
+}
+
+void WebMenu::htmlSubMenu(Print &output, menu_item_id_t menuId)
+{
+    for(uint16_t part = 0; html(output, menuId, part, true); part++) {
+    }
+}
+
+bool WebMenu::html(Print &output, menu_item_id_t menuId, uint16_t part, bool listGroup)
+{
+    if (!isMenuId(menuId)) {
+        return false;
+    }
+    // the list group consists of the items only. the dropdown menu starts with a header and ends with a footer
+    if (!listGroup) {
+        auto menu = _getStaticMenu(menuId);
+        if (menu.uri) {
+            if (part != 0) {
+                return false;
+            }
+            output.print(F("<li class=\"nav-item\"><a class=\"nav-link\" href=\"/"));
+            output.print(FPSTR(menu.uri));
+            output.print(F("\">"));
+            output.print(FPSTR(menu.label));
+            output.print(F("</a></li>"));
+            return true;
+        }
+        if (part == 0) {
+            if (!_hasItems(menuId)) {
+                return false;
+            }
+            output.printf_P(PSTR("<li class=\"nav-item dropdown\"><a class=\"nav-link dropdown-toggle\" href=\"#\" id=\"navbarDropdown%u\" role=\"button\" data-toggle=\"dropdown\" aria-haspopup=\"true\" aria-expanded=\"false\">"), menuId);
+            output.print(FPSTR(menu.label));
+            output.printf_P(PSTR("</a><div class=\"dropdown-menu\" aria-labelledby=\"navbarDropdown%u\">"), menuId);
+            return true;
+        }
+        part--;
+    }
+    // items are rendered one at a time
+    int32_t index = part;
+    _forEach(menuId, [this, &output, &index, listGroup](const ItemView &item) {
+        if (index-- == 0) {
+            _printItem(output, item, listGroup);
+        }
+    });
+    if (index < 0) {
+        return true;
+    }
+    if (!listGroup && index == 0) {
+        output.print(F("</div></li>"));
+        return true;
+    }
+    return false;
+}
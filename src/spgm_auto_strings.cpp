@@ -398,6 +398,7 @@ PROGMEM_STRING_DEF(status_html, "status.html");
 // PROGMEM_STRING_DEF(stk500v1_log_file, "/stk500v1/debug.log");
 // PROGMEM_STRING_DEF(stk500v1_sig_file, "/stk500v1/atmega.csv");
 // PROGMEM_STRING_DEF(stk500v1_tmp_file, "/stk500v1/firmware_tmp.hex");
+// PROGMEM_STRING_DEF(stk500v1_img_file, "/stk500v1/firmware.img");
 PROGMEM_STRING_DEF(stopped, "stopped");
 PROGMEM_STRING_DEF(string, "string");
 PROGMEM_STRING_DEF(sys, "sys");
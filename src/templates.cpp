@@ -780,30 +780,87 @@ private:
 };
 
 
+class MenuStream {
+public:
+    using menu_item_id_t = WebMenu::menu_item_id_t;
+
+    // allMenus renders the navigation bar starting with menuId
+    MenuStream(menu_item_id_t menuId, bool allMenus, bool listGroup) :
+        _menuId(menuId),
+        _part(0),
+        _allMenus(allMenus),
+        _listGroup(listGroup)
+    {
+    }
+
+    size_t readBytes(uint8_t *data, size_t size) {
+        if (_buffer.length() == 0) {
+            if (_fillBuffer() == 0) {
+                return 0;
+            }
+        }
+        if (size > _buffer.length()) {
+            size = _buffer.length();
+        }
+        memcpy(data, _buffer.c_str(), size);
+        _buffer.remove(0, size);
+        return size;
+    }
+
+private:
+    // render the menu one item at a time. some items like dividers in list groups have no output
+    size_t _fillBuffer() {
+        while (_buffer.length() == 0 && WebMenu::isMenuId(_menuId)) {
+            if (!bootstrapMenu.html(_buffer, _menuId, _part++, _listGroup)) {
+                if (_allMenus) {
+                    _menuId++;
+                    _part = 0;
+                }
+                else {
+                    _menuId = WebMenu::kInvalidId;
+                }
+            }
+        }
+        return _buffer.length();
+    }
+
+private:
+    PrintString _buffer;
+    menu_item_id_t _menuId;
+    uint16_t _part;
+    bool _allMenus;
+    bool _listGroup;
+};
+
 bool TemplateDataProvider::callback(const String& name, DataProviderInterface& provider, WebTemplate &webTemplate) {
 
     enum class FillBufferMethod {
         NONE = 0,
         PRINT_ARGS,
-        BUFFER_STREAM
+        BUFFER_STREAM,
+        MENU_STREAM
     };
 
     auto &printArgs = webTemplate.getPrintArgs();
     auto value = PrintHtmlEntitiesString();
     auto fbMethod = FillBufferMethod::NONE;
+    WebMenu::menu_item_id_t menuId = 0;
+    auto allMenus = false;
+    auto listGroup = false;
 
     // menus
     if (name == F("MENU_HTML_MAIN")) {
-        bootstrapMenu.html(printArgs);
-        fbMethod = FillBufferMethod::PRINT_ARGS;
+        allMenus = true;
+        fbMethod = FillBufferMethod::MENU_STREAM;
     }
     else if (name.startsWith(F("MENU_HTML_MAIN_"))) {
-        bootstrapMenu.html(printArgs, bootstrapMenu.findMenuByLabel(name.substring(15)));
-        fbMethod = FillBufferMethod::PRINT_ARGS;
+        menuId = bootstrapMenu.findMenuByLabel(name.substring(15));
+        fbMethod = FillBufferMethod::MENU_STREAM;
     }
     else if (name.startsWith(F("MENU_HTML_SUBMENU_"))) {
-        bootstrapMenu.htmlSubMenu(printArgs, bootstrapMenu.findMenuByLabel(name.substring(18)), 0);
-        fbMethod = FillBufferMethod::PRINT_ARGS;
+        menuId = bootstrapMenu.findMenuByLabel(name.substring(18));
+        listGroup = true;
+        fbMethod = FillBufferMethod::MENU_STREAM;
     }
     // forms
     else if (name == F("FORM_HTML")) {
@@ -871,6 +928,17 @@ bool TemplateDataProvider::callback(const String& name, DataProviderInterface& p
                 });
                 return true;
             }
+        case FillBufferMethod::MENU_STREAM: {
+                auto stream = std::shared_ptr<MenuStream>(new MenuStream(menuId, allMenus, listGroup));
+                if (!stream) {
+                    __DBG_printf_E("memory allocation failed");
+                    return false;
+                }
+                provider.setFillBuffer([stream](uint8_t *buffer, size_t size) {
+                    return stream->readBytes(buffer, size);
+                });
+                return true;
+            }
         default:
         case FillBufferMethod::NONE:
             break;
@@ -14,17 +14,21 @@
 #include "failure_counter.h"
 #include "fs_mapping.h"
 #include "kfc_fw_config.h"
+#include "metrics.h"
 #include "rest_api.h"
 #include "save_crash.h"
 #include "session.h"
 #include "templates.h"
 #include "web_server.h"
 #include "web_server_action.h"
+#include "web_server_etag.h"
+#include "web_server_admission.h"
 #include "web_socket.h"
 #include <BufferStream.h>
 #include <ESPAsyncWebServer.h>
 #include <EventScheduler.h>
 #include <JsonConfigReader.h>
+#include <LoopFunctions.h>
 #include <PrintHtmlEntitiesString.h>
 #include <PrintString.h>
 #if IOT_BLINDS_CTRL && IOT_BLINDS_CTRL_SAVE_STATE
@@ -201,6 +205,9 @@ void Plugin::handlerNotFound(AsyncWebServerRequest *request)
     __LDBG_printf("not found handler=%s", request->url().c_str());
     HttpHeaders headers;
     AsyncWebServerResponse *response = nullptr;
+    #if WEBSERVER_ADMISSION_CONTROL
+        Admission::Scope admission;
+    #endif
 
     // StringVector list;
     // for(const auto header: request->getHeaders()) {
@@ -209,241 +216,265 @@ void Plugin::handlerNotFound(AsyncWebServerRequest *request)
     // __LDBG_printf("headers for %s:\n%s", request->url().c_str(), implode('\n', list).c_str());
 
     auto &url = request->url();
-    // --------------------------------------------------------------------
-    #if ENABLE_ARDUINO_OTA
-        if (url.endsWith(F("-arduino-ota"))) {
-            for(;;) {
+    auto route = getInstance()._server->_routes.find(request->method(), url);
+    RouteTable::Measure measure(route);
+    switch(route ? route->type : RouteType::NONE) {
+        // --------------------------------------------------------------------
+        #if ENABLE_ARDUINO_OTA
+            case RouteType::START_ARDUINO_OTA:
+            case RouteType::STOP_ARDUINO_OTA: {
                 auto statusStr = F("Enabled");
-                if (url.startsWith(F("/start-"))) {
+                if (route->type == RouteType::START_ARDUINO_OTA) {
                     getInstance().ArduinoOTAbegin();
                 }
-                else if (url.startsWith(F("/stop-"))) {
+                else {
                     statusStr = F("Diabled");
                     getInstance().ArduinoOTAend();
                 }
-                else {
-                    break;
-                }
                 response = request->beginResponse(200, FSPGM(mime_text_plain), statusStr);
                 headers.addNoCache(true);
                 headers.setResponseHeaders(response);
-                break;
-            }
-        }
-        else
-    #endif
-    // --------------------------------------------------------------------
-    if (url == F("/is-alive")) {
-        auto content = String(request->arg(String('p')).toInt());
-        #if DEBUG
-            switch(request->arg(F("reset-device")).toInt()) {
-                case 1:
-                    config.resetDevice(false);
-                    break;
-                case 2:
-                    config.resetDevice(true);
-                    break;
             }
+            break;
         #endif
-        response = request->beginResponse(200, FSPGM(mime_text_plain), content);
-        headers.addNoCache(true);
-        headers.setResponseHeaders(response);
-    }
-    #if IOT_CLOCK && 0 //TODO implement WLED json API
         // --------------------------------------------------------------------
-        else if (url == F("/json")) {
-            auto json = ClockPlugin::getInstance().getWLEDJson();
-            response = request->beginResponse(200, FSPGM(mime_application_json), json.c_str());
+        case RouteType::IS_ALIVE: {
+            auto content = String(request->arg(String('p')).toInt());
+            #if DEBUG
+                switch(request->arg(F("reset-device")).toInt()) {
+                    case 1:
+                        config.resetDevice(false);
+                        break;
+                    case 2:
+                        config.resetDevice(true);
+                        break;
+                }
+            #endif
+            response = request->beginResponse(200, FSPGM(mime_text_plain), content);
             headers.addNoCache(true);
             headers.setResponseHeaders(response);
         }
+        break;
+        #if IOT_CLOCK && 0 //TODO implement WLED json API
+            // --------------------------------------------------------------------
+            case RouteType::WLED_JSON: {
+                auto json = ClockPlugin::getInstance().getWLEDJson();
+                response = request->beginResponse(200, FSPGM(mime_application_json), json.c_str());
+                headers.addNoCache(true);
+                headers.setResponseHeaders(response);
+            }
+            break;
+            // --------------------------------------------------------------------
+            case RouteType::WLED_PRESETS_JSON:
+                response = request->beginResponse(200, FSPGM(mime_application_json), F("{}"));
+                headers.addNoCache(true);
+                headers.setResponseHeaders(response);
+                break;
+        #endif
         // --------------------------------------------------------------------
-        else if (url == F("/presets.json")) {
-            response = request->beginResponse(200, FSPGM(mime_application_json), F("{}"));
-            headers.addNoCache(true);
-            headers.setResponseHeaders(response);
-        }
-    #endif
-    // --------------------------------------------------------------------
-    else if (url == F("/webui-handler")) {
-        getInstance()._handlerWebUI(request, headers);
-        return;
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/alerts")) {
-        getInstance()._handlerAlerts(request, headers);
-        return;
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/sync-time")) {
-        if (!getInstance().isAuthenticated(request)) {
-            auto response = request->beginResponse(403);
-            _logRequest(request, response);
-            request->send(response);
+        case RouteType::WEBUI_HANDLER:
+            getInstance()._handlerWebUI(request, headers);
             return;
-        }
-        headers.addNoCache(true);
-        PrintHtmlEntitiesString str;
-        WebTemplate::printSystemTime(time(nullptr), str);
-        response = new AsyncBasicResponse(200, FSPGM(mime_text_html), std::move(str));
-        if (!response) {
-            __LDBG_printf_E("memory allocation failed");
-        }
-        headers.setResponseHeaders(response);
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/export-settings")) {
-        getInstance()._handlerExportSettings(request, headers);
-        return;
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/import-settings")) {
-        getInstance()._handlerImportSettings(request, headers);
-        return;
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/scan-wifi")) {
-        if (!getInstance().isAuthenticated(request)) {
-            auto response = request->beginResponse(403, FSPGM(mime_text_html));
-            _logRequest(request, response);
-            request->send(response);
-            return;
-        }
-        headers.addNoCache();
-        response = new AsyncNetworkScanResponse(request->arg(FSPGM(hidden, "hidden")).toInt());
-        if (!response) {
-            __LDBG_printf_E("memory allocation failed");
-        }
-        headers.setResponseHeaders(response);
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/logout")) {
-        __SID(__DBG_printf("sending remove SID cookie"));
-        headers.addNoCache(true);
-        headers.add(createRemoveSessionIdCookie());
-
-        // headers.add<HttpLocationHeader>(String('/'));
-        // response = request->beginResponse(302);
-        // headers.setResponseHeaders(response);
-
-        response = HttpLocationHeader::redir(request, String('/'), headers);
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/mqtt-publish-ad.html")) {
-        if (!getInstance().isAuthenticated(request)) {
-            auto response = request->beginResponse(403, FSPGM(mime_text_html));
-            _logRequest(request, response);
-            request->send(response);
+        // --------------------------------------------------------------------
+        case RouteType::ALERTS:
+            getInstance()._handlerAlerts(request, headers);
             return;
-        }
-
-        auto &session = Action::Handler::getInstance().initSession(request, F("/mqtt-publish-ad.html"), F("MQTT Auto Discovery"), Action::AuthType::AUTH);
-        if (session.isNew()) {
-            auto client = MQTT::Client::getClient();
-            bool result = false;
-            if (client) {
-                auto sessionId = session.getId();
-                result = client->publishAutoDiscovery(MQTT::RunFlags::FORCE, [sessionId](MQTT::StatusType status) {
-                    const auto session = Action::Handler::getInstance().getSession(sessionId);
-                    if (session) {
-                        switch(status) {
-                            case MQTT::StatusType::DEFERRED:
-                                session->setStatus(F("Auto discovery deferred..."));
-                                break;
-                            case MQTT::StatusType::STARTED:
-                                session->setStatus(F("Auto discovery running..." MESSAGE_TEMPLATE_AUTO_RELOAD(15)));
-                                break;
-                            case MQTT::StatusType::SUCCESS:
-                                session->setStatus(F("Auto discovery successfully published..."), MessageType::SUCCESS);
-                                break;
-                            case MQTT::StatusType::FAILURE:
-                                session->setStatus(F("Failed to publish auto discovery..."), MessageType::DANGER);
-                                break;
-                        }
-                    }
-                });
-            }
-            if (result) {
-                session = Action::StateType::EXECUTING;
-                session.setStatus(F("Starting auto discovery..." MESSAGE_TEMPLATE_AUTO_RELOAD(15)));
+        // --------------------------------------------------------------------
+        case RouteType::SYNC_TIME: {
+            if (!getInstance().isAuthenticated(request)) {
+                auto response = request->beginResponse(403);
+                _logRequest(request, response);
+                request->send(response);
+                return;
             }
-            else {
-                session = Action::StateType::FINISHED;
-                session.setStatus(F("Failed to publish auto discovery..."), MessageType::DANGER);
+            headers.addNoCache(true);
+            PrintHtmlEntitiesString str;
+            WebTemplate::printSystemTime(time(nullptr), str);
+            response = new AsyncBasicResponse(200, FSPGM(mime_text_html), std::move(str));
+            if (!response) {
+                __LDBG_printf_E("memory allocation failed");
             }
+            headers.setResponseHeaders(response);
         }
-        return;
-    }
-    // --------------------------------------------------------------------
-    else if (url == F("/zeroconf")) {
-        if (!getInstance().isAuthenticated(request)) {
-            auto response = request->beginResponse(403);
-            _logRequest(request, response);
-            request->send(response);
+        break;
+        // --------------------------------------------------------------------
+        case RouteType::EXPORT_SETTINGS:
+            getInstance()._handlerExportSettings(request, headers);
             return;
-        }
-        headers.addNoCache(true);
-        response = new AsyncResolveZeroconfResponse(request->arg(FSPGM(value)));
-        if (!response) {
-            __LDBG_printf_E("memory allocation failed");
-        }
-        headers.setResponseHeaders(response);
-    }
-    #if MDNS_PLUGIN
-        else if (url == F("/mdns_discovery")) {
-            MDNSPlugin::mdnsDiscoveryHandler(request);
+        // --------------------------------------------------------------------
+        case RouteType::IMPORT_SETTINGS:
+            getInstance()._handlerImportSettings(request, headers);
             return;
-        }
-    #endif
-    // --------------------------------------------------------------------
-    #if ESP8266
-        else if (url == F("/savecrash.json")) {
+        // --------------------------------------------------------------------
+        case RouteType::SCAN_WIFI:
             if (!getInstance().isAuthenticated(request)) {
-                auto response = request->beginResponse(403);
+                auto response = request->beginResponse(403, FSPGM(mime_text_html));
                 _logRequest(request, response);
                 request->send(response);
                 return;
             }
+            #if WEBSERVER_ADMISSION_CONTROL
+                if (!admission.admit(request, Admission::ResponseType::NETWORK_SCAN, handlerNotFound)) {
+                    return;
+                }
+            #endif
+            headers.addNoCache();
+            response = new AsyncNetworkScanResponse(request->arg(FSPGM(hidden, "hidden")).toInt());
+            if (!response) {
+                __LDBG_printf_E("memory allocation failed");
+            }
+            headers.setResponseHeaders(response);
+            break;
+        // --------------------------------------------------------------------
+        case RouteType::LOGOUT:
+            __SID(__DBG_printf("sending remove SID cookie"));
             headers.addNoCache(true);
-            response = SaveCrash::webHandler::json(request, headers);
-        }
-    #endif
-    #if IOT_SENSOR_HAVE_AMBIENT_LIGHT_SENSOR
+            headers.add(createRemoveSessionIdCookie());
+
+            // headers.add<HttpLocationHeader>(String('/'));
+            // response = request->beginResponse(302);
+            // headers.setResponseHeaders(response);
+
+            response = HttpLocationHeader::redir(request, String('/'), headers);
+            break;
         // --------------------------------------------------------------------
-        else if (url == F("/ambient_light_sensor")) {
+        case RouteType::MQTT_PUBLISH_AD: {
             if (!getInstance().isAuthenticated(request)) {
-                auto response = request->beginResponse(403);
+                auto response = request->beginResponse(403, FSPGM(mime_text_html));
                 _logRequest(request, response);
                 request->send(response);
                 return;
             }
-            int id = request->arg(F("id")).toInt();
-            Sensor_AmbientLight *lightSensor = nullptr;
-            for(const auto &sensor: SensorPlugin::getSensors()) {
-                auto tmpSensor = reinterpret_cast<Sensor_AmbientLight *>(sensor);
-                if (sensor->getType() == SensorPlugin::SensorType::AMBIENT_LIGHT && tmpSensor->getId() == id && tmpSensor->enabled()) {
-                    lightSensor = reinterpret_cast<Sensor_AmbientLight *>(sensor);
-                    break;
+
+            auto &session = Action::Handler::getInstance().initSession(request, F("/mqtt-publish-ad.html"), F("MQTT Auto Discovery"), Action::AuthType::AUTH);
+            if (session.isNew()) {
+                auto client = MQTT::Client::getClient();
+                bool result = false;
+                if (client) {
+                    auto sessionId = session.getId();
+                    result = client->publishAutoDiscovery(MQTT::RunFlags::FORCE, [sessionId](MQTT::StatusType status) {
+                        const auto session = Action::Handler::getInstance().getSession(sessionId);
+                        if (session) {
+                            switch(status) {
+                                case MQTT::StatusType::DEFERRED:
+                                    session->setStatus(F("Auto discovery deferred..."));
+                                    break;
+                                case MQTT::StatusType::STARTED:
+                                    session->setStatus(F("Auto discovery running..." MESSAGE_TEMPLATE_AUTO_RELOAD(15)));
+                                    break;
+                                case MQTT::StatusType::SUCCESS:
+                                    session->setStatus(F("Auto discovery successfully published..."), MessageType::SUCCESS);
+                                    break;
+                                case MQTT::StatusType::FAILURE:
+                                    session->setStatus(F("Failed to publish auto discovery..."), MessageType::DANGER);
+                                    break;
+                            }
+                        }
+                    });
+                }
+                if (result) {
+                    session = Action::StateType::EXECUTING;
+                    session.setStatus(F("Starting auto discovery..." MESSAGE_TEMPLATE_AUTO_RELOAD(15)));
+                }
+                else {
+                    session = Action::StateType::FINISHED;
+                    session.setStatus(F("Failed to publish auto discovery..."), MessageType::DANGER);
                 }
             }
-            if (!lightSensor || lightSensor->getValue() == -1) {
-                auto response = request->beginResponse(503);
+        }
+        return;
+        // --------------------------------------------------------------------
+        case RouteType::ZEROCONF:
+            if (!getInstance().isAuthenticated(request)) {
+                auto response = request->beginResponse(403);
                 _logRequest(request, response);
                 request->send(response);
                 return;
             }
             headers.addNoCache(true);
-            response = request->beginResponse(200, FSPGM(mime_text_plain), std::move(String(lightSensor->getValue())));
+            response = new AsyncResolveZeroconfResponse(request->arg(FSPGM(value)));
+            if (!response) {
+                __LDBG_printf_E("memory allocation failed");
+            }
             headers.setResponseHeaders(response);
-        }
-    #endif
-    // --------------------------------------------------------------------
-    #if WEBSERVER_SPEED_TEST
-        else if (url.startsWith(F("/speedtest."))) { // handles speedtest.zip and speedtest.bmp
-            getInstance()._handlerSpeedTest(request, !url.endsWith(F(".bmp")), headers);
-            return;
-        }
-    #endif
+            break;
+        #if MDNS_PLUGIN
+            case RouteType::MDNS_DISCOVERY:
+                MDNSPlugin::mdnsDiscoveryHandler(request);
+                return;
+        #endif
+        // --------------------------------------------------------------------
+        #if ESP8266
+            case RouteType::SAVECRASH_JSON:
+                if (!getInstance().isAuthenticated(request)) {
+                    auto response = request->beginResponse(403);
+                    _logRequest(request, response);
+                    request->send(response);
+                    return;
+                }
+                headers.addNoCache(true);
+                response = SaveCrash::webHandler::json(request, headers);
+                break;
+        #endif
+        #if IOT_SENSOR_HAVE_AMBIENT_LIGHT_SENSOR
+            // --------------------------------------------------------------------
+            case RouteType::AMBIENT_LIGHT_SENSOR: {
+                if (!getInstance().isAuthenticated(request)) {
+                    auto response = request->beginResponse(403);
+                    _logRequest(request, response);
+                    request->send(response);
+                    return;
+                }
+                int id = request->arg(F("id")).toInt();
+                Sensor_AmbientLight *lightSensor = nullptr;
+                for(const auto &sensor: SensorPlugin::getSensors()) {
+                    auto tmpSensor = reinterpret_cast<Sensor_AmbientLight *>(sensor);
+                    if (sensor->getType() == SensorPlugin::SensorType::AMBIENT_LIGHT && tmpSensor->getId() == id && tmpSensor->enabled()) {
+                        lightSensor = reinterpret_cast<Sensor_AmbientLight *>(sensor);
+                        break;
+                    }
+                }
+                if (!lightSensor || lightSensor->getValue() == -1) {
+                    auto response = request->beginResponse(503);
+                    _logRequest(request, response);
+                    request->send(response);
+                    return;
+                }
+                headers.addNoCache(true);
+                response = request->beginResponse(200, FSPGM(mime_text_plain), std::move(String(lightSensor->getValue())));
+                headers.setResponseHeaders(response);
+            }
+            break;
+        #endif
+        // --------------------------------------------------------------------
+        #if WEBSERVER_SPEED_TEST
+            case RouteType::SPEEDTEST_ZIP:
+            case RouteType::SPEEDTEST_BMP:
+                getInstance()._handlerSpeedTest(request, route->type == RouteType::SPEEDTEST_ZIP, headers);
+                return;
+        #endif
+        // --------------------------------------------------------------------
+        #if KFC_METRICS
+            case RouteType::METRICS: {
+                if (!getInstance().isAuthenticated(request)) {
+                    auto response = request->beginResponse(403);
+                    _logRequest(request, response);
+                    request->send(response);
+                    return;
+                }
+                // the metrics are formatted one by one while the response is sent
+                auto writer = std::make_shared<Metrics::Writer>();
+                response = request->beginChunkedResponse(F("text/plain; version=0.0.4"), [writer](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                    return writer->read(buffer, maxLen);
+                });
+                headers.addNoCache(true);
+                headers.setResponseHeaders(response);
+            }
+            break;
+        #endif
+        default:
+            break;
+    }
 
     // handle response
     if (response) {
@@ -453,6 +484,11 @@ void Plugin::handlerNotFound(AsyncWebServerRequest *request)
     }
 
     // else section
+    #if WEBSERVER_ADMISSION_CONTROL
+        if (!admission.admit(request, Admission::getResponseType(request), handlerNotFound)) {
+            return;
+        }
+    #endif
     if (getInstance()._handleFileRead(url, getInstance()._clientAcceptsGzip(request), request, headers)) {
         return;
     }
@@ -688,6 +724,7 @@ void Plugin::_addRestHandler(RestHandler &&handler)
             _server->addHandler(restHandler);
         }
         // store handler
+        _server->_routes.add(handler.getURL(), RouteType::REST, _server->_restCallbacks.size());
         _server->_restCallbacks.emplace_back(std::move(handler));
     }
 }
@@ -725,6 +762,97 @@ void Plugin::_addRestHandler(RestHandler &&handler)
 
 #endif
 
+// ------------------------------------------------------------------------
+// AsyncImportSettingsWebHandler
+// ------------------------------------------------------------------------
+
+// state of a streaming import, the body is passed to the parser chunk by chunk
+struct ImportSettingsRequest {
+    HeapStream stream;
+    JsonConfigReader reader;
+    bool authenticated;
+    bool error;
+
+    ImportSettingsRequest(bool auth) : stream(), reader(&stream, config, nullptr), authenticated(auth), error(false) {
+        reader.initParser();
+    }
+};
+
+static AsyncWebServerResponse *createImportSettingsResponse(AsyncWebServerRequest *request, uint16_t status, int count, const __FlashStringHelper *message)
+{
+    auto response = request->beginResponse(200, FSPGM(mime_text_plain), PrintString(F("{\"status\":%u,\"count\":%d,\"message\":\"%s\"}"), status, count, message));
+    HttpHeaders headers;
+    headers.addNoCache();
+    headers.setResponseHeaders(response);
+    return response;
+}
+
+bool AsyncImportSettingsWebHandler::canHandle(AsyncWebServerRequest *request)
+{
+    if (!(request->method() & HTTP_POST) || request->url() != getURI()) {
+        return false;
+    }
+    // form data is parsed by the web server and handled by _handlerImportSettings()
+    auto &contentType = request->contentType();
+    if (contentType.startsWith(F("application/x-www-form-urlencoded")) || contentType.startsWith(F("multipart/"))) {
+        return false;
+    }
+    request->addInterestingHeader(FSPGM(Authorization));
+    request->_tempObject = new ImportSettingsRequest(Plugin::getInstance().isAuthenticated(request));
+    // emulate AsyncWebServerRequest dtor using onDisconnect callback
+    request->onDisconnect([request]() {
+        if (request->_tempObject) {
+            delete reinterpret_cast<ImportSettingsRequest *>(request->_tempObject);
+            request->_tempObject = nullptr;
+        }
+    });
+    return true;
+}
+
+void AsyncImportSettingsWebHandler::handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+    __LDBG_printf("idx=%u len=%u total=%u temp=%p", index, len, total, request->_tempObject);
+    if (!request->_tempObject) {
+        return;
+    }
+    auto &import = *reinterpret_cast<ImportSettingsRequest *>(request->_tempObject);
+    if (!import.authenticated || import.error) {
+        return;
+    }
+    if (index == 0) {
+        config.discard();
+    }
+    import.stream.setData(data, len);
+    if (!import.reader.parseStream()) {
+        __LDBG_printf("json parser: %s", import.reader.getLastErrorMessage().c_str());
+        import.error = true;
+        // drop the values that have been imported so far
+        config.discard();
+    }
+}
+
+void AsyncImportSettingsWebHandler::handleRequest(AsyncWebServerRequest *request)
+{
+    if (!request->_tempObject) {
+        request->send(500);
+        return;
+    }
+    auto &import = *reinterpret_cast<ImportSettingsRequest *>(request->_tempObject);
+    AsyncWebServerResponse *response;
+    if (!import.authenticated) {
+        response = request->beginResponse(403);
+    }
+    else if (import.error || request->contentLength() == 0) {
+        response = createImportSettingsResponse(request, 400, -1, F("Failed to parse JSON data"));
+    }
+    else {
+        config.write();
+        response = createImportSettingsResponse(request, 200, import.reader.getImportedHandles().size(), FSPGM(Success, "Success"));
+    }
+    Plugin::_logRequest(request, response);
+    request->send(response);
+}
+
 void Plugin::_handlerImportSettings(AsyncWebServerRequest *request, HttpHeaders &headers)
 {
     if (!isAuthenticated(request)) {
@@ -763,7 +891,7 @@ void Plugin::_handlerImportSettings(AsyncWebServerRequest *request, HttpHeaders
         message = AsyncWebServerResponse::responseCodeToString(405);
         status = 405;
     }
-    send(request, request->beginResponse(200, FSPGM(mime_text_plain), PrintString(F("{\"status\":%u,\"count\":%d,\"message\":\"%s\"}"), status, count, message)));
+    send(request, createImportSettingsResponse(request, status, count, message));
 }
 
 void Plugin::_handlerExportSettings(AsyncWebServerRequest *request, HttpHeaders &headers)
@@ -781,10 +909,33 @@ void Plugin::_handlerExportSettings(AsyncWebServerRequest *request, HttpHeaders
     filename.strftime_P(PSTR("%Y%m%d_%H%M%S.json"), time(nullptr));
     headers.add<HttpDispositionHeader>(filename);
 
-    PrintString content;
-    config.exportAsJson(content, config.getFirmwareVersion());
-    auto response = request->beginResponse(200, FSPGM(mime_application_json), content);
+    // the export is written to a temporary file and sent from there. this limits the memory usage to the file
+    // buffer instead of holding the entire JSON document in a string. each request uses its own file
+    static uint16_t exportCounter = 0;
+    String tmpFile = FSPGM(FS_tmp_dir);
+    tmpFile += F("config_export_");
+    tmpFile += ++exportCounter;
+    tmpFile += F(".json");
+    {
+        auto file = KFCFS.open(tmpFile, fs::FileOpenMode::write);
+        if (!file) {
+            send(503, request);
+            return;
+        }
+        config.exportAsJson(file, config.getFirmwareVersion());
+    }
+    auto exportFile = KFCFS.open(tmpFile, fs::FileOpenMode::read);
+    auto response = request->beginChunkedResponse(FSPGM(mime_application_json), [exportFile](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+        auto len = exportFile.read(buffer, maxLen);
+        return len > 0 ? len : 0;
+    });
     headers.setResponseHeaders(response);
+    // remove the file after the response has been sent and the file closed
+    request->onDisconnect([tmpFile]() {
+        LoopFunctions::callOnce([tmpFile]() {
+            KFCFS.remove(tmpFile);
+        });
+    });
     send(request, response);
 }
 
@@ -850,6 +1001,8 @@ void Plugin::begin(bool restart)
         _addMDNS();
     #endif
 
+    _addRoutes();
+
     #if SECURITY_LOGIN_ATTEMPTS
         if (System::Flags::getConfig().is_log_login_failures_enabled) {
             _loginFailures.reset(new FailureCounterContainer());
@@ -879,12 +1032,52 @@ void Plugin::begin(bool restart)
         }
     #endif
 
+    if (!restart) {
+        addHandler(new AsyncImportSettingsWebHandler(), AsyncImportSettingsWebHandler::getURI());
+    }
+
     _server->onNotFound(handlerNotFound);
 
     _server->begin();
     __LDBG_printf("HTTP running on port %u", cfg.getPort());
 }
 
+void Plugin::_addRoutes()
+{
+    // routes handled by handlerNotFound()
+    auto &routes = _server->_routes;
+    #if ENABLE_ARDUINO_OTA
+        routes.add(F("/start-arduino-ota"), RouteType::START_ARDUINO_OTA);
+        routes.add(F("/stop-arduino-ota"), RouteType::STOP_ARDUINO_OTA);
+    #endif
+    routes.add(F("/is-alive"), RouteType::IS_ALIVE);
+    routes.add(F("/webui-handler"), RouteType::WEBUI_HANDLER);
+    routes.add(F("/alerts"), RouteType::ALERTS);
+    routes.add(F("/sync-time"), RouteType::SYNC_TIME);
+    routes.add(F("/export-settings"), RouteType::EXPORT_SETTINGS);
+    routes.add(F("/import-settings"), RouteType::IMPORT_SETTINGS);
+    routes.add(F("/scan-wifi"), RouteType::SCAN_WIFI);
+    routes.add(F("/logout"), RouteType::LOGOUT);
+    routes.add(F("/mqtt-publish-ad.html"), RouteType::MQTT_PUBLISH_AD);
+    routes.add(F("/zeroconf"), RouteType::ZEROCONF);
+    #if MDNS_PLUGIN
+        routes.add(F("/mdns_discovery"), RouteType::MDNS_DISCOVERY);
+    #endif
+    #if ESP8266
+        routes.add(F("/savecrash.json"), RouteType::SAVECRASH_JSON);
+    #endif
+    #if IOT_SENSOR_HAVE_AMBIENT_LIGHT_SENSOR
+        routes.add(F("/ambient_light_sensor"), RouteType::AMBIENT_LIGHT_SENSOR);
+    #endif
+    #if WEBSERVER_SPEED_TEST
+        routes.add(F("/speedtest.zip"), RouteType::SPEEDTEST_ZIP);
+        routes.add(F("/speedtest.bmp"), RouteType::SPEEDTEST_BMP);
+    #endif
+    #if KFC_METRICS
+        routes.add(F("/metrics"), RouteType::METRICS);
+    #endif
+}
+
 AsyncWebServerResponse *Plugin::_beginFileResponse(const FileMapping &mapping, const String &formName, HttpHeaders &headers, bool client_accepts_gzip, bool isAuthenticated, AsyncWebServerRequest *request, WebTemplate *webTemplate)
 {
     __LDBG_printf("mapping=%s exists=%u form=%s gz=%u auth=%u request=%p web_template=%p", mapping.getFilename(), mapping.exists(), formName.c_str(), client_accepts_gzip, isAuthenticated, request, webTemplate);
@@ -942,6 +1135,19 @@ AsyncWebServerResponse *Plugin::_beginFileResponse(const FileMapping &mapping, c
         if (_isPublic(path)) {
             headers.replace<HttpCacheControlHeader>(HttpCacheControlHeader::CacheControlType::PUBLIC);
         }
+        #if WEBSERVER_ETAG_SUPPORT
+            auto etag = ETagCache::getETag(mapping);
+            if (etag.length()) {
+                headers.add(F("ETag"), etag);
+                auto ifNoneMatch = request->getHeader(F("If-None-Match"));
+                if (ifNoneMatch && ETagCache::match(ifNoneMatch->value(), etag)) {
+                    __LDBG_printf("not modified etag=%s", etag.c_str());
+                    auto response = request->beginResponse(304);
+                    headers.setResponseHeaders(response);
+                    return response;
+                }
+            }
+        #endif
         // regular file
 #if 0
         response = new AsyncProgmemFileResponse(FPSTR(getContentType(path)), mapping.open(FileOpenMode::read));
@@ -1358,6 +1564,34 @@ void Plugin::getStatus(Print &output)
         if (count) {
             output.printf_P(PSTR(HTML_S(br) "%d Rest API endpoints"), count);
         }
+        #if WEBSERVER_ETAG_SUPPORT
+            output.print(F(HTML_S(br)));
+            ETagCache::dump(output);
+        #endif
+        #if WEBSERVER_ADMISSION_CONTROL
+            output.print(F(HTML_S(br)));
+            Admission::dump(output);
+        #endif
+        #if WEBUI_BINARY_VALUES
+            output.print(F(HTML_S(br)));
+            WebUISocket::dumpStats(output);
+        #endif
+        #if SECURITY_LOGIN_ATTEMPTS
+            if (_loginFailures) {
+                output.print(F(HTML_S(br)));
+                _loginFailures->dump(output);
+            }
+        #endif
+        #if WEBSERVER_KFC_OTA
+            {
+                PrintString stats;
+                AsyncUpdateWebHandler::dumpStats(stats);
+                if (stats.length()) {
+                    output.print(F(HTML_S(br)));
+                    output.print(stats);
+                }
+            }
+        #endif
         #if WEBSERVER_KFC_OTA
             auto kfcOta = PSTR("Enabled");
         #else
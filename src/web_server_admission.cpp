@@ -0,0 +1,267 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <ESPAsyncWebServer.h>
+#include <HttpHeaders.h>
+#include <PluginComponent.h>
+#include <lwip/tcp.h>
+#include <algorithm>
+#include "web_server.h"
+#include "web_server_admission.h"
+
+#if DEBUG_WEB_SERVER
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+namespace WebServer {
+
+    static_assert(WEBSERVER_RESPONSE_BUFFER_COUNT <= 8, "WEBSERVER_RESPONSE_BUFFER_COUNT must be 8 or less");
+
+    Admission::Ticket Admission::_pending;
+    std::vector<Admission::QueuedRequest> Admission::_queue;
+    Event::Timer Admission::_timer;
+    uint32_t Admission::_reserved = 0;
+    uint8_t Admission::_active = 0;
+    bool Admission::_dispatching = false;
+    std::unique_ptr<uint8_t[]> Admission::_pool[WEBSERVER_RESPONSE_BUFFER_COUNT];
+    uint8_t Admission::_poolUsed = 0;
+    uint16_t Admission::_poolLeases = 0;
+    uint32_t Admission::_admitted = 0;
+    uint32_t Admission::_queued = 0;
+    uint32_t Admission::_rejected = 0;
+    uint16_t Admission::_maxQueueDepth = 0;
+    uint32_t Admission::_maxReserved = 0;
+    uint32_t Admission::_poolHits = 0;
+    uint32_t Admission::_poolMisses = 0;
+
+    // ------------------------------------------------------------------------
+    // Admission::Ticket
+    // ------------------------------------------------------------------------
+
+    void Admission::Ticket::release()
+    {
+        if (_size) {
+            __LDBG_printf("release size=%u reserved=%u active=%u", _size, _reserved, _active);
+            _reserved -= _size;
+            _active--;
+            _size = 0;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Admission::Scope
+    // ------------------------------------------------------------------------
+
+    bool Admission::Scope::admit(AsyncWebServerRequest *request, ResponseType type, Callback callback)
+    {
+        if (type == ResponseType::NONE) {
+            return true;
+        }
+        auto size = getEstimate(type);
+        // queued requests are served first
+        if ((_dispatching || _queue.empty()) && _hasMemory(size)) {
+            _pending = Ticket(size);
+            _reserved += size;
+            _active++;
+            _admitted++;
+            _maxReserved = std::max(_maxReserved, _reserved);
+            __LDBG_printf("admitted url=%s type=%u size=%u reserved=%u active=%u", request->url().c_str(), type, size, _reserved, _active);
+            return true;
+        }
+        if (_queue.size() >= kQueueSize) {
+            __LDBG_printf("rejected url=%s type=%u size=%u reserved=%u free=%u", request->url().c_str(), type, size, _reserved, ESP.getFreeHeap());
+            _rejected++;
+            _sendServiceUnavailable(request);
+            return false;
+        }
+        _enqueue(request, type, std::move(callback));
+        return false;
+    }
+
+    // ------------------------------------------------------------------------
+    // Admission::Buffer
+    // ------------------------------------------------------------------------
+
+    Admission::Buffer::Buffer(size_t size) : _buffer(nullptr), _index(-1)
+    {
+        if (size <= kPoolSize) {
+            for(uint8_t i = 0; i < WEBSERVER_RESPONSE_BUFFER_COUNT; i++) {
+                if (_poolUsed & _BV(i)) {
+                    continue;
+                }
+                if (!_pool[i]) {
+                    _pool[i].reset(new uint8_t[kPoolSize]);
+                    if (!_pool[i]) {
+                        break;
+                    }
+                }
+                _poolUsed |= _BV(i);
+                _poolHits++;
+                _index = i;
+                _buffer = _pool[i].get();
+                return;
+            }
+        }
+        _poolMisses++;
+        _buffer = new uint8_t[size];
+    }
+
+    Admission::Buffer::~Buffer()
+    {
+        if (_index != -1) {
+            _poolUsed &= ~_BV(_index);
+        }
+        else if (_buffer) {
+            delete[] _buffer;
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Admission
+    // ------------------------------------------------------------------------
+
+    Admission::ResponseType Admission::getResponseType(AsyncWebServerRequest *request)
+    {
+        auto &url = request->url();
+        if (url.endsWith('/')) {
+            return ResponseType::TEMPLATE;
+        }
+        if (url.endsWith(F(".xml"))) {
+            return ResponseType::TEMPLATE;
+        }
+        if (!url.endsWith(F(".html"))) {
+            return ResponseType::NONE;
+        }
+        if (!Plugin::isAuthenticated(request)) {
+            return ResponseType::TEMPLATE;
+        }
+        if (request->method() == HTTP_POST) {
+            return ResponseType::FORM;
+        }
+        // same name as used by Plugin::_handleFileRead()
+        auto start = url.lastIndexOf('/') + 1;
+        auto formName = url.substring(start, url.length() - 5);
+        if (PluginComponent::getForm(formName)) {
+            return ResponseType::FORM;
+        }
+        return ResponseType::TEMPLATE;
+    }
+
+    uint16_t Admission::getEstimate(ResponseType type)
+    {
+        switch(type) {
+            case ResponseType::TEMPLATE:
+                return WEBSERVER_ADMISSION_TEMPLATE_SIZE;
+            case ResponseType::FORM:
+                return WEBSERVER_ADMISSION_FORM_SIZE;
+            case ResponseType::DIR_LISTING:
+                return WEBSERVER_ADMISSION_DIR_LISTING_SIZE;
+            case ResponseType::NETWORK_SCAN:
+                return WEBSERVER_ADMISSION_NETWORK_SCAN_SIZE;
+            default:
+                break;
+        }
+        return 0;
+    }
+
+    void Admission::dump(Print &output)
+    {
+        output.printf_P(PSTR("Response memory %u/%u byte reserved (max. %u), %u active, %u queued (max. %u), %u admitted, %u delayed, %u rejected"),
+            _reserved, kBudget, _maxReserved, _active, _queue.size(), _maxQueueDepth, _admitted, _queued, _rejected
+        );
+        output.printf_P(PSTR(HTML_S(br) "Response buffer pool %u x %u byte, %u hits, %u misses"), WEBSERVER_RESPONSE_BUFFER_COUNT, Buffer::kPoolSize, _poolHits, _poolMisses);
+    }
+
+    void Admission::_freePool()
+    {
+        for(uint8_t i = 0; i < WEBSERVER_RESPONSE_BUFFER_COUNT; i++) {
+            if (!(_poolUsed & _BV(i))) {
+                _pool[i].reset();
+            }
+        }
+    }
+
+    bool Admission::_hasMemory(uint16_t size)
+    {
+        if (ESP.getFreeHeap() < size + kMinFreeHeap) {
+            return false;
+        }
+        // a single response is always admitted if there is enough free heap
+        return (_reserved == 0 || _reserved + size <= kBudget);
+    }
+
+    void Admission::_enqueue(AsyncWebServerRequest *request, ResponseType type, Callback &&callback)
+    {
+        __LDBG_printf("queued url=%s type=%u queue=%u reserved=%u free=%u", request->url().c_str(), type, _queue.size(), _reserved, ESP.getFreeHeap());
+        // keep the order if the request was already queued
+        auto iterator = _dispatching ? _queue.begin() : _queue.end();
+        _queue.emplace(iterator, request, std::move(callback), type);
+        if (!_dispatching) {
+            _queued++;
+            _maxQueueDepth = std::max<uint16_t>(_maxQueueDepth, _queue.size());
+        }
+        request->onDisconnect([request]() {
+            _remove(request);
+        });
+        if (!_timer) {
+            _Timer(_timer).add(Event::milliseconds(kQueueInterval), true, [](Event::CallbackTimerPtr timer) {
+                _processQueue();
+                if (_queue.empty()) {
+                    timer->disarm();
+                }
+            });
+        }
+    }
+
+    void Admission::_remove(AsyncWebServerRequest *request)
+    {
+        _queue.erase(std::remove_if(_queue.begin(), _queue.end(), [request](const QueuedRequest &item) {
+            return item.request == request;
+        }), _queue.end());
+    }
+
+    void Admission::_processQueue()
+    {
+        // requests that have been waiting too long
+        auto now = millis();
+        for(auto iterator = _queue.begin(); iterator != _queue.end();) {
+            if (now - iterator->time >= kQueueTimeout) {
+                auto request = iterator->request;
+                iterator = _queue.erase(iterator);
+                __LDBG_printf("timeout url=%s", request->url().c_str());
+                _rejected++;
+                request->onDisconnect(nullptr);
+                _sendServiceUnavailable(request);
+            }
+            else {
+                ++iterator;
+            }
+        }
+        // serve the queue in order
+        while(!_queue.empty() && _hasMemory(getEstimate(_queue.front().type))) {
+            auto item = std::move(_queue.front());
+            _queue.erase(_queue.begin());
+            __LDBG_printf("dispatch url=%s type=%u waited=%u", item.request->url().c_str(), item.type, millis() - item.time);
+            item.request->onDisconnect(nullptr);
+            _dispatching = true;
+            item.callback(item.request);
+            _dispatching = false;
+        }
+    }
+
+    void Admission::_sendServiceUnavailable(AsyncWebServerRequest *request)
+    {
+        HttpHeaders headers;
+        headers.addNoCache(true);
+        headers.add(F("Retry-After"), String(kRetryAfter));
+        auto response = request->beginResponse(503);
+        headers.setResponseHeaders(response);
+        Plugin::_logRequest(request, response);
+        request->send(response);
+    }
+
+}
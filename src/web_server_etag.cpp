@@ -0,0 +1,175 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include "fs_mapping.h"
+#include "web_server.h"
+#include "web_server_etag.h"
+#include <LoopFunctions.h>
+#include <algorithm>
+
+#if DEBUG_WEB_SERVER
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+#define WEBSERVER_ETAG_CACHE_FILE "/.pvt/etags"
+
+namespace WebServer {
+
+    std::vector<ETagCache::Entry> ETagCache::_entries;
+    std::vector<uint32_t> ETagCache::_pending;
+    Event::Timer ETagCache::_saveTimer;
+    bool ETagCache::_loaded = false;
+    uint32_t ETagCache::_hits = 0;
+    uint32_t ETagCache::_misses = 0;
+
+    String ETagCache::getETag(const FileMapping &mapping)
+    {
+        _load();
+        auto filename = mapping.getFilename();
+        auto path = crc32(filename, strlen(filename));
+        auto modificationTime = static_cast<uint32_t>(mapping.getModificationTime());
+        auto iterator = std::find_if(_entries.begin(), _entries.end(), [path](const Entry &entry) {
+            return entry.path == path;
+        });
+        if (iterator != _entries.end() && iterator->modificationTime == modificationTime) {
+            _hits++;
+            // move the entry to the back, the least recently used entry is removed first
+            std::rotate(iterator, iterator + 1, _entries.end());
+            return PrintString(F("\"%08x\""), _entries.back().hash);
+        }
+        _misses++;
+        // hashing the file blocks the async TCP handler. the response is sent without ETag and the hash is
+        // calculated in the main loop
+        if (std::find(_pending.begin(), _pending.end(), path) == _pending.end()) {
+            _pending.push_back(path);
+            String name = filename;
+            LoopFunctions::callOnce([name, path]() {
+                _update(FileMapping(name.c_str()), path);
+            });
+        }
+        return String();
+    }
+
+    void ETagCache::_update(const FileMapping &mapping, uint32_t path)
+    {
+        _pending.erase(std::remove(_pending.begin(), _pending.end(), path), _pending.end());
+        uint32_t hash;
+        if (!_calcHash(mapping, hash)) {
+            return;
+        }
+        auto entry = _find(path);
+        if (!entry) {
+            if (_entries.size() >= WEBSERVER_ETAG_CACHE_SIZE) {
+                _entries.erase(_entries.begin());
+            }
+            _entries.push_back({ path, 0, 0 });
+            entry = &_entries.back();
+        }
+        entry->modificationTime = static_cast<uint32_t>(mapping.getModificationTime());
+        entry->hash = hash;
+        __LDBG_printf("file=%s mtime=%u hash=%08x", mapping.getFilename(), entry->modificationTime, hash);
+        _scheduleSave();
+    }
+
+    bool ETagCache::match(const String &ifNoneMatch, const String &etag)
+    {
+        if (ifNoneMatch.length() == 1 && ifNoneMatch.charAt(0) == '*') {
+            return true;
+        }
+        // a list of ETags. weak ETags (W/"...") match as well
+        return ifNoneMatch.indexOf(etag) != -1;
+    }
+
+    void ETagCache::clear()
+    {
+        _Timer(_saveTimer).remove();
+        _entries.clear();
+        _entries.shrink_to_fit();
+        _loaded = true;
+        String filename = F(WEBSERVER_ETAG_CACHE_FILE);
+        if (KFCFS.exists(filename)) {
+            KFCFS.remove(filename);
+        }
+    }
+
+    void ETagCache::dump(Print &output)
+    {
+        _load();
+        output.printf_P(PSTR("ETag cache entries=%u/%u hits=%u misses=%u\n"), _entries.size(), WEBSERVER_ETAG_CACHE_SIZE, _hits, _misses);
+    }
+
+    ETagCache::Entry *ETagCache::_find(uint32_t path)
+    {
+        for(auto &entry: _entries) {
+            if (entry.path == path) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    bool ETagCache::_calcHash(const FileMapping &mapping, uint32_t &hash)
+    {
+        auto file = mapping.open(FileOpenMode::read);
+        if (!file) {
+            return false;
+        }
+        // FNV-1a of the stored content
+        hash = 0x811c9dc5;
+        uint8_t buffer[128];
+        int len;
+        while((len = file.read(buffer, sizeof(buffer))) > 0) {
+            for(int i = 0; i < len; i++) {
+                hash = (hash ^ buffer[i]) * 0x01000193;
+            }
+        }
+        return true;
+    }
+
+    void ETagCache::_load()
+    {
+        if (_loaded) {
+            return;
+        }
+        _loaded = true;
+        auto file = KFCFS.open(F(WEBSERVER_ETAG_CACHE_FILE), fs::FileOpenMode::read);
+        if (!file) {
+            return;
+        }
+        uint32_t header[2];
+        if (file.read(reinterpret_cast<uint8_t *>(header), sizeof(header)) != sizeof(header) || header[0] != kMagic || header[1] > WEBSERVER_ETAG_CACHE_SIZE) {
+            return;
+        }
+        _entries.resize(header[1]);
+        size_t size = _entries.size() * sizeof(Entry);
+        if (file.read(reinterpret_cast<uint8_t *>(_entries.data()), size) != size) {
+            _entries.clear();
+        }
+        __LDBG_printf("entries=%u", _entries.size());
+    }
+
+    void ETagCache::_scheduleSave()
+    {
+        // collect all hashes of a page load before writing
+        _Timer(_saveTimer).add(Event::seconds(5), false, [](Event::CallbackTimerPtr) {
+            _save();
+        });
+    }
+
+    void ETagCache::_save()
+    {
+        auto file = KFCFS.open(F(WEBSERVER_ETAG_CACHE_FILE), fs::FileOpenMode::write);
+        if (!file) {
+            return;
+        }
+        uint32_t header[2] = { kMagic, static_cast<uint32_t>(_entries.size()) };
+        file.write(reinterpret_cast<const uint8_t *>(header), sizeof(header));
+        file.write(reinterpret_cast<const uint8_t *>(_entries.data()), _entries.size() * sizeof(Entry));
+        __LDBG_printf("saved entries=%u", _entries.size());
+    }
+
+}
@@ -12,9 +12,10 @@ using namespace KFCJson;
 // RestRequest
 // ------------------------------------------------------------------------
 
-RestRequest::RestRequest(AsyncWebServerRequest *request, const RestHandler &handler, AuthType auth) :
+RestRequest::RestRequest(AsyncWebServerRequest *request, const RestHandler &handler, AuthType auth, RouteTable::Route *route) :
     _request(request),
     _handler(handler),
+    _route(route),
     _auth(auth),
     _stream(),
     _reader(_stream),
@@ -28,6 +29,11 @@ AuthType RestRequest::getAuth() const
     return _auth;
 }
 
+RouteTable::Route *RestRequest::getRoute() const
+{
+    return _route;
+}
+
 AsyncWebServerResponse *RestRequest::createResponse(AsyncWebServerRequest *request)
 {
     AsyncWebServerResponse *response = nullptr;
@@ -93,23 +99,23 @@ bool AsyncRestWebHandler::canHandle(AsyncWebServerRequest *request)
 {
     __LDBG_printf("url=%s auth=%d", request->url().c_str(), Plugin::getInstance().isAuthenticated(request));
 
-    auto &url = request->url();
-    for(const auto &handler: Plugin::getInstance()._server->_restCallbacks) {
-        if (url == FPSTR(handler.getURL())) {
-            request->addInterestingHeader(FSPGM(Authorization));
-
-            // emulate AsyncWebServerRequest dtor using onDisconnect callback
-            request->_tempObject = new RestRequest(request, handler, Plugin::getInstance().getAuthenticated(request));
-            request->onDisconnect([this, request]() {
-                if (request->_tempObject) {
-                    delete reinterpret_cast<RestRequest *>(request->_tempObject);
-                    request->_tempObject = nullptr;
-                }
-            });
-            return true;
-        }
+    auto &server = *Plugin::getInstance()._server;
+    auto route = server._routes.find(request->method(), request->url());
+    if (!route || route->type != RouteType::REST || route->index >= server._restCallbacks.size()) {
+        return false;
     }
-    return false;
+    auto &handler = server._restCallbacks[route->index];
+    request->addInterestingHeader(FSPGM(Authorization));
+
+    // emulate AsyncWebServerRequest dtor using onDisconnect callback
+    request->_tempObject = new RestRequest(request, handler, Plugin::getInstance().getAuthenticated(request), route);
+    request->onDisconnect([this, request]() {
+        if (request->_tempObject) {
+            delete reinterpret_cast<RestRequest *>(request->_tempObject);
+            request->_tempObject = nullptr;
+        }
+    });
+    return true;
 }
 
 void AsyncRestWebHandler::handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
@@ -135,6 +141,7 @@ void AsyncRestWebHandler::handleRequest(AsyncWebServerRequest *request)
 #if DEBUG_WEB_SERVER
         rest.getJsonReader().dump(DEBUG_OUTPUT);
 #endif
+        RouteTable::Measure measure(rest.getRoute());
         request->send(rest.createResponse(request));
     }
     else {
@@ -0,0 +1,227 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino_compat.h>
+#include <PrintString.h>
+#include <algorithm>
+#include "web_server.h"
+#include "web_server_routes.h"
+
+#if DEBUG_WEB_SERVER
+#include <debug_helper_enable.h>
+#else
+#include <debug_helper_disable.h>
+#endif
+
+namespace WebServer {
+
+    static const uint16_t kHistogramLimits[RouteTable::kHistogramSize - 1] PROGMEM = { 100, 500, 1000, 5000, 20000 };
+
+    RouteTable::RouteTable() : _seed(0), _bits(0), _dirty(false)
+    {
+    }
+
+    void RouteTable::clear()
+    {
+        _routes.clear();
+        _slots.reset();
+        _bits = 0;
+        _dirty = false;
+    }
+
+    void RouteTable::add(const __FlashStringHelper *url, RouteType type, uint8_t index, uint8_t method)
+    {
+        __LDBG_printf("url=%s type=%u index=%u method=%u", url, type, index, method);
+        _routes.emplace_back(url, type, index, method);
+        _dirty = true;
+    }
+
+    RouteTable::Route *RouteTable::find(uint8_t method, const char *url, size_t len)
+    {
+        if (_dirty) {
+            _build();
+        }
+        if (method != kAnyMethod) {
+            auto route = _find(method, url, len);
+            if (route) {
+                return route;
+            }
+        }
+        return _find(kAnyMethod, url, len);
+    }
+
+    RouteTable::Route *RouteTable::_find(uint8_t method, const char *url, size_t len)
+    {
+        if (_bits) {
+            auto slot = _slots[_getSlot(_hash(method, url, len, _seed))];
+            if (slot && _isMatch(_routes[slot - 1], method, url, len)) {
+                return &_routes[slot - 1];
+            }
+        }
+        else {
+            // linear search if no seed was found
+            for(auto &route: _routes) {
+                if (_isMatch(route, method, url, len)) {
+                    return &route;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void RouteTable::resetStats()
+    {
+        for(auto &route: _routes) {
+            route.hits = 0;
+            std::fill(std::begin(route.histogram), std::end(route.histogram), 0);
+        }
+    }
+
+    void RouteTable::dump(Print &output) const
+    {
+        output.printf_P(PSTR("%u routes, %u slots, seed %u\n"), _routes.size(), _bits ? _BV(_bits) : 0, _seed);
+        for(const auto &route: _routes) {
+            if (!route.hits) {
+                continue;
+            }
+            output.printf_P(PSTR("%s method=%u hits=%u <100us=%u <500us=%u <1ms=%u <5ms=%u <20ms=%u >=20ms=%u\n"), route.url, route.method, route.hits,
+                route.histogram[0], route.histogram[1], route.histogram[2], route.histogram[3], route.histogram[4], route.histogram[5]
+            );
+        }
+    }
+
+    void RouteTable::addLatency(Route &route, uint32_t micros)
+    {
+        uint8_t i = 0;
+        while(i < kHistogramSize - 1 && micros >= pgm_read_word(&kHistogramLimits[i])) {
+            i++;
+        }
+        if (route.histogram[i] < 0xffff) {
+            route.histogram[i]++;
+        }
+    }
+
+    uint32_t RouteTable::_hash(uint8_t method, const char *str, size_t len, uint32_t seed)
+    {
+        // FNV-1a of the method and URL
+        uint32_t hash = ((2166136261U ^ seed) ^ method) * 16777619U;
+        while(len--) {
+            hash ^= static_cast<uint8_t>(*str++);
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+
+    uint32_t RouteTable::_hash_P(uint8_t method, PGM_P str, uint32_t seed)
+    {
+        uint32_t hash = ((2166136261U ^ seed) ^ method) * 16777619U;
+        uint8_t ch;
+        while((ch = pgm_read_byte(str++)) != 0) {
+            hash ^= ch;
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+
+    bool RouteTable::_build()
+    {
+        _dirty = false;
+        _slots.reset();
+        _bits = 0;
+        if (_routes.empty()) {
+            return true;
+        }
+        if (_routes.size() > 0xff) {
+            __DBG_printf("too many routes %u", _routes.size());
+            return false;
+        }
+        // the seed is searched for a table with at least twice the number of routes, the size is doubled if no
+        // seed was found after 256 attempts
+        uint8_t bits = kMinBits;
+        while(_BV(bits) < _routes.size() * 2) {
+            bits++;
+        }
+        for(; bits <= kMaxBits; bits++) {
+            std::unique_ptr<uint8_t[]> slots(new uint8_t[_BV(bits)]);
+            if (!slots) {
+                __LDBG_printf("memory allocation failed");
+                return false;
+            }
+            _bits = bits;
+            for(uint32_t seed = 0; seed < 256; seed++) {
+                std::fill_n(slots.get(), _BV(bits), 0);
+                uint8_t index = 0;
+                for(const auto &route: _routes) {
+                    auto &slot = slots[_getSlot(_hash_P(route.method, reinterpret_cast<PGM_P>(route.url), seed))];
+                    if (slot) {
+                        break;
+                    }
+                    slot = ++index;
+                }
+                if (index == _routes.size()) {
+                    __LDBG_printf("routes=%u slots=%u seed=%u", _routes.size(), _BV(bits), seed);
+                    _seed = seed;
+                    _slots = std::move(slots);
+                    return true;
+                }
+            }
+        }
+        __DBG_printf("no seed found for %u routes", _routes.size());
+        _bits = 0;
+        return false;
+    }
+
+    void RouteTable::benchmark(Print &output, uint16_t iterations)
+    {
+        static constexpr uint8_t kRouteCounts[] = { 8, 16, 32, 64 };
+        std::unique_ptr<RouteTable> table(new RouteTable());
+        if (!table) {
+            return;
+        }
+        std::vector<String> urls;
+        // the routes point to the strings, which must not be moved
+        urls.reserve(kRouteCounts[sizeof(kRouteCounts) - 1]);
+        for(auto count: kRouteCounts) {
+            // the strings are not stored in PROGMEM, pgm_read_byte() works with any address
+            while(urls.size() < count) {
+                urls.emplace_back(PrintString(F("/api/route-%u.json"), urls.size()));
+            }
+            table->clear();
+            for(const auto &url: urls) {
+                table->add(reinterpret_cast<const __FlashStringHelper *>(url.c_str()), RouteType::BENCHMARK);
+            }
+            // build the table before measuring
+            table->find(kAnyMethod, urls.front());
+
+            // linear search with String comparison as used by the handler chains
+            uint32_t found = 0;
+            auto start = micros();
+            for(uint16_t i = 0; i < iterations; i++) {
+                const auto &url = urls[i % count];
+                for(const auto &route: table->_routes) {
+                    if (url == FPSTR(route.url)) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+            uint32_t linear = micros() - start;
+
+            start = micros();
+            for(uint16_t i = 0; i < iterations; i++) {
+                if (table->find(kAnyMethod, urls[i % count])) {
+                    found++;
+                }
+            }
+            uint32_t hashed = micros() - start;
+
+            output.printf_P(PSTR("%u routes: linear %.2fus hash table %.2fus per lookup, %u slots, found %u/%u\n"),
+                count, linear / static_cast<float>(iterations), hashed / static_cast<float>(iterations),
+                _BV(table->_bits), found, iterations * 2
+            );
+            delay(1);
+        }
+    }
+
+}
@@ -15,6 +15,9 @@
 #    include <save_crash.h>
 #endif
 #include "../src/plugins/plugins.h"
+#include <LoopFunctions.h>
+#include <lwip/tcp.h>
+#include <algorithm>
 
 #if DEBUG_WEB_SERVER_ACTION
 #    include <debug_helper_enable.h>
@@ -28,10 +31,81 @@ using KFCConfigurationClasses::System;
 
 using namespace WebServer;
 
+UploadStatus *UploadStatus::_active = nullptr;
+UploadStats AsyncUpdateWebHandler::_lastStats;
+
+// ------------------------------------------------------------------------
+// UploadStatus
+// ------------------------------------------------------------------------
+
+UploadStatus::~UploadStatus()
+{
+    if (_active == this) {
+        _active = nullptr;
+    }
+}
+
+void UploadStats::dump(Print &output) const
+{
+    output.printf_P(PSTR("%u byte in %.1fs, %u byte/s, flash %ums, stall %ums (max. %ums), %u writes, %u retransmits"),
+        size, duration / 1000.0, getBytesPerSecond(), flashTime / 1000, stallTime / 1000, maxStallTime / 1000, writes, retransmits
+    );
+}
+
 // ------------------------------------------------------------------------
 // AsyncUpdateWebHandler
 // ------------------------------------------------------------------------
 
+void AsyncUpdateWebHandler::dumpStats(Print &output)
+{
+    auto active = UploadStatus::_active;
+    auto &stats = active ? active->stats : _lastStats;
+    if (!stats.size) {
+        return;
+    }
+    output.print(active ? F("OTA upload in progress ") : F("Last OTA upload "));
+    stats.dump(output);
+}
+
+void AsyncUpdateWebHandler::_write(UploadStatus &status, const uint8_t *data, size_t len, bool blocking)
+{
+    auto start = micros();
+    if (!status.error && !Update.hasError()) {
+        if (Update.write(const_cast<uint8_t *>(data), len) != len) {
+            status.error = true;
+        }
+    }
+    uint32_t time = micros() - start;
+    auto &stats = status.stats;
+    stats.flashTime += time;
+    stats.writes++;
+    if (blocking) {
+        stats.stallTime += time;
+        stats.maxStallTime = std::max(stats.maxStallTime, time);
+    }
+}
+
+void AsyncUpdateWebHandler::_writePending(UploadStatus &status, bool blocking)
+{
+    #if WEBSERVER_OTA_WRITE_BEHIND
+        if (status.pending) {
+            status.pending = false;
+            _write(status, status.getBuffer((status.current + 1) % UploadStatus::kNumBuffers), UploadStatus::kSectorSize, blocking);
+        }
+    #endif
+}
+
+void AsyncUpdateWebHandler::_flush(UploadStatus &status)
+{
+    #if WEBSERVER_OTA_WRITE_BEHIND
+        _writePending(status, true);
+        if (status.fill) {
+            _write(status, status.getBuffer(status.current), status.fill, true);
+            status.fill = 0;
+        }
+    #endif
+}
+
 bool AsyncUpdateWebHandler::canHandle(AsyncWebServerRequest *request)
 {
     if (!request->url().equals(getURI())) {
@@ -98,13 +172,21 @@ void AsyncUpdateWebHandler::handleRequest(AsyncWebServerRequest *request)
     // auto &plugin = Plugin::getInstance();
     PrintString errorStr;
     // AsyncWebServerResponse *response = nullptr;
-    if (Update.hasError()) {
-        Update.printError(errorStr);
+    if (Update.hasError() || status->error) {
+        if (Update.hasError()) {
+            Update.printError(errorStr);
+        }
+        else {
+            errorStr = F("Writing the image failed");
+        }
         BUILTIN_LED_SET(BlinkLEDTimer::BlinkType::SOS);
         Plugin::message(request, MessageType::DANGER, errorStr, F("Firmware Upgrade Failed"));
     }
     else {
         Logger_security(F("Firmware upgrade successful"));
+        PrintString stats;
+        status->stats.dump(stats);
+        Logger_notice(F("Firmware upload %s"), stats.c_str());
 
         BUILTIN_LED_SET(BlinkLEDTimer::BlinkType::SLOW);
         Logger_notice(F("Rebooting after upgrade"));
@@ -168,6 +250,23 @@ void AsyncUpdateWebHandler::handleUpload(AsyncWebServerRequest *request, const S
         #endif
     }
 
+    auto &stats = status->stats;
+    if (index == 0) {
+        stats = UploadStats();
+        stats.start = millis();
+    }
+    stats.size += len;
+    stats.duration = millis() - stats.start;
+    #if TCP_QUEUE_OOSEQ
+        // a gap in the received segments is filled by a retransmission
+        auto pcb = request->client()->pcb();
+        bool outOfOrder = pcb && pcb->ooseq;
+        if (outOfOrder && !status->outOfOrder) {
+            stats.retransmits++;
+        }
+        status->outOfOrder = outOfOrder;
+    #endif
+
     auto &plugin = Plugin::getInstance();
     uint16_t progress = (index +  len) * 1000 / request->contentLength(); //send update every per mil
     if (status->progress != progress || final) {
@@ -260,12 +359,58 @@ void AsyncUpdateWebHandler::handleUpload(AsyncWebServerRequest *request, const S
             if (!Update.begin(size, command)) {
                 status->error = true;
             }
+
+            // Update.end() verifies the image if the MD5 is sent before the file. a firmware image is not activated
+            // on a mismatch, but U_FS has already overwritten the file system without ATOMIC_FS_UPDATE
+            auto md5 = request->arg(F("md5"));
+            if (md5.length() && !Update.setMD5(md5.c_str())) {
+                __LDBG_printf("invalid MD5 %s", md5.c_str());
+                status->error = true;
+            }
+            UploadStatus::_active = status;
+            #if WEBSERVER_OTA_WRITE_BEHIND
+                status->buffer.reset(new uint8_t[UploadStatus::kSectorSize * UploadStatus::kNumBuffers]);
+                if (!status->buffer) {
+                    __DBG_printf("cannot allocate write buffer, writing directly");
+                }
+            #endif
         }
         {
-            if (!status->error && !Update.hasError()) {
-                if (Update.write(data, len) != len) {
-                    status->error = true;
+            #if WEBSERVER_OTA_WRITE_BEHIND
+                if (status->buffer) {
+                    // collect sector sized blocks
+                    auto ptr = data;
+                    auto remaining = len;
+                    while(remaining && !status->error) {
+                        size_t count = std::min<size_t>(remaining, UploadStatus::kSectorSize - status->fill);
+                        memcpy(status->getBuffer(status->current) + status->fill, ptr, count);
+                        status->fill += count;
+                        ptr += count;
+                        remaining -= count;
+                        if (status->fill == UploadStatus::kSectorSize) {
+                            // the previous block has not been written yet
+                            _writePending(*status, true);
+                            status->pending = true;
+                            status->current = (status->current + 1) % UploadStatus::kNumBuffers;
+                            status->fill = 0;
+                            #if ESP8266
+                                // write the block after the TCP callback returned and the receive window has been updated
+                                LoopFunctions::callOnce([]() {
+                                    if (UploadStatus::_active) {
+                                        _writePending(*UploadStatus::_active, false);
+                                    }
+                                });
+                            #else
+                                // the async TCP task is not synchronized with the main loop
+                                _writePending(*status, true);
+                            #endif
+                        }
+                    }
                 }
+                else
+            #endif
+            {
+                _write(*status, data, len, true);
             }
 
             // NOTE!: Update.size()/remaining() display the uncompressed size, but progress() only counts the compressed size
@@ -273,12 +418,27 @@ void AsyncUpdateWebHandler::handleUpload(AsyncWebServerRequest *request, const S
             // __LDBG_printf("is_finished=%u is_running=%u error=%u progress=%u remaining=%u size=%u", Update.isFinished(), Update.isRunning(), Update.getError(), Update.progress(), Update.remaining(), Update.size());
 
             if (final) {
-                if (Update.end(true)) {
-                    __LDBG_printf("update success: %uB", index + len);
+                _flush(*status);
+                if (status->error) {
+                    // do not activate a partially written image
+                    #if ESP32
+                        Update.abort();
+                    #else
+                        Update.end(false);
+                    #endif
+                }
+                else if (Update.end(true)) {
+                    __LDBG_printf("update success: %uB md5=%s", index + len, Update.md5String().c_str());
                 }
                 else {
                     status->error = true;
                 }
+                stats.duration = millis() - stats.start;
+                _lastStats = stats;
+                UploadStatus::_active = nullptr;
+                #if WEBSERVER_OTA_WRITE_BEHIND
+                    status->buffer.reset();
+                #endif
             }
             #if DEBUG
                 if (status->error) {
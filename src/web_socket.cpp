@@ -27,6 +27,10 @@ using KFCConfigurationClasses::System;
  WsClient::AsyncWebSocketVector WsClient::_webSockets;
  SemaphoreMutex WsClient::_lock;
 
+#if KFC_METRICS
+METRICS_COUNTER_DEF(wsDroppedMessages, "kfc_websocket_dropped_total", "Messages not sent to a client with a full queue");
+#endif
+
 extern bool generate_session_for_username(const String &username, String &password);
 
 bool generate_session_for_username(const String &username, String &password)
@@ -392,6 +396,11 @@ void WsClient::_broadcast(AsyncWebSocket *server, WsClient *sender, AsyncWebSock
                 }
             #endif
         }
+        #if KFC_METRICS
+            else {
+                wsDroppedMessages.add();
+            }
+        #endif
     });
     buffer->unlock();
     server->_cleanBuffers();